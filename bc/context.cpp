@@ -22,6 +22,7 @@
 namespace LLVMBC
 {
 LLVMContext::LLVMContext()
+    : allocation_callbacks(dxil_spv::get_allocation_callbacks())
 {
 }
 
@@ -30,7 +31,7 @@ LLVMContext::~LLVMContext()
 	for (size_t i = typed_allocations.size(); i; i--)
 		typed_allocations[i - 1]->run();
 	for (size_t i = raw_allocations.size(); i; i--)
-		::free(raw_allocations[i - 1]);
+		dxil_spv::free_memory(allocation_callbacks, raw_allocations[i - 1]);
 }
 
 void *LLVMContext::allocate_from_chain(uintptr_t size, uintptr_t align)
@@ -56,10 +57,11 @@ void LLVMContext::allocate_new_chain(size_t size, size_t align)
 	if (min_size < 64 * 1024)
 		min_size = 64 * 1024;
 
-	void *ptr = ::malloc(min_size);
+	void *ptr = dxil_spv::allocate_memory(allocation_callbacks, min_size, alignof(max_align_t));
 	if (ptr)
 	{
 		raw_allocations.push_back(ptr);
+		allocated_bytes += min_size;
 		current_block = reinterpret_cast<uintptr_t>(ptr);
 		current_block_end = current_block + min_size;
 	}
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include "memory_allocator.hpp"
 #include <exception>
 #include <stdint.h>
 #include <stddef.h>
@@ -69,6 +70,11 @@ public:
 		return type_cache;
 	}
 
+	size_t get_allocated_bytes() const
+	{
+		return allocated_bytes;
+	}
+
 private:
 	void *allocate(size_t size, size_t align);
 
@@ -94,6 +100,9 @@ private:
 
 	uintptr_t current_block = 0;
 	uintptr_t current_block_end = 0;
+	size_t allocated_bytes = 0;
+	// Captured when the context is created, so every chain is freed through the same callbacks.
+	dxil_spv::AllocationCallbacks allocation_callbacks;
 
 	void *allocate_from_chain(uintptr_t size, uintptr_t align);
 	void allocate_new_chain(size_t size, size_t align);
@@ -24,6 +24,7 @@
 #include "module.hpp"
 #include "type.hpp"
 #include "value.hpp"
+#include "visitor.hpp"
 #include <assert.h>
 #include <sstream>
 #include <type_traits>
@@ -485,8 +486,9 @@ void StreamState::append(BinaryOperator *binop, bool decl)
 {
 	if (decl)
 	{
-		append("%", binop->get_tween_id(), " = ", to_string(binop->getOpcode()), " ", binop->getType(), " ",
-		       binop->getOperand(0), ", ", binop->getOperand(1));
+		append("%", binop->get_tween_id(), " = ", to_string(binop->getOpcode()), " ",
+		       binop->hasNoUnsignedWrap() ? "nuw " : "", binop->getType(), " ", binop->getOperand(0), ", ",
+		       binop->getOperand(1));
 	}
 	else
 	{
@@ -852,76 +854,29 @@ void StreamState::append(MDOperand *md)
 		append("null");
 }
 
-void StreamState::append(Value *value, bool decl)
+struct AppendValueVisitor
 {
-	switch (value->get_value_kind())
-	{
-	case ValueKind::Argument:
-		return append(cast<Argument>(value), decl);
-	case ValueKind::Function:
-		return append(cast<Function>(value), decl);
-	case ValueKind::BinaryOperator:
-		return append(cast<BinaryOperator>(value), decl);
-	case ValueKind::UnaryOperator:
-		return append(cast<UnaryOperator>(value), decl);
-	case ValueKind::Call:
-		return append(cast<CallInst>(value), decl);
-	case ValueKind::Branch:
-		return append(cast<BranchInst>(value), decl);
-	case ValueKind::FCmp:
-		return append(cast<FCmpInst>(value), decl);
-	case ValueKind::ICmp:
-		return append(cast<ICmpInst>(value), decl);
-	case ValueKind::Return:
-		return append(cast<ReturnInst>(value), decl);
-	case ValueKind::Undef:
-		return append(cast<UndefValue>(value), decl);
-	case ValueKind::ConstantInt:
-		return append(cast<ConstantInt>(value), decl);
-	case ValueKind::ConstantFP:
-		return append(cast<ConstantFP>(value), decl);
-	case ValueKind::BasicBlock:
-		return append(cast<BasicBlock>(value), decl);
-	case ValueKind::PHI:
-		return append(cast<PHINode>(value), decl);
-	case ValueKind::Cast:
-		return append(cast<CastInst>(value), decl);
-	case ValueKind::Select:
-		return append(cast<SelectInst>(value), decl);
-	case ValueKind::ExtractValue:
-		return append(cast<ExtractValueInst>(value), decl);
-	case ValueKind::Alloca:
-		return append(cast<AllocaInst>(value), decl);
-	case ValueKind::GetElementPtr:
-		return append(cast<GetElementPtrInst>(value), decl);
-	case ValueKind::Load:
-		return append(cast<LoadInst>(value), decl);
-	case ValueKind::Store:
-		return append(cast<StoreInst>(value), decl);
-	case ValueKind::AtomicRMW:
-		return append(cast<AtomicRMWInst>(value), decl);
-	case ValueKind::AtomicCmpXchg:
-		return append(cast<AtomicCmpXchgInst>(value), decl);
-	case ValueKind::Global:
-		return append(cast<GlobalVariable>(value), decl);
-	case ValueKind::ConstantAggregateZero:
-		return append(cast<ConstantAggregateZero>(value), decl);
-	case ValueKind::ConstantDataArray:
-		return append(cast<ConstantDataArray>(value), decl);
-	case ValueKind::ConstantDataVector:
-		return append(cast<ConstantDataVector>(value), decl);
-	case ValueKind::Switch:
-		return append(cast<SwitchInst>(value), decl);
-	case ValueKind::ShuffleVector:
-		return append(cast<ShuffleVectorInst>(value), decl);
-	case ValueKind::ExtractElement:
-		return append(cast<ExtractElementInst>(value), decl);
-	case ValueKind::InsertElement:
-		return append(cast<InsertElementInst>(value), decl);
-	default:
-		break;
+	StreamState &state;
+	bool decl;
+
+	template <typename T>
+	bool operator()(T *value)
+	{
+		state.append(value, decl);
+		return true;
 	}
 
+	bool operator()(Value *)
+	{
+		return false;
+	}
+};
+
+void StreamState::append(Value *value, bool decl)
+{
+	if (visit_value(value, AppendValueVisitor{ *this, decl }))
+		return;
+
 	LOGE("Unknown ValueKind %u.\n", unsigned(value->get_value_kind()));
 
 	if (decl)
@@ -39,6 +39,16 @@ const std::string &Function::getName() const
 	return module.get_value_name(value_id);
 }
 
+FunctionClass Function::get_function_class() const
+{
+	return function_class;
+}
+
+void Function::set_function_class(FunctionClass function_class_)
+{
+	function_class = function_class_;
+}
+
 void Function::set_basic_blocks(std::vector<BasicBlock *> basic_blocks_)
 {
 	basic_blocks = std::move(basic_blocks_);
@@ -67,6 +67,15 @@ inline std::vector<BasicBlock *>::const_iterator succ_end(const BasicBlock *bb)
 	return bb->succ_end();
 }
 
+// Functions are classified by name once the value symbol table is parsed,
+// so call sites do not have to look up names.
+enum class FunctionClass
+{
+	User,
+	DXILOp,
+	LLVMIntrinsic
+};
+
 class Function : public Constant
 {
 public:
@@ -77,6 +86,9 @@ public:
 	explicit Function(FunctionType *function_type, uint64_t value_id, Module &module);
 	const std::string &getName() const;
 
+	FunctionClass get_function_class() const;
+	void set_function_class(FunctionClass function_class);
+
 	void set_basic_blocks(std::vector<BasicBlock *> basic_blocks);
 	IteratorAdaptor<BasicBlock, std::vector<BasicBlock *>::const_iterator> begin() const;
 	IteratorAdaptor<BasicBlock, std::vector<BasicBlock *>::const_iterator> end() const;
@@ -94,6 +106,7 @@ private:
 	Module &module;
 	uint64_t value_id;
 	FunctionType *function_type;
+	FunctionClass function_class = FunctionClass::User;
 	std::vector<BasicBlock *> basic_blocks;
 	std::vector<Argument *> arguments;
 };
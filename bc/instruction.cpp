@@ -18,6 +18,7 @@
 
 #include "instruction.hpp"
 #include "cast.hpp"
+#include "function.hpp"
 #include <assert.h>
 
 namespace LLVMBC
@@ -97,9 +98,10 @@ MDNode *Instruction::getMetadata(const std::string &str) const
 		return nullptr;
 }
 
-BinaryOperator::BinaryOperator(Value *LHS, Value *RHS, BinaryOps op_)
+BinaryOperator::BinaryOperator(Value *LHS, Value *RHS, BinaryOps op_, bool no_unsigned_wrap_)
     : Instruction(LHS->getType(), ValueKind::BinaryOperator)
     , op(op_)
+    , no_unsigned_wrap(no_unsigned_wrap_)
 {
 	set_operands({ LHS, RHS });
 }
@@ -109,6 +111,11 @@ BinaryOperator::BinaryOps BinaryOperator::getOpcode() const
 	return op;
 }
 
+bool BinaryOperator::hasNoUnsignedWrap() const
+{
+	return no_unsigned_wrap;
+}
+
 UnaryOperator::UnaryOperator(UnaryOps uop, Value *value)
     : Instruction(value->getType(), ValueKind::UnaryOperator)
 {
@@ -131,6 +138,11 @@ CallInst::CallInst(FunctionType *function_type_, Function *callee_, std::vector<
     : Instruction(function_type_->getReturnType(), ValueKind::Call)
     , callee(callee_)
 {
+	// Function names are not known yet, so decode for any call. This is only exposed for dx.op calls.
+	if (!params.empty())
+		if (auto *opcode = dyn_cast<ConstantInt>(params.front()))
+			dxil_opcode = uint32_t(opcode->getUniqueInteger().getZExtValue());
+
 	set_operands(std::move(params));
 }
 
@@ -139,6 +151,14 @@ Function *CallInst::getCalledFunction() const
 	return callee;
 }
 
+bool CallInst::get_dxil_opcode(uint32_t *opcode) const
+{
+	if (callee->get_function_class() != FunctionClass::DXILOp || dxil_opcode == ~0u)
+		return false;
+	*opcode = dxil_opcode;
+	return true;
+}
+
 Value *ReturnInst::getReturnValue() const
 {
 	return value;
@@ -130,10 +130,15 @@ public:
 	CallInst(FunctionType *function_type, Function *callee, std::vector<Value *> params);
 	Function *getCalledFunction() const;
 
+	// For calls to dx.op functions, the opcode operand is decoded once while parsing.
+	// Fails if the callee is not a dx.op function, or the opcode is not a constant.
+	bool get_dxil_opcode(uint32_t *opcode) const;
+
 	LLVMBC_DEFAULT_VALUE_KIND_IMPL
 
 private:
 	Function *callee;
+	uint32_t dxil_opcode = ~0u;
 };
 
 class UnaryOperator : public Instruction
@@ -188,13 +193,15 @@ public:
 	{
 		return ValueKind::BinaryOperator;
 	}
-	BinaryOperator(Value *LHS, Value *RHS, BinaryOps op);
+	BinaryOperator(Value *LHS, Value *RHS, BinaryOps op, bool no_unsigned_wrap);
 	BinaryOps getOpcode() const;
+	bool hasNoUnsignedWrap() const;
 
 	LLVMBC_DEFAULT_VALUE_KIND_IMPL
 
 private:
 	BinaryOps op;
+	bool no_unsigned_wrap;
 };
 
 class CastInst : public Instruction
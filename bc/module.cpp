@@ -278,6 +278,7 @@ struct ModuleParseContext
 	Function *function = nullptr;
 	Module *module = nullptr;
 	LLVMContext *context = nullptr;
+	dxil_spv::BudgetTracker *budget = nullptr;
 	std::vector<BasicBlock *> basic_blocks;
 
 	std::vector<Value *> values;
@@ -285,11 +286,13 @@ struct ModuleParseContext
 
 	std::vector<Type *> types;
 	std::vector<Function *> functions_with_bodies;
+	std::vector<Function *> declared_functions;
 	std::unordered_map<uint64_t, MDOperand *> metadata;
 	std::unordered_map<uint64_t, std::string> metadata_kind_map;
 	Type *constant_type = nullptr;
 	std::string current_metadata_name;
 
+	bool check_budget();
 	bool parse_function_child_block(const BlockOrRecord &entry);
 	bool parse_record(const BlockOrRecord &entry);
 	bool parse_constants_record(const BlockOrRecord &entry);
@@ -301,6 +304,7 @@ struct ModuleParseContext
 	bool parse_function_body(const BlockOrRecord &entry);
 	bool parse_types(const BlockOrRecord &entry);
 	bool parse_value_symtab(const BlockOrRecord &entry);
+	void classify_functions();
 	bool parse_function_record(const BlockOrRecord &entry);
 	bool parse_global_variable_record(const BlockOrRecord &entry);
 	bool parse_version_record(const BlockOrRecord &entry);
@@ -1142,7 +1146,19 @@ bool ModuleParseContext::parse_record(const BlockOrRecord &entry)
 		if (!lhs.first || !rhs)
 			return false;
 		auto op = BinOp(entry.ops[index++]);
-		auto *value = context->construct<BinaryOperator>(lhs.first, rhs, translate_binop(op, lhs.second));
+		auto binop = translate_binop(op, lhs.second);
+
+		// The optional flags word has nuw in bit 0 for overflowing operators.
+		// For division and right shifts, bit 0 means exact instead.
+		bool no_unsigned_wrap = false;
+		if (index < entry.ops.size() &&
+		    (binop == BinaryOperator::BinaryOps::Add || binop == BinaryOperator::BinaryOps::Sub ||
+		     binop == BinaryOperator::BinaryOps::Mul || binop == BinaryOperator::BinaryOps::Shl))
+		{
+			no_unsigned_wrap = (entry.ops[index] & 1) != 0;
+		}
+
+		auto *value = context->construct<BinaryOperator>(lhs.first, rhs, binop, no_unsigned_wrap);
 		if (!add_instruction(value))
 			return false;
 		break;
@@ -1513,6 +1529,17 @@ bool ModuleParseContext::resolve_global_initializations()
 	return true;
 }
 
+bool ModuleParseContext::check_budget()
+{
+	if (budget && !budget->check_arena_bytes(context->get_allocated_bytes()))
+	{
+		LOGE("Budget exceeded or cancelled while parsing module.\n");
+		return false;
+	}
+	else
+		return true;
+}
+
 bool ModuleParseContext::parse_function_body(const BlockOrRecord &entry)
 {
 	auto global_values = values;
@@ -1544,6 +1571,9 @@ bool ModuleParseContext::parse_function_body(const BlockOrRecord &entry)
 
 	for (auto &child : entry.children)
 	{
+		if (!check_budget())
+			return false;
+
 		if (child.IsBlock())
 		{
 			if (!parse_function_child_block(child))
@@ -1748,6 +1778,18 @@ bool ModuleParseContext::parse_value_symtab(const BlockOrRecord &entry)
 	return true;
 }
 
+void ModuleParseContext::classify_functions()
+{
+	for (auto *func : declared_functions)
+	{
+		auto &name = func->getName();
+		if (name.compare(0, 5, "dx.op") == 0)
+			func->set_function_class(FunctionClass::DXILOp);
+		else if (name.compare(0, 5, "llvm.") == 0)
+			func->set_function_class(FunctionClass::LLVMIntrinsic);
+	}
+}
+
 bool ModuleParseContext::parse_global_variable_record(const BlockOrRecord &entry)
 {
 	if (use_strtab)
@@ -1814,6 +1856,7 @@ bool ModuleParseContext::parse_function_record(const BlockOrRecord &entry)
 	auto id = values.size();
 	auto *func = context->construct<Function>(func_type, id, *module);
 	values.push_back(func);
+	declared_functions.push_back(func);
 
 	if (!is_proto)
 		functions_with_bodies.push_back(func);
@@ -1949,7 +1992,7 @@ std::vector<MDNode *>::const_iterator Module::unnamed_metadata_end() const
 	return unnamed_metadata.end();
 }
 
-Module *parseIR(LLVMContext &context, const void *data, size_t size)
+Module *parseIR(LLVMContext &context, const void *data, size_t size, dxil_spv::BudgetTracker *budget)
 {
 	LLVMBC::BitcodeReader reader(static_cast<const uint8_t *>(data), size);
 	auto toplevel = reader.ReadToplevelBlock();
@@ -1967,9 +2010,13 @@ Module *parseIR(LLVMContext &context, const void *data, size_t size)
 	ModuleParseContext parse_context;
 	parse_context.module = module;
 	parse_context.context = &module->getContext();
+	parse_context.budget = budget;
 
 	for (auto &child : toplevel.children)
 	{
+		if (!parse_context.check_budget())
+			return nullptr;
+
 		if (child.IsBlock())
 		{
 			switch (KnownBlocks(child.id))
@@ -2028,6 +2075,8 @@ Module *parseIR(LLVMContext &context, const void *data, size_t size)
 		}
 	}
 
+	// The module symbol table may come after the function blocks.
+	parse_context.classify_functions();
 	return module;
 }
 } // namespace LLVMBC
@@ -19,6 +19,7 @@
 #pragma once
 
 #include "iterator.hpp"
+#include "budget.hpp"
 #include <exception>
 #include <stddef.h>
 #include <type_traits>
@@ -81,6 +82,7 @@ private:
 	std::vector<MDNode *> unnamed_metadata;
 };
 
-Module *parseIR(LLVMContext &context, const void *data, size_t size);
+// If budget is non-null, parsing fails once the arena of context outgrows it, or it runs out of time.
+Module *parseIR(LLVMContext &context, const void *data, size_t size, dxil_spv::BudgetTracker *budget = nullptr);
 bool disassemble(Module &module, std::string &str);
 } // namespace LLVMBC
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2019-2020 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#pragma once
+
+#include "function.hpp"
+#include "instruction.hpp"
+#include "value.hpp"
+#include <type_traits>
+
+namespace LLVMBC
+{
+template <typename From, typename To>
+using MatchConst = typename std::conditional<std::is_const<From>::value, const To, To>::type;
+
+// Calls visitor with value cast to its concrete class, using a single switch over the dense ValueKind enum,
+// which compiles to a jump table. Kinds without a concrete class (proxies and abstract bases) are passed as is,
+// so visitors should provide a catch-all overload for the base type.
+// Constness of the input is propagated to the cast.
+template <typename ValueT, typename Visitor>
+auto visit_value(ValueT *value, Visitor &&visitor) -> decltype(visitor(value))
+{
+	// Go through Value, since not every concrete class derives from ValueT.
+	auto *base = static_cast<MatchConst<ValueT, Value> *>(value);
+
+#define LLVMBC_VISIT(kind, T) \
+	case ValueKind::kind:     \
+		return visitor(static_cast<MatchConst<ValueT, T> *>(base))
+
+	switch (value->get_value_kind())
+	{
+		LLVMBC_VISIT(Argument, Argument);
+		LLVMBC_VISIT(Function, Function);
+		LLVMBC_VISIT(ConstantInt, ConstantInt);
+		LLVMBC_VISIT(ConstantFP, ConstantFP);
+		LLVMBC_VISIT(ConstantAggregateZero, ConstantAggregateZero);
+		LLVMBC_VISIT(ConstantDataArray, ConstantDataArray);
+		LLVMBC_VISIT(ConstantDataVector, ConstantDataVector);
+		LLVMBC_VISIT(Undef, UndefValue);
+		LLVMBC_VISIT(UnaryOperator, UnaryOperator);
+		LLVMBC_VISIT(BinaryOperator, BinaryOperator);
+		LLVMBC_VISIT(Call, CallInst);
+		LLVMBC_VISIT(FCmp, FCmpInst);
+		LLVMBC_VISIT(ICmp, ICmpInst);
+		LLVMBC_VISIT(BasicBlock, BasicBlock);
+		LLVMBC_VISIT(PHI, PHINode);
+		LLVMBC_VISIT(Cast, CastInst);
+		LLVMBC_VISIT(Select, SelectInst);
+		LLVMBC_VISIT(ExtractValue, ExtractValueInst);
+		LLVMBC_VISIT(Alloca, AllocaInst);
+		LLVMBC_VISIT(GetElementPtr, GetElementPtrInst);
+		LLVMBC_VISIT(Load, LoadInst);
+		LLVMBC_VISIT(Store, StoreInst);
+		LLVMBC_VISIT(AtomicRMW, AtomicRMWInst);
+		LLVMBC_VISIT(AtomicCmpXchg, AtomicCmpXchgInst);
+		LLVMBC_VISIT(Return, ReturnInst);
+		LLVMBC_VISIT(Branch, BranchInst);
+		LLVMBC_VISIT(Switch, SwitchInst);
+		LLVMBC_VISIT(Global, GlobalVariable);
+		LLVMBC_VISIT(ShuffleVector, ShuffleVectorInst);
+		LLVMBC_VISIT(ExtractElement, ExtractElementInst);
+		LLVMBC_VISIT(InsertElement, InsertElementInst);
+
+	default:
+		return visitor(value);
+	}
+
+#undef LLVMBC_VISIT
+}
+} // namespace LLVMBC
@@ -18,10 +18,12 @@
 
 #include "cfg_structurizer.hpp"
 #include "SpvBuilder.h"
+#include "budget.hpp"
 #include "logging.hpp"
 #include "node.hpp"
 #include "node_pool.hpp"
 #include "spirv_module.hpp"
+#include "statistics.hpp"
 #include <algorithm>
 #include <assert.h>
 #include <unordered_set>
@@ -97,31 +99,77 @@ void CFGStructurizer::log_cfg(const char *tag) const
 
 bool CFGStructurizer::run()
 {
-	recompute_cfg();
-	//log_cfg("Input state");
+	{
+		ScopedPhaseTimer timer(statistics, StatisticsPhase::CreateContinueBlockLadders);
+		recompute_cfg();
+		//log_cfg("Input state");
 
-	create_continue_block_ladders();
+		if (!create_continue_block_ladders())
+			return false;
+	}
 
-	split_merge_scopes();
-	recompute_cfg();
+	{
+		ScopedPhaseTimer timer(statistics, StatisticsPhase::SplitMergeScopes);
+		if (!split_merge_scopes())
+			return false;
+		recompute_cfg();
+	}
+
+	if (!check_budget())
+		return false;
 
 	//log_cfg("Split merge scopes");
 
-	//LOGI("=== Structurize pass ===\n");
-	structurize(0);
+	{
+		ScopedPhaseTimer timer(statistics, StatisticsPhase::Structurize);
+		//LOGI("=== Structurize pass ===\n");
+		if (!structurize(0))
+			return false;
 
-	recompute_cfg();
+		recompute_cfg();
+
+		//log_cfg("Structurize pass 0");
 
-	//log_cfg("Structurize pass 0");
+		//LOGI("=== Structurize pass ===\n");
+		if (!structurize(1))
+			return false;
+	}
 
-	//LOGI("=== Structurize pass ===\n");
-	structurize(1);
+	{
+		ScopedPhaseTimer timer(statistics, StatisticsPhase::InsertPhi);
+		if (!insert_phi())
+			return false;
+	}
 
-	insert_phi();
+	if (statistics)
+		for (auto *node : post_visit_order)
+			statistics->num_phis += uint32_t(node->ir.phi.size());
 
 	//validate_structured();
 	//log_cfg("Final");
-	return true;
+	return check_budget();
+}
+
+void CFGStructurizer::set_statistics(Statistics *stats)
+{
+	statistics = stats;
+}
+
+void CFGStructurizer::set_budget(BudgetTracker *budget_)
+{
+	budget = budget_;
+}
+
+bool CFGStructurizer::check_budget()
+{
+	if (budget && (!budget->check_nodes(pool.get_node_count()) ||
+	               !budget->check_arena_bytes(module.get_operation_arena_bytes())))
+	{
+		LOGE("Budget exceeded or cancelled while structurizing CFG.\n");
+		return false;
+	}
+	else
+		return true;
 }
 
 CFGNode *CFGStructurizer::get_entry_block() const
@@ -129,13 +177,157 @@ CFGNode *CFGStructurizer::get_entry_block() const
 	return entry_block;
 }
 
-void CFGStructurizer::create_continue_block_ladders()
+const std::vector<CFGNode *> &CFGStructurizer::get_visit_order() const
+{
+	return post_visit_order;
+}
+
+void CFGStructurizer::collect_loop_body(CFGNode *header, std::unordered_set<const CFGNode *> &body)
+{
+	// Walk backwards from the back edge until we hit the header, which gives us the natural loop.
+	body.insert(header);
+	std::vector<CFGNode *> stack = { header->pred_back_edge };
+	while (!stack.empty())
+	{
+		auto *node = stack.back();
+		stack.pop_back();
+		if (!body.insert(node).second)
+			continue;
+
+		for (auto *pred : node->pred)
+			stack.push_back(pred);
+		if (node->pred_back_edge)
+			stack.push_back(node->pred_back_edge);
+	}
+}
+
+bool CFGStructurizer::block_executes_on_loop_entry(const CFGNode *node, const CFGNode *header,
+                                                   const std::unordered_set<const CFGNode *> &body)
+{
+	// A block which dominates the back edge and every block which leaves the loop executes
+	// whenever the loop is entered, so moving its operations to the preheader is never speculative.
+	if (!node->dominates(header->pred_back_edge))
+		return false;
+
+	for (auto *exiting : body)
+		for (auto *succ : exiting->succ)
+			if (!body.count(succ) && !node->dominates(exiting))
+				return false;
+
+	return true;
+}
+
+void CFGStructurizer::collect_loop_invariant_operations(CFGNode *header,
+                                                        const std::unordered_set<const CFGNode *> &body,
+                                                        std::vector<Operation *> &hoisted)
+{
+	std::unordered_set<spv::Id> loop_ids;
+	for (auto *node : body)
+	{
+		for (auto &phi : node->ir.phi)
+			if (phi.id)
+				loop_ids.insert(phi.id);
+		for (auto *op : node->ir.operations)
+			if (op->id)
+				loop_ids.insert(op->id);
+	}
+
+	// Dominating blocks come first, so operations only depend on operations which were already hoisted.
+	for (auto itr = post_visit_order.rbegin(); itr != post_visit_order.rend(); ++itr)
+	{
+		auto *node = *itr;
+		if (!body.count(node) || !block_executes_on_loop_entry(node, header, body))
+			continue;
+
+		auto &ops = node->ir.operations;
+		size_t write_index = 0;
+
+		for (auto *op : ops)
+		{
+			bool invariant = op->hoistable;
+			unsigned literal_mask = op->get_literal_mask();
+			for (unsigned i = 0; invariant && i < op->num_arguments; i++, literal_mask >>= 1u)
+				if ((literal_mask & 1u) == 0 && loop_ids.count(op->arguments[i]))
+					invariant = false;
+
+			if (invariant)
+			{
+				hoisted.push_back(op);
+				if (op->id)
+					loop_ids.erase(op->id);
+			}
+			else
+				ops[write_index++] = op;
+		}
+		ops.resize(write_index);
+	}
+}
+
+bool CFGStructurizer::loop_has_preheader(const CFGNode *header)
+{
+	if (header->pred.size() != 1)
+		return false;
+
+	// Optimized code usually branches straight from a condition into the loop.
+	// We can split that edge, unless the predecessor uses the loop header as part of its own construct.
+	auto *pred = header->pred.front();
+	return pred->succ.size() == 1 ||
+	       (!pred->succ_back_edge && pred->selection_merge_block != header && pred->loop_merge_block != header);
+}
+
+CFGNode *CFGStructurizer::get_or_create_loop_preheader(CFGNode *header)
+{
+	auto *pred = header->pred.front();
+	if (pred->succ.size() == 1)
+		return pred;
+
+	auto *preheader = create_helper_pred_block(header);
+	for (auto &phi : header->ir.phi)
+		for (auto &incoming : phi.incoming)
+			if (incoming.block == pred)
+				incoming.block = preheader;
+
+	// The preheader only branches to the loop header, so it goes right after it in post-order.
+	auto itr = std::find(post_visit_order.begin(), post_visit_order.end(), header);
+	post_visit_order.insert(itr + 1, preheader);
+	return preheader;
+}
+
+void CFGStructurizer::hoist_loop_invariant_operations()
+{
+	// Inner loop headers come before outer loop headers in post-order,
+	// so invariant operations can bubble out through nested loops.
+	// Preheaders are inserted into post_visit_order as we go, so iterate by index.
+	for (size_t i = 0; i < post_visit_order.size(); i++)
+	{
+		auto *header = post_visit_order[i];
+		if (header->merge != MergeType::Loop || !header->pred_back_edge || !loop_has_preheader(header))
+			continue;
+
+		std::unordered_set<const CFGNode *> body;
+		collect_loop_body(header, body);
+
+		std::vector<Operation *> hoisted;
+		collect_loop_invariant_operations(header, body, hoisted);
+		if (hoisted.empty())
+			continue;
+
+		// Only split the entry edge once we know there is something to hoist.
+		auto &ops = get_or_create_loop_preheader(header)->ir.operations;
+		ops.insert(ops.end(), hoisted.begin(), hoisted.end());
+	}
+}
+
+bool CFGStructurizer::create_continue_block_ladders()
 {
 	// It does not seem to be legal to merge directly to continue blocks.
 	// To make it possible to merge execution, we need to create a ladder block which we can merge to.
 	bool need_recompute_cfg = false;
 	for (auto *node : post_visit_order)
 	{
+		if (!check_budget())
+			return false;
+
 		if (node->succ_back_edge && node->succ_back_edge != node)
 		{
 			//LOGI("Creating helper pred block for continue block: %s\n", node->name.c_str());
@@ -146,6 +338,7 @@ void CFGStructurizer::create_continue_block_ladders()
 
 	if (need_recompute_cfg)
 		recompute_cfg();
+	return true;
 }
 
 void CFGStructurizer::prune_dead_preds()
@@ -160,7 +353,7 @@ void CFGStructurizer::prune_dead_preds()
 	}
 }
 
-void CFGStructurizer::insert_phi()
+bool CFGStructurizer::insert_phi()
 {
 	compute_dominance_frontier();
 	prune_dead_preds();
@@ -188,9 +381,13 @@ void CFGStructurizer::insert_phi()
 
 	for (auto &phi_node : phi_nodes)
 	{
+		if (!check_budget())
+			return false;
 		fixup_phi(phi_node);
 		insert_phi(phi_node);
 	}
+
+	return true;
 }
 
 std::vector<IncomingValue>::const_iterator CFGStructurizer::find_incoming_value(
@@ -945,10 +1142,13 @@ void CFGStructurizer::rewrite_selection_breaks(CFGNode *header, CFGNode *ladder_
 	}
 }
 
-void CFGStructurizer::split_merge_scopes()
+bool CFGStructurizer::split_merge_scopes()
 {
 	for (auto *node : post_visit_order)
 	{
+		if (!check_budget())
+			return false;
+
 		// Setup a preliminary merge scope so we know when to stop traversal.
 		// We don't care about traversing inner scopes, out starting from merge block as well.
 		if (node->num_forward_preds() <= 1)
@@ -968,6 +1168,9 @@ void CFGStructurizer::split_merge_scopes()
 
 	for (auto *node : post_visit_order)
 	{
+		if (!check_budget())
+			return false;
+
 		if (node->num_forward_preds() <= 1)
 			continue;
 
@@ -995,6 +1198,7 @@ void CFGStructurizer::split_merge_scopes()
 	}
 
 	recompute_cfg();
+	return true;
 }
 
 void CFGStructurizer::recompute_cfg()
@@ -1038,10 +1242,13 @@ void CFGStructurizer::find_switch_blocks()
 	}
 }
 
-void CFGStructurizer::find_selection_merges(unsigned pass)
+bool CFGStructurizer::find_selection_merges(unsigned pass)
 {
 	for (auto *node : post_visit_order)
 	{
+		if (!check_budget())
+			return false;
+
 		if (node->num_forward_preds() <= 1)
 			continue;
 
@@ -1139,6 +1346,8 @@ void CFGStructurizer::find_selection_merges(unsigned pass)
 			LOGW("Cannot merge execution for node %p (%s).\n", static_cast<const void *>(node), node->name.c_str());
 		}
 	}
+
+	return true;
 }
 
 CFGStructurizer::LoopExitType CFGStructurizer::get_loop_exit_type(const CFGNode &header, const CFGNode &node) const
@@ -1174,6 +1383,8 @@ CFGNode *CFGStructurizer::create_helper_pred_block(CFGNode *node)
 {
 	auto *pred_node = pool.create_node();
 	pred_node->name = node->name + ".pred";
+	if (statistics)
+		statistics->num_helper_blocks++;
 
 	// Fixup visit order later.
 	pred_node->visit_order = node->visit_order;
@@ -1215,6 +1426,8 @@ CFGNode *CFGStructurizer::create_helper_succ_block(CFGNode *node)
 {
 	auto *succ_node = pool.create_node();
 	succ_node->name = node->name + ".succ";
+	if (statistics)
+		statistics->num_helper_blocks++;
 
 	// Fixup visit order later.
 	succ_node->visit_order = node->visit_order;
@@ -1348,10 +1561,13 @@ CFGNode *CFGStructurizer::find_common_post_dominator_with_ignored_break(std::vec
 	return candidates.front();
 }
 
-void CFGStructurizer::find_loops()
+bool CFGStructurizer::find_loops()
 {
 	for (auto index = post_visit_order.size(); index; index--)
 	{
+		if (!check_budget())
+			return false;
+
 		// Visit in reverse order so we resolve outer loops first,
 		// this lets us detect ladder-breaking loops.
 		auto *node = post_visit_order[index - 1];
@@ -1556,6 +1772,8 @@ void CFGStructurizer::find_loops()
 			}
 		}
 	}
+
+	return true;
 }
 
 void CFGStructurizer::split_merge_blocks()
@@ -1811,14 +2029,17 @@ void CFGStructurizer::split_merge_blocks()
 	}
 }
 
-void CFGStructurizer::structurize(unsigned pass)
+bool CFGStructurizer::structurize(unsigned pass)
 {
-	find_loops();
+	if (!find_loops())
+		return false;
 	find_switch_blocks();
-	find_selection_merges(pass);
+	if (!find_selection_merges(pass))
+		return false;
 	fixup_broken_selection_merges(pass);
 	if (pass == 0)
 		split_merge_blocks();
+	return check_budget();
 }
 
 void CFGStructurizer::recompute_dominance_frontier(CFGNode *node)
@@ -32,6 +32,8 @@ class BlockEmissionInterface;
 class SPIRVModule;
 struct CFGNode;
 class CFGNodePool;
+class BudgetTracker;
+struct Statistics;
 
 class BlockEmissionInterface
 {
@@ -46,22 +48,31 @@ class CFGStructurizer
 public:
 	CFGStructurizer(CFGNode *entry, CFGNodePool &pool, SPIRVModule &module);
 	bool run();
+	void hoist_loop_invariant_operations();
 	void traverse(BlockEmissionInterface &iface);
 	CFGNode *get_entry_block() const;
+	const std::vector<CFGNode *> &get_visit_order() const;
+	void set_statistics(Statistics *stats);
+	// If the budget is exceeded or cancelled, run() aborts early and returns false.
+	// Besides between phases, the budget is polled per node in the longer loops.
+	void set_budget(BudgetTracker *budget);
 
 private:
 	CFGNode *entry_block;
 	CFGNodePool &pool;
 	SPIRVModule &module;
+	Statistics *statistics = nullptr;
+	BudgetTracker *budget = nullptr;
+	bool check_budget();
 
 	std::vector<CFGNode *> post_visit_order;
 	std::unordered_set<const CFGNode *> reachable_nodes;
 	void visit(CFGNode &entry);
 	void build_immediate_dominators(CFGNode &entry);
-	void structurize(unsigned pass);
-	void find_loops();
-	void split_merge_scopes();
-	void find_selection_merges(unsigned pass);
+	bool structurize(unsigned pass);
+	bool find_loops();
+	bool split_merge_scopes();
+	bool find_selection_merges(unsigned pass);
 	void fixup_broken_selection_merges(unsigned pass);
 	void find_switch_blocks();
 	void split_merge_blocks();
@@ -93,7 +104,7 @@ private:
 	void validate_structured();
 	void recompute_cfg();
 	void compute_dominance_frontier();
-	void create_continue_block_ladders();
+	bool create_continue_block_ladders();
 	static void recompute_dominance_frontier(CFGNode *node);
 	static void recompute_dominance_frontier(CFGNode *header, const CFGNode *node,
 	                                         std::unordered_set<const CFGNode *> traversed);
@@ -106,7 +117,7 @@ private:
 		PHI *phi;
 	};
 	std::vector<PHINode> phi_nodes;
-	void insert_phi();
+	bool insert_phi();
 	void insert_phi(PHINode &node);
 	void fixup_phi(PHINode &node);
 	void prune_dead_preds();
@@ -114,5 +125,13 @@ private:
 	std::unordered_map<uint32_t, CFGNode *> value_id_to_block;
 
 	void log_cfg(const char *tag) const;
+
+	static void collect_loop_body(CFGNode *header, std::unordered_set<const CFGNode *> &body);
+	static bool block_executes_on_loop_entry(const CFGNode *node, const CFGNode *header,
+	                                         const std::unordered_set<const CFGNode *> &body);
+	void collect_loop_invariant_operations(CFGNode *header, const std::unordered_set<const CFGNode *> &body,
+	                                       std::vector<Operation *> &hoisted);
+	static bool loop_has_preheader(const CFGNode *header);
+	CFGNode *get_or_create_loop_preheader(CFGNode *header);
 };
 } // namespace dxil_spv
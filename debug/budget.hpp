@@ -0,0 +1,123 @@
+/*
+ * Copyright 2019-2020 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace dxil_spv
+{
+// Limits for parsing and conversion. Zero means unlimited.
+struct Budget
+{
+	uint32_t max_nodes = 0;
+	uint32_t max_operations = 0;
+	size_t max_arena_bytes = 0;
+	uint64_t max_time_ns = 0;
+};
+
+// Checked at cheap points, e.g. once per block, so pathological shaders fail early instead of stalling.
+// Once a limit is hit, the budget stays exceeded.
+// The same points observe an optional cancellation flag, so abandoned work stops promptly.
+class BudgetTracker
+{
+public:
+	explicit BudgetTracker(const Budget &budget_)
+	    : budget(budget_)
+	    , start(std::chrono::steady_clock::now())
+	{
+	}
+
+	void set_cancellation_flag(const std::atomic<bool> *flag)
+	{
+		cancel_flag = flag;
+	}
+
+	void add_operation()
+	{
+		num_operations++;
+	}
+
+	bool check_nodes(size_t num_nodes)
+	{
+		if (budget.max_nodes && num_nodes > budget.max_nodes)
+			exceeded = true;
+		return check();
+	}
+
+	// Arenas which no longer grow, e.g. the parsed module during conversion, count towards every arena check.
+	void set_fixed_arena_bytes(size_t num_bytes)
+	{
+		fixed_arena_bytes = num_bytes;
+	}
+
+	bool check_arena_bytes(size_t num_bytes)
+	{
+		if (budget.max_arena_bytes && fixed_arena_bytes + num_bytes > budget.max_arena_bytes)
+			exceeded = true;
+		return check();
+	}
+
+	// Checks cancellation, operation count and time.
+	bool check()
+	{
+		if (cancel_flag && cancel_flag->load(std::memory_order_relaxed))
+			cancelled = true;
+
+		if (budget.max_operations && num_operations > budget.max_operations)
+			exceeded = true;
+
+		if (!exceeded && budget.max_time_ns)
+		{
+			auto elapsed = std::chrono::steady_clock::now() - start;
+			if (uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) > budget.max_time_ns)
+				exceeded = true;
+		}
+
+		return !exceeded && !cancelled;
+	}
+
+	// Time where the tracked work was preempted by other work does not count against the time budget.
+	void exclude_time(uint64_t ns)
+	{
+		start += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(ns));
+	}
+
+	bool is_exceeded() const
+	{
+		return exceeded;
+	}
+
+	bool is_cancelled() const
+	{
+		return cancelled;
+	}
+
+private:
+	Budget budget;
+	std::chrono::steady_clock::time_point start;
+	const std::atomic<bool> *cancel_flag = nullptr;
+	uint64_t num_operations = 0;
+	size_t fixed_arena_bytes = 0;
+	bool exceeded = false;
+	bool cancelled = false;
+};
+} // namespace dxil_spv
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2019-2020 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace dxil_spv
+{
+// Arenas allocate their blocks through these callbacks. If allocate is nullptr, malloc and free are used.
+// Every block remembers the callbacks it was allocated with, so it is always freed through the same callbacks.
+struct AllocationCallbacks
+{
+	void *(*allocate)(void *userdata, size_t size, size_t alignment);
+	void (*free)(void *userdata, void *ptr);
+	void *userdata;
+};
+
+inline AllocationCallbacks &get_global_allocation_callbacks()
+{
+	static AllocationCallbacks callbacks = {};
+	return callbacks;
+}
+
+inline const AllocationCallbacks *&get_thread_allocation_callbacks()
+{
+	static thread_local const AllocationCallbacks *callbacks = nullptr;
+	return callbacks;
+}
+
+// Must not race with allocations on other threads.
+inline void set_global_allocation_callbacks(const AllocationCallbacks *callbacks)
+{
+	get_global_allocation_callbacks() = callbacks ? *callbacks : AllocationCallbacks{};
+}
+
+// Callbacks for new allocations. Callbacks scoped to this thread take precedence over global ones.
+inline AllocationCallbacks get_allocation_callbacks()
+{
+	auto *callbacks = get_thread_allocation_callbacks();
+	return callbacks ? *callbacks : get_global_allocation_callbacks();
+}
+
+// Number of arena allocations made on this thread, so statistics can report allocation traffic.
+inline uint64_t &get_thread_allocation_count()
+{
+	static thread_local uint64_t count = 0;
+	return count;
+}
+
+inline void *allocate_memory(const AllocationCallbacks &callbacks, size_t size, size_t alignment)
+{
+	get_thread_allocation_count()++;
+	if (callbacks.allocate)
+		return callbacks.allocate(callbacks.userdata, size, alignment);
+	else
+		return ::malloc(size);
+}
+
+inline void free_memory(const AllocationCallbacks &callbacks, void *ptr)
+{
+	if (callbacks.allocate)
+	{
+		if (callbacks.free)
+			callbacks.free(callbacks.userdata, ptr);
+	}
+	else
+		::free(ptr);
+}
+
+// Routes allocations on this thread through callbacks while in scope. Does nothing if callbacks is nullptr.
+class ScopedAllocationCallbacks
+{
+public:
+	explicit ScopedAllocationCallbacks(const AllocationCallbacks *callbacks)
+	    : saved(get_thread_allocation_callbacks())
+	{
+		if (callbacks)
+			get_thread_allocation_callbacks() = callbacks;
+	}
+
+	~ScopedAllocationCallbacks()
+	{
+		get_thread_allocation_callbacks() = saved;
+	}
+
+	ScopedAllocationCallbacks(const ScopedAllocationCallbacks &) = delete;
+	void operator=(const ScopedAllocationCallbacks &) = delete;
+
+private:
+	const AllocationCallbacks *saved;
+};
+} // namespace dxil_spv
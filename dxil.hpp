@@ -555,4 +555,211 @@ enum class ShaderKind
 	Amplification,
 	Invalid
 };
+
+// Layout of the pipeline state validation (PSV0) part.
+// Every table in the part is prefixed with its element size, so newer versions only append members.
+struct PSVRuntimeInfo0
+{
+	uint32_t stage_info[4];
+	uint32_t min_expected_wave_lane_count;
+	uint32_t max_expected_wave_lane_count;
+};
+
+// PSV has its own stage numbering, which diverges from ShaderKind after Library.
+enum class PSVShaderKind : uint8_t
+{
+	Pixel = 0,
+	Vertex,
+	Geometry,
+	Hull,
+	Domain,
+	Compute,
+	Library,
+	Mesh,
+	Amplification,
+	Invalid
+};
+
+struct PSVRuntimeInfo1 : PSVRuntimeInfo0
+{
+	// PSVShaderKind.
+	uint8_t shader_stage;
+	uint8_t uses_view_id;
+	uint16_t max_vertex_count_or_patch_constant_vectors;
+	uint8_t sig_input_elements;
+	uint8_t sig_output_elements;
+	uint8_t sig_patch_constant_or_primitive_elements;
+	uint8_t sig_input_vectors;
+	uint8_t sig_output_vectors[4];
+};
+
+enum class PSVResourceType : uint32_t
+{
+	Invalid = 0,
+	Sampler,
+	CBV,
+	SRVTyped,
+	SRVRaw,
+	SRVStructured,
+	UAVTyped,
+	UAVRaw,
+	UAVStructured,
+	UAVStructuredWithCounter
+};
+
+struct PSVResourceBindInfo0
+{
+	PSVResourceType resource_type;
+	uint32_t space;
+	uint32_t lower_bound;
+	uint32_t upper_bound;
+};
+
+struct PSVResourceBindInfo1 : PSVResourceBindInfo0
+{
+	uint32_t resource_kind;
+	uint32_t resource_flags;
+};
+
+struct PSVSignatureElement0
+{
+	uint32_t semantic_name_offset;
+	uint32_t semantic_indices_offset;
+	uint8_t rows;
+	uint8_t start_row;
+	// Bits 0-3: columns, bits 4-5: start column, bit 6: allocated.
+	uint8_t cols_and_start;
+	uint8_t semantic_kind;
+	uint8_t component_type;
+	uint8_t interpolation_mode;
+	// Bits 0-3: dynamic index mask, bits 4-5: output stream.
+	uint8_t dynamic_mask_and_stream;
+	uint8_t reserved;
+};
+
+enum class PSVSignature
+{
+	Input,
+	Output,
+	PatchConstantOrPrimitive,
+	Count
+};
+
+// Layout of the serialized root signature (RTS0) part. All offsets are relative to the start of the part.
+enum class RootSignatureVersion : uint32_t
+{
+	Version1_0 = 1,
+	Version1_1 = 2
+};
+
+struct RootSignatureDesc
+{
+	RootSignatureVersion version;
+	uint32_t num_parameters;
+	uint32_t parameters_offset;
+	uint32_t num_static_samplers;
+	uint32_t static_samplers_offset;
+	uint32_t flags;
+};
+
+enum class RootParameterType : uint32_t
+{
+	DescriptorTable = 0,
+	Constants32Bit = 1,
+	CBV = 2,
+	SRV = 3,
+	UAV = 4
+};
+
+// Values up to Pixel match ShaderStage in the converter.
+enum class ShaderVisibility : uint32_t
+{
+	All = 0,
+	Vertex = 1,
+	Hull = 2,
+	Domain = 3,
+	Geometry = 4,
+	Pixel = 5,
+	Amplification = 6,
+	Mesh = 7
+};
+
+struct RootParameter
+{
+	RootParameterType parameter_type;
+	ShaderVisibility visibility;
+	uint32_t payload_offset;
+};
+
+struct RootDescriptorTable
+{
+	uint32_t num_ranges;
+	uint32_t ranges_offset;
+};
+
+// Matches ResourceType.
+enum class DescriptorRangeType : uint32_t
+{
+	SRV = 0,
+	UAV = 1,
+	CBV = 2,
+	Sampler = 3
+};
+
+constexpr uint32_t DescriptorRangeOffsetAppend = 0xffffffffu;
+constexpr uint32_t UnboundedDescriptorCount = 0xffffffffu;
+
+struct DescriptorRange0
+{
+	DescriptorRangeType range_type;
+	uint32_t num_descriptors;
+	uint32_t base_register;
+	uint32_t register_space;
+	uint32_t offset_in_table;
+};
+
+struct DescriptorRange1
+{
+	DescriptorRangeType range_type;
+	uint32_t num_descriptors;
+	uint32_t base_register;
+	uint32_t register_space;
+	uint32_t flags;
+	uint32_t offset_in_table;
+};
+
+struct RootConstants
+{
+	uint32_t register_index;
+	uint32_t register_space;
+	uint32_t num_32bit_values;
+};
+
+struct RootDescriptor0
+{
+	uint32_t register_index;
+	uint32_t register_space;
+};
+
+struct RootDescriptor1 : RootDescriptor0
+{
+	uint32_t flags;
+};
+
+struct StaticSampler
+{
+	uint32_t filter;
+	uint32_t address_u;
+	uint32_t address_v;
+	uint32_t address_w;
+	float mip_lod_bias;
+	uint32_t max_anisotropy;
+	uint32_t comparison_func;
+	uint32_t border_color;
+	float min_lod;
+	float max_lod;
+	uint32_t register_index;
+	uint32_t register_space;
+	ShaderVisibility visibility;
+};
 } // namespace DXIL
@@ -17,6 +17,7 @@
  */
 
 #include "opcodes/converter_impl.hpp"
+#include "opcodes/dxil/dxil_common.hpp"
 #include "opcodes/opcodes_dxil_builtins.hpp"
 #include "opcodes/opcodes_llvm_builtins.hpp"
 
@@ -300,6 +301,23 @@ void Converter::Impl::register_resource_meta_reference(const llvm::MDOperand &op
 	}
 }
 
+bool Converter::Impl::export_references_global(const llvm::Value *value) const
+{
+	return !library_export || library_export->globals.count(value) != 0;
+}
+
+bool Converter::Impl::export_references_resource(const llvm::MDNode *resource) const
+{
+	if (!library_export)
+		return true;
+
+	auto &operand = resource->getOperand(1);
+	if (!operand)
+		return false;
+	auto *value = llvm::cast<llvm::ConstantAsMetadata>(operand)->getValue();
+	return export_references_global(value);
+}
+
 bool Converter::Impl::emit_resources_global_mapping(DXIL::ResourceType type, const llvm::MDNode *node)
 {
 	unsigned num_resources = node->getNumOperands();
@@ -308,6 +326,23 @@ bool Converter::Impl::emit_resources_global_mapping(DXIL::ResourceType type, con
 		auto *resource = llvm::cast<llvm::MDNode>(node->getOperand(i));
 		unsigned index = get_constant_metadata(resource, 0);
 		register_resource_meta_reference(resource->getOperand(1), type, index);
+
+		// Remember the sampled component type of typed SRVs and UAVs, so analysis can reason about signedness
+		// before any handles are emitted.
+		unsigned tags_index = type == DXIL::ResourceType::SRV ? 8 : 10;
+		if ((type == DXIL::ResourceType::SRV || type == DXIL::ResourceType::UAV) &&
+		    resource->getNumOperands() > tags_index && resource->getOperand(tags_index))
+		{
+			auto *tags = llvm::dyn_cast<llvm::MDNode>(resource->getOperand(tags_index));
+			if (tags && get_constant_metadata(tags, 0) == 0)
+			{
+				auto component_type = static_cast<DXIL::ComponentType>(get_constant_metadata(tags, 1));
+				if (type == DXIL::ResourceType::SRV)
+					srv_index_to_typed_component_type[index] = component_type;
+				else
+					uav_index_to_typed_component_type[index] = component_type;
+			}
+		}
 	}
 	return true;
 }
@@ -320,6 +355,9 @@ bool Converter::Impl::emit_srvs(const llvm::MDNode *srvs)
 	for (unsigned i = 0; i < num_srvs; i++)
 	{
 		auto *srv = llvm::cast<llvm::MDNode>(srvs->getOperand(i));
+		if (!export_references_resource(srv))
+			continue;
+
 		unsigned index = get_constant_metadata(srv, 0);
 		auto name = get_string_metadata(srv, 2);
 		unsigned bind_space = get_constant_metadata(srv, 3);
@@ -477,6 +515,9 @@ bool Converter::Impl::emit_uavs(const llvm::MDNode *uavs)
 	for (unsigned i = 0; i < num_uavs; i++)
 	{
 		auto *uav = llvm::cast<llvm::MDNode>(uavs->getOperand(i));
+		if (!export_references_resource(uav))
+			continue;
+
 		unsigned index = get_constant_metadata(uav, 0);
 		auto name = get_string_metadata(uav, 2);
 		unsigned bind_space = get_constant_metadata(uav, 3);
@@ -759,6 +800,9 @@ bool Converter::Impl::emit_cbvs(const llvm::MDNode *cbvs)
 	for (unsigned i = 0; i < num_cbvs; i++)
 	{
 		auto *cbv = llvm::cast<llvm::MDNode>(cbvs->getOperand(i));
+		if (!export_references_resource(cbv))
+			continue;
+
 		unsigned index = get_constant_metadata(cbv, 0);
 		auto name = get_string_metadata(cbv, 2);
 		unsigned bind_space = get_constant_metadata(cbv, 3);
@@ -898,6 +942,9 @@ bool Converter::Impl::emit_samplers(const llvm::MDNode *samplers)
 	for (unsigned i = 0; i < num_samplers; i++)
 	{
 		auto *sampler = llvm::cast<llvm::MDNode>(samplers->getOperand(i));
+		if (!export_references_resource(sampler))
+			continue;
+
 		unsigned index = get_constant_metadata(sampler, 0);
 		auto name = get_string_metadata(sampler, 2);
 		unsigned bind_space = get_constant_metadata(sampler, 3);
@@ -1079,15 +1126,49 @@ void Converter::Impl::emit_root_constants(unsigned num_words)
 {
 	auto &builder = spirv_module.get_builder();
 
-	// Root constants cannot be dynamically indexed in DXIL, so emit them as members.
-	std::vector<spv::Id> members(num_words);
-	for (auto &memb : members)
-		memb = builder.makeUintType(32);
+	spv::Id type_id;
+	// Uniform blocks need a 16 byte array stride, so the spec sized array of words is only used for push constants.
+	// Full rows are only known with a static word count.
+	root_constant_array = options.root_constant_word_count_spec_constant && !options.inline_ubo_enable;
+	root_constant_vectorized = !root_constant_array && options.vectorized_root_constants && (num_words & 3) == 0;
 
-	spv::Id type_id = get_struct_type(members, "RootConstants");
-	builder.addDecoration(type_id, spv::DecorationBlock);
-	for (unsigned i = 0; i < num_words; i++)
-		builder.addMemberDecoration(type_id, i, spv::DecorationOffset, 4 * i);
+	if (root_constant_array)
+	{
+		// The block size comes from the pipeline, so one module serves any word count up to num_words.
+		spv::Id count_id = builder.makeUintConstant(num_words, true);
+		builder.addDecoration(count_id, spv::DecorationSpecId, options.root_constant_word_count_spec_id);
+		spv::Id array_type_id = builder.makeArrayType(builder.makeUintType(32), count_id, 4);
+		builder.addDecoration(array_type_id, spv::DecorationArrayStride, 4);
+
+		type_id = get_struct_type({ array_type_id }, "RootConstants");
+		builder.addDecoration(type_id, spv::DecorationBlock);
+		builder.addMemberName(type_id, 0, "words");
+		builder.addMemberDecoration(type_id, 0, spv::DecorationOffset, 0);
+	}
+	else if (root_constant_vectorized)
+	{
+		// Declare the block as rows of uvec4, so a CBufferLoadLegacy can be a single vector load.
+		spv::Id row_type_id = builder.makeVectorType(builder.makeUintType(32), 4);
+		spv::Id array_type_id = builder.makeArrayType(row_type_id, builder.makeUintConstant(num_words / 4), 16);
+		builder.addDecoration(array_type_id, spv::DecorationArrayStride, 16);
+
+		type_id = get_struct_type({ array_type_id }, "RootConstants");
+		builder.addDecoration(type_id, spv::DecorationBlock);
+		builder.addMemberName(type_id, 0, "rows");
+		builder.addMemberDecoration(type_id, 0, spv::DecorationOffset, 0);
+	}
+	else
+	{
+		// Root constants cannot be dynamically indexed in DXIL, so emit them as members.
+		std::vector<spv::Id> members(num_words);
+		for (auto &memb : members)
+			memb = builder.makeUintType(32);
+
+		type_id = get_struct_type(members, "RootConstants");
+		builder.addDecoration(type_id, spv::DecorationBlock);
+		for (unsigned i = 0; i < num_words; i++)
+			builder.addMemberDecoration(type_id, i, spv::DecorationOffset, 4 * i);
+	}
 
 	if (options.inline_ubo_enable)
 	{
@@ -1442,9 +1523,22 @@ spv::Id Converter::Impl::get_id_for_value(const llvm::Value *value, unsigned for
 	return ret;
 }
 
-static llvm::MDNode *get_entry_point_meta(const llvm::Module &module)
+static const char *get_entry_point_name(const llvm::MDNode *node)
+{
+	if (node->getNumOperands() < 2 || !node->getOperand(1))
+		return nullptr;
+	auto *name = llvm::dyn_cast<llvm::MDString>(node->getOperand(1));
+	return name ? name->getString().data() : nullptr;
+}
+
+// Libraries have one node per export, and a node without function for the library itself.
+// If entry is nullptr, the first node with a function is used.
+static llvm::MDNode *get_entry_point_meta(const llvm::Module &module, const char *entry)
 {
 	auto *ep_meta = module.getNamedMetadata("dx.entryPoints");
+	if (!ep_meta)
+		return nullptr;
+
 	unsigned num_entry_points = ep_meta->getNumOperands();
 	for (unsigned i = 0; i < num_entry_points; i++)
 	{
@@ -1452,7 +1546,14 @@ static llvm::MDNode *get_entry_point_meta(const llvm::Module &module)
 		if (node)
 		{
 			auto &func_node = node->getOperand(0);
-			if (func_node)
+			if (!func_node)
+				continue;
+
+			if (!entry)
+				return node;
+
+			auto *name = get_entry_point_name(node);
+			if (name && strcmp(name, entry) == 0)
 				return node;
 		}
 	}
@@ -1460,9 +1561,8 @@ static llvm::MDNode *get_entry_point_meta(const llvm::Module &module)
 	return nullptr;
 }
 
-static llvm::Function *get_entry_point_function(const llvm::Module &module)
+static llvm::Function *get_entry_point_function(const llvm::MDNode *node)
 {
-	auto *node = get_entry_point_meta(module);
 	if (!node)
 		return nullptr;
 
@@ -1474,9 +1574,8 @@ static llvm::Function *get_entry_point_function(const llvm::Module &module)
 		return nullptr;
 }
 
-static const llvm::MDOperand *get_shader_property_tag(const llvm::Module &module, DXIL::ShaderPropertyTag tag)
+static const llvm::MDOperand *get_shader_property_tag(const llvm::MDNode *func_meta, DXIL::ShaderPropertyTag tag)
 {
-	auto *func_meta = get_entry_point_meta(module);
 	if (func_meta && func_meta->getNumOperands() >= 5 && func_meta->getOperand(4))
 	{
 		auto *tag_values = llvm::dyn_cast<llvm::MDNode>(func_meta->getOperand(4));
@@ -1489,9 +1588,9 @@ static const llvm::MDOperand *get_shader_property_tag(const llvm::Module &module
 	return nullptr;
 }
 
-static spv::ExecutionModel get_execution_model(const llvm::Module &module)
+static spv::ExecutionModel get_execution_model(const llvm::Module &module, const llvm::MDNode *entry_point_meta)
 {
-	if (auto *tag = get_shader_property_tag(module, DXIL::ShaderPropertyTag::ShaderKind))
+	if (auto *tag = get_shader_property_tag(entry_point_meta, DXIL::ShaderPropertyTag::ShaderKind))
 	{
 		if (!tag)
 			return spv::ExecutionModelMax;
@@ -1703,9 +1802,7 @@ spv::Id Converter::Impl::get_type_id(spv::Id id) const
 
 bool Converter::Impl::emit_patch_variables()
 {
-	auto &module = bitcode_parser.get_module();
-	auto *ep_meta = module.getNamedMetadata("dx.entryPoints");
-	auto *node = ep_meta->getOperand(0);
+	auto *node = entry_point_meta;
 
 	if (!node->getOperand(2))
 		return true;
@@ -1795,10 +1892,7 @@ bool Converter::Impl::emit_patch_variables()
 
 bool Converter::Impl::emit_stage_output_variables()
 {
-	auto &module = bitcode_parser.get_module();
-
-	auto *ep_meta = module.getNamedMetadata("dx.entryPoints");
-	auto *node = ep_meta->getOperand(0);
+	auto *node = entry_point_meta;
 
 	if (!node->getOperand(2))
 		return true;
@@ -2200,8 +2294,7 @@ static bool execution_model_has_hit_attribute(spv::ExecutionModel model)
 bool Converter::Impl::emit_incoming_ray_payload()
 {
 	auto &builder = spirv_module.get_builder();
-	auto &module = bitcode_parser.get_module();
-	auto *func = get_entry_point_function(module);
+	auto *func = get_entry_point_function(entry_point_meta);
 
 	// The first argument to a RT entry point is always a pointer to payload.
 	if (func->arg_end() - func->arg_begin() >= 1)
@@ -2227,8 +2320,7 @@ bool Converter::Impl::emit_incoming_ray_payload()
 bool Converter::Impl::emit_hit_attribute()
 {
 	auto &builder = spirv_module.get_builder();
-	auto &module = bitcode_parser.get_module();
-	auto *func = get_entry_point_function(module);
+	auto *func = get_entry_point_function(entry_point_meta);
 
 	// The second argument to a RT entry point is always a pointer to hit attribute.
 	if (func->arg_end() - func->arg_begin() >= 2)
@@ -2264,6 +2356,8 @@ bool Converter::Impl::emit_global_variables()
 	for (auto itr = module.global_begin(); itr != module.global_end(); ++itr)
 	{
 		llvm::GlobalVariable &global = *itr;
+		if (!export_references_global(&global))
+			continue;
 
 		{
 			auto *elem_type = global.getType()->getPointerElementType();
@@ -2322,10 +2416,7 @@ bool Converter::Impl::emit_global_variables()
 
 bool Converter::Impl::emit_stage_input_variables()
 {
-	auto &module = bitcode_parser.get_module();
-
-	auto *ep_meta = module.getNamedMetadata("dx.entryPoints");
-	auto *node = ep_meta->getOperand(0);
+	auto *node = entry_point_meta;
 	if (!node->getOperand(2))
 		return true;
 
@@ -2622,7 +2713,7 @@ void Converter::Impl::repack_sparse_feedback(DXIL::ComponentType component_type,
 
 void Converter::Impl::fixup_load_sign(DXIL::ComponentType component_type, unsigned components, const llvm::Value *value)
 {
-	if (component_type == DXIL::ComponentType::I32)
+	if (component_type == DXIL::ComponentType::I32 && llvm_values_signed_integer.count(value) == 0)
 	{
 		Operation *op = allocate(spv::OpBitcast, get_type_id(DXIL::ComponentType::U32, 1, components));
 		op->add_id(get_id_for_value(value));
@@ -2644,6 +2735,29 @@ spv::Id Converter::Impl::fixup_store_sign(DXIL::ComponentType component_type, un
 		return value;
 }
 
+spv::Id Converter::Impl::build_typed_store_value(DXIL::ComponentType component_type,
+                                                 const llvm::CallInst *instruction, unsigned first_value_operand,
+                                                 spv::Id *values)
+{
+	if (component_type == DXIL::ComponentType::I32 && llvm_values_signed_integer.count(instruction))
+	{
+		// All stored values were kept in signed form, so we can write them directly.
+		spv::Id int_type_id = get_type_id(DXIL::ComponentType::I32, 1, 1);
+		spv::Id signed_values[4];
+		for (unsigned i = 0; i < 4; i++)
+		{
+			if (llvm::isa<llvm::UndefValue>(instruction->getOperand(first_value_operand + i)))
+				signed_values[i] = builder().createUndefined(int_type_id);
+			else
+				signed_values[i] = values[i];
+		}
+		return build_vector(int_type_id, signed_values, 4);
+	}
+
+	spv::Id element_type_id = get_type_id(instruction->getOperand(first_value_operand)->getType());
+	return fixup_store_sign(component_type, 4, build_vector(element_type_id, values, 4));
+}
+
 bool Converter::Impl::emit_phi_instruction(CFGNode *block, const llvm::PHINode &instruction)
 {
 	PHI phi;
@@ -2664,6 +2778,107 @@ bool Converter::Impl::emit_phi_instruction(CFGNode *block, const llvm::PHINode &
 	return true;
 }
 
+struct EmitInstructionVisitor
+{
+	Converter::Impl &impl;
+	CFGNode *block;
+
+	bool operator()(const llvm::CallInst &inst) const
+	{
+		if (is_dxil_op_call(&inst))
+			return emit_dxil_instruction(impl, &inst);
+
+		LOGE("Normal function call currently unsupported ...\n");
+		return false;
+	}
+
+	bool operator()(const llvm::BinaryOperator &inst) const
+	{
+		return emit_binary_instruction(impl, &inst);
+	}
+
+	bool operator()(const llvm::UnaryOperator &inst) const
+	{
+		return emit_unary_instruction(impl, &inst);
+	}
+
+	bool operator()(const llvm::CastInst &inst) const
+	{
+		return emit_cast_instruction(impl, &inst);
+	}
+
+	bool operator()(const llvm::GetElementPtrInst &inst) const
+	{
+		return emit_getelementptr_instruction(impl, &inst);
+	}
+
+	bool operator()(const llvm::LoadInst &inst) const
+	{
+		return emit_load_instruction(impl, &inst);
+	}
+
+	bool operator()(const llvm::StoreInst &inst) const
+	{
+		return emit_store_instruction(impl, &inst);
+	}
+
+	bool operator()(const llvm::CmpInst &inst) const
+	{
+		return emit_compare_instruction(impl, &inst);
+	}
+
+	bool operator()(const llvm::ExtractValueInst &inst) const
+	{
+		return emit_extract_value_instruction(impl, &inst);
+	}
+
+	bool operator()(const llvm::AllocaInst &inst) const
+	{
+		return emit_alloca_instruction(impl, &inst);
+	}
+
+	bool operator()(const llvm::SelectInst &inst) const
+	{
+		return emit_select_instruction(impl, &inst);
+	}
+
+	bool operator()(const llvm::AtomicRMWInst &inst) const
+	{
+		return emit_atomicrmw_instruction(impl, &inst);
+	}
+
+	bool operator()(const llvm::AtomicCmpXchgInst &inst) const
+	{
+		return emit_cmpxchg_instruction(impl, &inst);
+	}
+
+	bool operator()(const llvm::ShuffleVectorInst &inst) const
+	{
+		return emit_shufflevector_instruction(impl, &inst);
+	}
+
+	bool operator()(const llvm::ExtractElementInst &inst) const
+	{
+		return emit_extractelement_instruction(impl, &inst);
+	}
+
+	bool operator()(const llvm::InsertElementInst &inst) const
+	{
+		return emit_insertelement_instruction(impl, &inst);
+	}
+
+	bool operator()(const llvm::PHINode &inst) const
+	{
+		return impl.emit_phi_instruction(block, inst);
+	}
+
+	bool operator()(const llvm::Value &) const
+	{
+		impl.current_block = nullptr;
+		return false;
+	}
+};
+
 bool Converter::Impl::emit_instruction(CFGNode *block, const llvm::Instruction &instruction)
 {
 	if (instruction.isTerminator())
@@ -2671,62 +2886,15 @@ bool Converter::Impl::emit_instruction(CFGNode *block, const llvm::Instruction &
 
 	current_block = &block->ir.operations;
 
-	if (auto *call_inst = llvm::dyn_cast<llvm::CallInst>(&instruction))
-	{
-		auto *called_function = call_inst->getCalledFunction();
-		if (strncmp(called_function->getName().data(), "dx.op", 5) == 0)
-		{
-			return emit_dxil_instruction(*this, call_inst);
-		}
-		else
-		{
-			LOGE("Normal function call currently unsupported ...\n");
-			return false;
-		}
-	}
-	else if (auto *binary_inst = llvm::dyn_cast<llvm::BinaryOperator>(&instruction))
-		return emit_binary_instruction(*this, binary_inst);
-	else if (auto *unary_inst = llvm::dyn_cast<llvm::UnaryOperator>(&instruction))
-		return emit_unary_instruction(*this, unary_inst);
-	else if (auto *cast_inst = llvm::dyn_cast<llvm::CastInst>(&instruction))
-		return emit_cast_instruction(*this, cast_inst);
-	else if (auto *getelementptr_inst = llvm::dyn_cast<llvm::GetElementPtrInst>(&instruction))
-		return emit_getelementptr_instruction(*this, getelementptr_inst);
-	else if (auto *load_inst = llvm::dyn_cast<llvm::LoadInst>(&instruction))
-		return emit_load_instruction(*this, load_inst);
-	else if (auto *store_inst = llvm::dyn_cast<llvm::StoreInst>(&instruction))
-		return emit_store_instruction(*this, store_inst);
-	else if (auto *compare_inst = llvm::dyn_cast<llvm::CmpInst>(&instruction))
-		return emit_compare_instruction(*this, compare_inst);
-	else if (auto *extract_inst = llvm::dyn_cast<llvm::ExtractValueInst>(&instruction))
-		return emit_extract_value_instruction(*this, extract_inst);
-	else if (auto *alloca_inst = llvm::dyn_cast<llvm::AllocaInst>(&instruction))
-		return emit_alloca_instruction(*this, alloca_inst);
-	else if (auto *select_inst = llvm::dyn_cast<llvm::SelectInst>(&instruction))
-		return emit_select_instruction(*this, select_inst);
-	else if (auto *atomic_inst = llvm::dyn_cast<llvm::AtomicRMWInst>(&instruction))
-		return emit_atomicrmw_instruction(*this, atomic_inst);
-	else if (auto *cmpxchg_inst = llvm::dyn_cast<llvm::AtomicCmpXchgInst>(&instruction))
-		return emit_cmpxchg_instruction(*this, cmpxchg_inst);
-	else if (auto *shufflevec_inst = llvm::dyn_cast<llvm::ShuffleVectorInst>(&instruction))
-		return emit_shufflevector_instruction(*this, shufflevec_inst);
-	else if (auto *extractelement_inst = llvm::dyn_cast<llvm::ExtractElementInst>(&instruction))
-		return emit_extractelement_instruction(*this, extractelement_inst);
-	else if (auto *insertelement_inst = llvm::dyn_cast<llvm::InsertElementInst>(&instruction))
-		return emit_insertelement_instruction(*this, insertelement_inst);
-	else if (auto *phi_inst = llvm::dyn_cast<llvm::PHINode>(&instruction))
-		return emit_phi_instruction(block, *phi_inst);
-
-	current_block = nullptr;
-	return false;
+	EmitInstructionVisitor visitor = { *this, block };
+	return dispatch_instruction(instruction, visitor);
 }
 
 bool Converter::Impl::emit_execution_modes_compute()
 {
-	auto &module = bitcode_parser.get_module();
 	auto &builder = spirv_module.get_builder();
 
-	auto *num_threads_node = get_shader_property_tag(module, DXIL::ShaderPropertyTag::NumThreads);
+	auto *num_threads_node = get_shader_property_tag(entry_point_meta, DXIL::ShaderPropertyTag::NumThreads);
 	if (num_threads_node)
 	{
 		auto *num_threads = llvm::cast<llvm::MDNode>(*num_threads_node);
@@ -2744,10 +2912,9 @@ bool Converter::Impl::emit_execution_modes_compute()
 
 bool Converter::Impl::emit_execution_modes_pixel()
 {
-	auto &module = bitcode_parser.get_module();
 	auto &builder = spirv_module.get_builder();
 
-	auto *flags_node = get_shader_property_tag(module, DXIL::ShaderPropertyTag::ShaderFlags);
+	auto *flags_node = get_shader_property_tag(entry_point_meta, DXIL::ShaderPropertyTag::ShaderFlags);
 	if (flags_node)
 	{
 		auto flags = llvm::cast<llvm::ConstantAsMetadata>(*flags_node)->getValue()->getUniqueInteger().getZExtValue();
@@ -2760,11 +2927,10 @@ bool Converter::Impl::emit_execution_modes_pixel()
 
 bool Converter::Impl::emit_execution_modes_domain()
 {
-	auto &module = bitcode_parser.get_module();
 	auto &builder = spirv_module.get_builder();
 	builder.addCapability(spv::CapabilityTessellation);
 
-	auto *ds_state_node = get_shader_property_tag(module, DXIL::ShaderPropertyTag::DSState);
+	auto *ds_state_node = get_shader_property_tag(entry_point_meta, DXIL::ShaderPropertyTag::DSState);
 	if (ds_state_node)
 	{
 		auto *arguments = llvm::cast<llvm::MDNode>(*ds_state_node);
@@ -2800,10 +2966,9 @@ bool Converter::Impl::emit_execution_modes_domain()
 
 bool Converter::Impl::emit_execution_modes_hull()
 {
-	auto &module = bitcode_parser.get_module();
 	auto &builder = spirv_module.get_builder();
 	builder.addCapability(spv::CapabilityTessellation);
-	auto *hs_state_node = get_shader_property_tag(module, DXIL::ShaderPropertyTag::HSState);
+	auto *hs_state_node = get_shader_property_tag(entry_point_meta, DXIL::ShaderPropertyTag::HSState);
 
 	if (hs_state_node)
 	{
@@ -2899,10 +3064,9 @@ bool Converter::Impl::emit_execution_modes_hull()
 
 bool Converter::Impl::emit_execution_modes_geometry()
 {
-	auto &module = bitcode_parser.get_module();
 	auto &builder = spirv_module.get_builder();
 	builder.addCapability(spv::CapabilityGeometry);
-	auto *gs_state_node = get_shader_property_tag(module, DXIL::ShaderPropertyTag::GSState);
+	auto *gs_state_node = get_shader_property_tag(entry_point_meta, DXIL::ShaderPropertyTag::GSState);
 
 	if (gs_state_node)
 	{
@@ -3002,7 +3166,7 @@ bool Converter::Impl::emit_execution_modes_ray_tracing(spv::ExecutionModel model
 bool Converter::Impl::emit_execution_modes()
 {
 	auto &module = bitcode_parser.get_module();
-	execution_model = get_execution_model(module);
+	execution_model = get_execution_model(module, entry_point_meta);
 
 	switch (execution_model)
 	{
@@ -3125,52 +3289,27 @@ CFGNode *Converter::Impl::build_hull_main(llvm::Function *func, CFGNodePool &poo
 
 CFGNode *Converter::Impl::convert_function(llvm::Function *func, CFGNodePool &pool)
 {
-	auto *entry = &func->getEntryBlock();
-	auto entry_meta = std::make_unique<BlockMeta>(entry);
-	bb_map[entry] = entry_meta.get();
-	auto *entry_node = pool.create_node();
-	bb_map[entry]->node = entry_node;
-	entry_node->name += ".entry";
-	metas.push_back(std::move(entry_meta));
-
-	std::vector<llvm::BasicBlock *> to_process;
-	std::vector<llvm::BasicBlock *> processing;
-	to_process.push_back(entry);
-	std::vector<llvm::BasicBlock *> visit_order;
-
-	unsigned fake_label_id = 0;
-
-	// Traverse the CFG and register all blocks in the pool.
-	while (!to_process.empty())
+	auto order_itr = function_visit_order.find(func);
+	if (order_itr == function_visit_order.end())
 	{
-		std::swap(to_process, processing);
-		for (auto *block : processing)
-		{
-			visit_order.push_back(block);
-			for (auto itr = llvm::succ_begin(block); itr != llvm::succ_end(block); ++itr)
-			{
-				auto *succ = *itr;
-				if (!bb_map.count(succ))
-				{
-					to_process.push_back(succ);
-					auto succ_meta = std::make_unique<BlockMeta>(succ);
-					bb_map[succ] = succ_meta.get();
-					auto *succ_node = pool.create_node();
-					bb_map[succ]->node = succ_node;
-					succ_node->name = std::to_string(++fake_label_id);
-					metas.push_back(std::move(succ_meta));
-				}
-
-				bb_map[block]->node->add_branch(bb_map[succ]->node);
-			}
-		}
-		processing.clear();
+		LOGE("Function must be analyzed before it is converted.\n");
+		return nullptr;
 	}
 
+	auto &visit_order = order_itr->second;
+	auto *entry_node = bb_map[&func->getEntryBlock()]->node;
+
+	if (statistics)
+		statistics->num_ir_block_visits += uint32_t(visit_order.size());
+
 	for (auto *bb : visit_order)
 	{
 		CFGNode *node = bb_map[bb]->node;
 		combined_image_sampler_cache.clear();
+		physical_address_cache.clear();
+
+		if (!check_budget(pool))
+			return nullptr;
 
 		// Scan opcodes.
 		for (auto &instruction : *bb)
@@ -3229,72 +3368,506 @@ CFGNode *Converter::Impl::convert_function(llvm::Function *func, CFGNodePool &po
 	return entry_node;
 }
 
-bool Converter::Impl::analyze_instructions(const llvm::Function *function)
+bool Converter::Impl::get_typed_resource_component_type(const llvm::Value *handle,
+                                                         DXIL::ComponentType *component_type) const
+{
+	auto *call_inst = llvm::dyn_cast<llvm::CallInst>(handle);
+	uint32_t opcode;
+	if (!call_inst || !is_dxil_op_call(call_inst) || !get_dxil_opcode(call_inst, &opcode))
+		return false;
+
+	DXIL::ResourceType resource_type;
+	uint32_t resource_index;
+
+	if (static_cast<DXIL::Op>(opcode) == DXIL::Op::CreateHandle)
+	{
+		uint32_t resource_type_operand;
+		if (!get_constant_operand(call_inst, 1, &resource_type_operand) ||
+		    !get_constant_operand(call_inst, 2, &resource_index))
+		{
+			return false;
+		}
+		resource_type = static_cast<DXIL::ResourceType>(resource_type_operand);
+	}
+	else if (static_cast<DXIL::Op>(opcode) == DXIL::Op::CreateHandleForLib)
+	{
+		auto itr = llvm_global_variable_to_resource_mapping.find(call_inst->getOperand(1));
+		if (itr == llvm_global_variable_to_resource_mapping.end())
+			return false;
+		resource_type = itr->second.type;
+		resource_index = itr->second.meta_index;
+	}
+	else
+		return false;
+
+	if (resource_type != DXIL::ResourceType::SRV && resource_type != DXIL::ResourceType::UAV)
+		return false;
+
+	auto &typed_component_types =
+	    resource_type == DXIL::ResourceType::SRV ? srv_index_to_typed_component_type : uav_index_to_typed_component_type;
+
+	auto itr = typed_component_types.find(resource_index);
+	if (itr == typed_component_types.end())
+		return false;
+
+	*component_type = itr->second;
+	return true;
+}
+
+template <typename Func>
+static void for_each_instruction_operand(const llvm::Instruction &inst, const Func &func)
 {
+	// LLVMBC does not expose every operand through getOperand(), so go through the explicit accessors.
+	if (auto *phi = llvm::dyn_cast<llvm::PHINode>(&inst))
+	{
+		for (unsigned i = 0; i < phi->getNumIncomingValues(); i++)
+			func(phi->getIncomingValue(i));
+	}
+	else if (auto *ret = llvm::dyn_cast<llvm::ReturnInst>(&inst))
+	{
+		if (ret->getReturnValue())
+			func(ret->getReturnValue());
+	}
+	else if (auto *branch = llvm::dyn_cast<llvm::BranchInst>(&inst))
+	{
+		if (branch->isConditional())
+			func(branch->getCondition());
+	}
+	else if (auto *switch_inst = llvm::dyn_cast<llvm::SwitchInst>(&inst))
+		func(switch_inst->getCondition());
+	else if (auto *atomic_rmw = llvm::dyn_cast<llvm::AtomicRMWInst>(&inst))
+	{
+		func(atomic_rmw->getPointerOperand());
+		func(atomic_rmw->getValOperand());
+	}
+	else if (auto *cmpxchg = llvm::dyn_cast<llvm::AtomicCmpXchgInst>(&inst))
+	{
+		func(cmpxchg->getPointerOperand());
+		func(cmpxchg->getCompareOperand());
+		func(cmpxchg->getNewValOperand());
+	}
+	else if (auto *extract_element = llvm::dyn_cast<llvm::ExtractElementInst>(&inst))
+	{
+		func(extract_element->getVectorOperand());
+		func(extract_element->getIndexOperand());
+	}
+	else if (auto *alloca_inst = llvm::dyn_cast<llvm::AllocaInst>(&inst))
+		func(alloca_inst->getArraySize());
+	else
+	{
+		for (unsigned i = 0; i < inst.getNumOperands(); i++)
+			func(inst.getOperand(i));
+	}
+}
+
+static bool is_integer_arithmetic(const llvm::Instruction &inst)
+{
+	auto *binop = llvm::dyn_cast<llvm::BinaryOperator>(&inst);
+	if (!binop || !binop->getType()->isIntegerTy() || binop->getType()->getIntegerBitWidth() != 32)
+		return false;
+
+	switch (binop->getOpcode())
+	{
+	case llvm::BinaryOperator::BinaryOps::Add:
+	case llvm::BinaryOperator::BinaryOps::Sub:
+	case llvm::BinaryOperator::BinaryOps::Mul:
+	case llvm::BinaryOperator::BinaryOps::SDiv:
+	case llvm::BinaryOperator::BinaryOps::UDiv:
+	case llvm::BinaryOperator::BinaryOps::SRem:
+	case llvm::BinaryOperator::BinaryOps::URem:
+	case llvm::BinaryOperator::BinaryOps::Shl:
+	case llvm::BinaryOperator::BinaryOps::LShr:
+	case llvm::BinaryOperator::BinaryOps::AShr:
+	case llvm::BinaryOperator::BinaryOps::And:
+	case llvm::BinaryOperator::BinaryOps::Or:
+	case llvm::BinaryOperator::BinaryOps::Xor:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+bool Converter::Impl::analyze_integer_signedness(const llvm::Function *function)
+{
+	// Every LLVM integer is represented as uint in SPIR-V, so loads from and stores to signed typed resources
+	// need a bitcast. If the components of a signed load only flow through integer arithmetic into signed typed
+	// stores, we can keep the values in signed form and avoid the round-trip through uint.
+	// SPIR-V integer arithmetic takes operands of either signedness, so arithmetic results only need to agree
+	// with the stores they feed.
+	struct ValueState
+	{
+		bool is_signed = true;
+		std::vector<const llvm::Value *> stores;
+	};
+
+	struct StoreState
+	{
+		bool is_signed = true;
+		std::vector<const llvm::Value *> values;
+	};
+
+	// Candidate loads and arithmetic. Extracted components share the state of their load,
+	// since a load is emitted as one vector.
+	std::unordered_map<const llvm::Value *, ValueState> values;
+	std::unordered_map<const llvm::Value *, StoreState> stores;
+	std::unordered_map<const llvm::Value *, const llvm::Value *> component_to_load;
+	std::vector<const llvm::Instruction *> arithmetic;
+
+	const auto get_dxil_opcode = [](const llvm::Instruction &inst, DXIL::Op *op) -> bool {
+		auto *call_inst = llvm::dyn_cast<llvm::CallInst>(&inst);
+		uint32_t opcode;
+		if (!call_inst || !is_dxil_op_call(call_inst) || !dxil_spv::get_dxil_opcode(call_inst, &opcode))
+			return false;
+		*op = static_cast<DXIL::Op>(opcode);
+		return true;
+	};
+
+	const auto get_first_store_value_operand = [](DXIL::Op op) -> unsigned {
+		return op == DXIL::Op::BufferStore ? 4 : 5;
+	};
+
+	// Find candidate loads, their extracted components, integer arithmetic and candidate stores.
 	for (auto &bb : *function)
 	{
+		if (statistics)
+			statistics->num_ir_block_visits++;
+
 		for (auto &inst : bb)
 		{
-			if (auto *load_inst = llvm::dyn_cast<llvm::LoadInst>(&inst))
+			DXIL::Op op;
+			DXIL::ComponentType component_type;
+
+			if (get_dxil_opcode(inst, &op))
 			{
-				if (!analyze_load_instruction(*this, load_inst))
-					return false;
+				bool is_load = op == DXIL::Op::BufferLoad || op == DXIL::Op::TextureLoad;
+				bool is_store = op == DXIL::Op::BufferStore || op == DXIL::Op::TextureStore;
+				if ((is_load || is_store) &&
+				    get_typed_resource_component_type(inst.getOperand(1), &component_type) &&
+				    component_type == DXIL::ComponentType::I32)
+				{
+					if (is_load && llvm_value_is_sparse_feedback.count(&inst) == 0)
+						values[&inst] = {};
+					else if (is_store)
+						stores[&inst] = {};
+				}
 			}
-			else if (auto *getelementptr_inst = llvm::dyn_cast<llvm::GetElementPtrInst>(&inst))
+			else if (auto *extract_inst = llvm::dyn_cast<llvm::ExtractValueInst>(&inst))
 			{
-				if (!analyze_getelementptr_instruction(*this, getelementptr_inst))
-					return false;
+				if (values.count(extract_inst->getAggregateOperand()) && extract_inst->getNumIndices() == 1 &&
+				    extract_inst->getIndices()[0] < 4)
+				{
+					component_to_load[extract_inst] = extract_inst->getAggregateOperand();
+				}
 			}
-			else if (auto *extractvalue_inst = llvm::dyn_cast<llvm::ExtractValueInst>(&inst))
+			else if (is_integer_arithmetic(inst))
+				arithmetic.push_back(&inst);
+		}
+	}
+
+	if (values.empty())
+		return true;
+
+	const auto is_candidate = [&](const llvm::Value *value) -> bool {
+		return component_to_load.count(value) != 0 || values.count(value) != 0;
+	};
+
+	// Arithmetic is a candidate if it consumes a candidate. Blocks are not necessarily in dominance order,
+	// so propagate from the candidates we have through the arithmetic which uses them.
+	std::unordered_map<const llvm::Value *, std::vector<const llvm::Instruction *>> arithmetic_users;
+	for (auto *inst : arithmetic)
+	{
+		arithmetic_users[inst->getOperand(0)].push_back(inst);
+		if (inst->getOperand(1) != inst->getOperand(0))
+			arithmetic_users[inst->getOperand(1)].push_back(inst);
+	}
+
+	std::vector<const llvm::Value *> candidate_worklist;
+	candidate_worklist.reserve(values.size() + component_to_load.size());
+	for (auto &value : values)
+		candidate_worklist.push_back(value.first);
+	for (auto &component : component_to_load)
+		candidate_worklist.push_back(component.first);
+
+	while (!candidate_worklist.empty())
+	{
+		auto *value = candidate_worklist.back();
+		candidate_worklist.pop_back();
+
+		auto users_itr = arithmetic_users.find(value);
+		if (users_itr == arithmetic_users.end())
+			continue;
+
+		for (auto *inst : users_itr->second)
+		{
+			if (!values.count(inst))
 			{
-				if (!analyze_extractvalue_instruction(*this, extractvalue_inst))
-					return false;
+				values[inst] = {};
+				candidate_worklist.push_back(inst);
 			}
-			else if (auto *call_inst = llvm::dyn_cast<llvm::CallInst>(&inst))
+		}
+	}
+
+	const auto get_state_value = [&](const llvm::Value *value) -> const llvm::Value * {
+		auto component_itr = component_to_load.find(value);
+		return component_itr != component_to_load.end() ? component_itr->second : value;
+	};
+
+	std::vector<const llvm::Value *> unsigned_values;
+	const auto mark_unsigned = [&](const llvm::Value *value) {
+		value = get_state_value(value);
+		auto itr = values.find(value);
+		if (itr != values.end() && itr->second.is_signed)
+		{
+			itr->second.is_signed = false;
+			unsigned_values.push_back(value);
+		}
+	};
+
+	// Any use which is not a component extract, integer arithmetic or a value operand of a candidate store
+	// forces uint.
+	for (auto &bb : *function)
+	{
+		if (statistics)
+			statistics->num_ir_block_visits++;
+
+		for (auto &inst : bb)
+		{
+			auto store_itr = stores.find(&inst);
+			if (store_itr != stores.end())
 			{
-				auto *called_function = call_inst->getCalledFunction();
-				if (strncmp(called_function->getName().data(), "dx.op", 5) == 0)
+				DXIL::Op op;
+				get_dxil_opcode(inst, &op);
+				unsigned first_value_operand = get_first_store_value_operand(op);
+
+				for (unsigned i = 0; i < inst.getNumOperands(); i++)
 				{
-					if (!analyze_dxil_instruction(*this, call_inst))
-						return false;
+					auto *value = inst.getOperand(i);
+					if (i < first_value_operand || i >= first_value_operand + 4)
+					{
+						mark_unsigned(value);
+						continue;
+					}
+
+					if (is_candidate(value))
+					{
+						auto *state_value = get_state_value(value);
+						store_itr->second.values.push_back(state_value);
+						values[state_value].stores.push_back(&inst);
+					}
+					else if (!llvm::isa<llvm::UndefValue>(value))
+						store_itr->second.is_signed = false;
 				}
 			}
+			else if (component_to_load.count(&inst) == 0 && !is_integer_arithmetic(inst))
+				for_each_instruction_operand(inst, mark_unsigned);
 		}
 	}
+
+	// A store which cannot take signed input forces all its inputs to uint, which in turn
+	// affects every other store those values feed into.
+	for (auto &store : stores)
+		if (!store.second.is_signed)
+			for (auto *value : store.second.values)
+				mark_unsigned(value);
+
+	while (!unsigned_values.empty())
+	{
+		auto *value = unsigned_values.back();
+		unsigned_values.pop_back();
+
+		for (auto *store : values[value].stores)
+		{
+			auto &state = stores[store];
+			if (state.is_signed)
+			{
+				state.is_signed = false;
+				for (auto *store_value : state.values)
+					mark_unsigned(store_value);
+			}
+		}
+	}
+
+	for (auto &value : values)
+		if (value.second.is_signed)
+			llvm_values_signed_integer.insert(value.first);
+
+	for (auto &component : component_to_load)
+		if (values[component.second].is_signed)
+			llvm_values_signed_integer.insert(component.first);
+
+	for (auto &store : stores)
+		if (store.second.is_signed && !store.second.values.empty())
+			llvm_values_signed_integer.insert(store.first);
+
 	return true;
 }
 
-bool Converter::Impl::analyze_instructions()
+struct AnalyzeInstructionVisitor
+{
+	Converter::Impl &impl;
+
+	bool operator()(const llvm::LoadInst &inst) const
+	{
+		return analyze_load_instruction(impl, &inst);
+	}
+
+	bool operator()(const llvm::GetElementPtrInst &inst) const
+	{
+		return analyze_getelementptr_instruction(impl, &inst);
+	}
+
+	bool operator()(const llvm::ExtractValueInst &inst) const
+	{
+		return analyze_extractvalue_instruction(impl, &inst);
+	}
+
+	bool operator()(const llvm::CallInst &inst) const
+	{
+		if (is_dxil_op_call(&inst))
+			return analyze_dxil_instruction(impl, &inst);
+		return true;
+	}
+
+	bool operator()(const llvm::Value &) const
+	{
+		return true;
+	}
+};
+
+bool Converter::Impl::analyze_function(llvm::Function *func, CFGNodePool &pool)
+{
+	auto *entry = &func->getEntryBlock();
+	auto entry_meta = std::make_unique<BlockMeta>(entry);
+	bb_map[entry] = entry_meta.get();
+	auto *entry_node = pool.create_node();
+	bb_map[entry]->node = entry_node;
+	entry_node->name += ".entry";
+	metas.push_back(std::move(entry_meta));
+
+	std::vector<llvm::BasicBlock *> to_process;
+	std::vector<llvm::BasicBlock *> processing;
+	to_process.push_back(entry);
+	auto &visit_order = function_visit_order[func];
+
+	unsigned fake_label_id = 0;
+	AnalyzeInstructionVisitor visitor = { *this };
+
+	// Traverse the CFG, register all blocks in the pool and analyze each block as it is reached.
+	// Blocks are only reachable through terminators, so unreachable code is never analyzed, nor emitted.
+	while (!to_process.empty())
+	{
+		std::swap(to_process, processing);
+		for (auto *block : processing)
+		{
+			visit_order.push_back(block);
+
+			if (!check_budget(pool))
+				return false;
+
+			for (auto &inst : *block)
+				if (!dispatch_instruction(inst, visitor))
+					return false;
+
+			for (auto itr = llvm::succ_begin(block); itr != llvm::succ_end(block); ++itr)
+			{
+				auto *succ = *itr;
+				if (!bb_map.count(succ))
+				{
+					to_process.push_back(succ);
+					auto succ_meta = std::make_unique<BlockMeta>(succ);
+					bb_map[succ] = succ_meta.get();
+					auto *succ_node = pool.create_node();
+					bb_map[succ]->node = succ_node;
+					succ_node->name = std::to_string(++fake_label_id);
+					metas.push_back(std::move(succ_meta));
+				}
+
+				bb_map[block]->node->add_branch(bb_map[succ]->node);
+			}
+		}
+		processing.clear();
+	}
+
+	if (statistics)
+	{
+		statistics->num_ir_blocks += uint32_t(visit_order.size());
+		statistics->num_ir_block_visits += uint32_t(visit_order.size());
+	}
+
+	return true;
+}
+
+bool Converter::Impl::analyze_instructions(CFGNodePool &pool)
 {
 	// Some things need to happen here. We try to figure out if a UAV is readonly or writeonly.
 	// If readonly typed UAV, we emit an image format which corresponds to r32f, r32i or r32ui as to not
 	// require StorageReadWithoutFormat capability. TODO: With FL 12, this might not be enough, but should be
 	// good enough for time being.
 
-	auto *module = &bitcode_parser.get_module();
-	if (!analyze_instructions(get_entry_point_function(*module)))
+	if (!analyze_function(get_entry_point_function(entry_point_meta), pool))
 		return false;
 
 	if (execution_model == spv::ExecutionModelTessellationControl)
-		if (!analyze_instructions(execution_mode_meta.patch_constant_function))
+		if (!analyze_function(execution_mode_meta.patch_constant_function, pool))
+			return false;
+
+	// Needs sparse feedback from the walk above, and the resource mapping of global variables from
+	// emit_resources_global_mapping() to see through CreateHandleForLib.
+	if (options.integer_signedness_inference)
+	{
+		if (!analyze_integer_signedness(get_entry_point_function(entry_point_meta)))
 			return false;
 
+		if (execution_model == spv::ExecutionModelTessellationControl &&
+		    !analyze_integer_signedness(execution_mode_meta.patch_constant_function))
+			return false;
+	}
+
 	return true;
 }
 
 ConvertedFunction Converter::Impl::convert_entry_point()
 {
 	ConvertedFunction result = {};
-	result.node_pool = std::make_unique<CFGNodePool>();
+	if (node_pool)
+	{
+		result.node_pool = std::move(node_pool);
+		result.node_pool->reset();
+	}
+	else
+		result.node_pool = std::make_unique<CFGNodePool>();
 	auto &pool = *result.node_pool;
 
 	auto *module = &bitcode_parser.get_module();
-	spirv_module.emit_entry_point(get_execution_model(*module), "main", options.physical_storage_buffer);
+	entry_point_meta = get_entry_point_meta(*module, entry_point_name.empty() ? nullptr : entry_point_name.c_str());
+	if (!entry_point_meta)
+	{
+		if (entry_point_name.empty())
+			LOGE("No entry point found in module.\n");
+		else
+			LOGE("Entry point %s not found in module.\n", entry_point_name.c_str());
+		return result;
+	}
+
+	// Only prune declarations when an export is selected explicitly,
+	// so converting a library without an entry point keeps declaring every resource.
+	library_export = nullptr;
+	if (library_analysis && !entry_point_name.empty())
+	{
+		auto *name = get_entry_point_name(entry_point_meta);
+		for (auto &candidate : library_analysis->exports)
+			if (name && candidate.name == name)
+				library_export = &candidate;
+	}
+
+	spirv_module.emit_entry_point(get_execution_model(*module, entry_point_meta), "main",
+	                              options.physical_storage_buffer);
 
 	if (!emit_resources_global_mapping())
 		return result;
 
-	if (!analyze_instructions())
+	if (!analyze_instructions(pool))
 		return result;
 
 	if (!emit_execution_modes())
@@ -3310,7 +3883,7 @@ ConvertedFunction Converter::Impl::convert_entry_point()
 	if (!emit_global_variables())
 		return result;
 
-	llvm::Function *func = get_entry_point_function(*module);
+	llvm::Function *func = get_entry_point_function(entry_point_meta);
 	assert(func);
 
 	if (execution_model == spv::ExecutionModelTessellationControl)
@@ -3350,6 +3923,20 @@ void Converter::Impl::add(Operation *op)
 {
 	assert(current_block);
 	current_block->push_back(op);
+	if (budget)
+		budget->add_operation();
+}
+
+bool Converter::Impl::check_budget(const CFGNodePool &pool)
+{
+	if (budget && (!budget->check_nodes(pool.get_node_count()) ||
+	               !budget->check_arena_bytes(spirv_module.get_operation_arena_bytes())))
+	{
+		LOGE("Budget exceeded or cancelled while converting entry point.\n");
+		return false;
+	}
+	else
+		return true;
 }
 
 spv::Builder &Converter::Impl::builder()
@@ -3417,6 +4004,51 @@ void Converter::Impl::set_option(const OptionBase &cap)
 		break;
 	}
 
+	case Option::SSACleanup:
+	{
+		auto &cleanup = static_cast<const OptionSSACleanup &>(cap);
+		spirv_module.enable_ssa_cleanup(cleanup.enable);
+		break;
+	}
+
+	case Option::IntegerSignednessInference:
+	{
+		auto &inference = static_cast<const OptionIntegerSignednessInference &>(cap);
+		options.integer_signedness_inference = inference.enable;
+		break;
+	}
+
+	case Option::LoopInvariantHoisting:
+	{
+		auto &hoisting = static_cast<const OptionLoopInvariantHoisting &>(cap);
+		spirv_module.enable_loop_invariant_hoisting(hoisting.enable);
+		break;
+	}
+
+	case Option::PhysicalAddressFolding:
+	{
+		auto &folding = static_cast<const OptionPhysicalAddressFolding &>(cap);
+		options.physical_address_folding = folding.enable;
+		break;
+	}
+
+	case Option::VectorizedRootConstants:
+	{
+		auto &vectorized = static_cast<const OptionVectorizedRootConstants &>(cap);
+		options.vectorized_root_constants = vectorized.enable;
+		break;
+	}
+
+	case Option::PipelineStateSpecConstants:
+	{
+		auto &spec = static_cast<const OptionPipelineStateSpecConstants &>(cap);
+		options.output_swizzle_spec_constant = spec.output_swizzle;
+		options.output_swizzle_spec_id = spec.output_swizzle_spec_id;
+		options.root_constant_word_count_spec_constant = spec.root_constant_word_count;
+		options.root_constant_word_count_spec_id = spec.root_constant_word_count_spec_id;
+		break;
+	}
+
 	default:
 		break;
 	}
@@ -3427,9 +4059,129 @@ void Converter::set_resource_remapping_interface(ResourceRemappingInterface *ifa
 	impl->resource_mapping_iface = iface;
 }
 
-ShaderStage Converter::get_shader_stage(const LLVMBCParser &bitcode_parser)
+void Converter::set_statistics(Statistics *stats)
+{
+	impl->statistics = stats;
+}
+
+void Converter::set_budget(BudgetTracker *budget)
+{
+	impl->budget = budget;
+}
+
+void Converter::set_node_pool(std::unique_ptr<CFGNodePool> pool)
+{
+	impl->node_pool = std::move(pool);
+}
+
+ShaderStage Converter::get_shader_stage(const LLVMBCParser &bitcode_parser, const char *entry)
+{
+	auto &module = bitcode_parser.get_module();
+	return Impl::get_remapping_stage(get_execution_model(module, get_entry_point_meta(module, entry)));
+}
+
+void Converter::get_entry_points(const LLVMBCParser &bitcode_parser, std::vector<std::string> &entry_points)
+{
+	entry_points.clear();
+	auto *ep_meta = bitcode_parser.get_module().getNamedMetadata("dx.entryPoints");
+	if (!ep_meta)
+		return;
+
+	for (unsigned i = 0; i < ep_meta->getNumOperands(); i++)
+	{
+		auto *node = ep_meta->getOperand(i);
+		if (node && node->getOperand(0))
+			if (auto *name = get_entry_point_name(node))
+				entry_points.push_back(name);
+	}
+}
+
+void Converter::set_entry_point(const char *entry)
+{
+	impl->entry_point_name = entry ? entry : "";
+}
+
+static void collect_referenced_globals(const llvm::Value *value, std::unordered_set<const llvm::Value *> &globals)
+{
+	if (llvm::isa<llvm::GlobalVariable>(value))
+		globals.insert(value);
+#ifndef HAVE_LLVMBC
+	else if (auto *expr = llvm::dyn_cast<llvm::ConstantExpr>(value))
+		for (unsigned i = 0; i < expr->getNumOperands(); i++)
+			collect_referenced_globals(expr->getOperand(i), globals);
+#endif
+}
+
+static void collect_export_globals(const llvm::Function *entry, std::unordered_set<const llvm::Value *> &globals)
+{
+	std::unordered_set<const llvm::Function *> visited;
+	std::vector<const llvm::Function *> to_visit = { entry };
+	visited.insert(entry);
+
+	while (!to_visit.empty())
+	{
+		auto *func = to_visit.back();
+		to_visit.pop_back();
+
+		for (auto &bb : *func)
+		{
+			for (auto &inst : bb)
+			{
+				for (unsigned i = 0; i < inst.getNumOperands(); i++)
+					collect_referenced_globals(inst.getOperand(i), globals);
+
+				// Follow calls into other functions of the library. Declarations such as dx.op have no body.
+				if (auto *call_inst = llvm::dyn_cast<llvm::CallInst>(&inst))
+				{
+					auto *callee = call_inst->getCalledFunction();
+					if (callee && callee->begin() != callee->end() && visited.insert(callee).second)
+						to_visit.push_back(callee);
+				}
+			}
+		}
+	}
+}
+
+void Converter::analyze_library(const LLVMBCParser &bitcode_parser, LibraryAnalysis &analysis)
+{
+	analysis.exports.clear();
+	auto *ep_meta = bitcode_parser.get_module().getNamedMetadata("dx.entryPoints");
+	if (!ep_meta)
+		return;
+
+	// Only libraries have a node without function.
+	bool is_library = false;
+	for (unsigned i = 0; i < ep_meta->getNumOperands(); i++)
+	{
+		auto *node = ep_meta->getOperand(i);
+		if (node && !node->getOperand(0))
+			is_library = true;
+	}
+
+	if (!is_library)
+		return;
+
+	for (unsigned i = 0; i < ep_meta->getNumOperands(); i++)
+	{
+		auto *node = ep_meta->getOperand(i);
+		if (!node || !node->getOperand(0))
+			continue;
+
+		auto *name = get_entry_point_name(node);
+		auto *func = get_entry_point_function(node);
+		if (!name || !func)
+			continue;
+
+		LibraryAnalysis::Export library_export;
+		library_export.name = name;
+		collect_export_globals(func, library_export.globals);
+		analysis.exports.push_back(std::move(library_export));
+	}
+}
+
+void Converter::set_library_analysis(const LibraryAnalysis *analysis)
 {
-	return Impl::get_remapping_stage(get_execution_model(bitcode_parser.get_module()));
+	impl->library_analysis = analysis;
 }
 
 void Converter::scan_resources(ResourceRemappingInterface *iface, const LLVMBCParser &bitcode_parser)
@@ -3454,6 +4206,12 @@ bool Converter::recognizes_option(Option cap)
 	case Option::BindlessCBVSSBOEmulation:
 	case Option::PhysicalStorageBuffer:
 	case Option::SBTDescriptorSizeLog2:
+	case Option::SSACleanup:
+	case Option::IntegerSignednessInference:
+	case Option::LoopInvariantHoisting:
+	case Option::PhysicalAddressFolding:
+	case Option::VectorizedRootConstants:
+	case Option::PipelineStateSpecConstants:
 		return true;
 
 	default:
@@ -23,14 +23,25 @@
 #include "llvm_bitcode_parser.hpp"
 #include "node_pool.hpp"
 #include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
 
 namespace spv
 {
 class Function;
 }
 
+namespace llvm
+{
+class Value;
+}
+
 namespace dxil_spv
 {
+struct Statistics;
+class BudgetTracker;
+
 struct ConvertedFunction
 {
 	CFGNode *entry;
@@ -167,7 +178,13 @@ enum class Option : uint32_t
 	RootConstantInlineUniformBlock = 5,
 	BindlessCBVSSBOEmulation = 6,
 	PhysicalStorageBuffer = 7,
-	SBTDescriptorSizeLog2 = 8
+	SBTDescriptorSizeLog2 = 8,
+	SSACleanup = 9,
+	IntegerSignednessInference = 10,
+	LoopInvariantHoisting = 11,
+	PhysicalAddressFolding = 12,
+	VectorizedRootConstants = 13,
+	PipelineStateSpecConstants = 14
 };
 
 enum class ResourceClass : uint32_t
@@ -264,6 +281,82 @@ struct OptionSBTDescriptorSizeLog2 : OptionBase
 	unsigned size_log2_sampler = 0;
 };
 
+struct OptionSSACleanup : OptionBase
+{
+	OptionSSACleanup()
+	    : OptionBase(Option::SSACleanup)
+	{
+	}
+	bool enable = false;
+};
+
+struct OptionIntegerSignednessInference : OptionBase
+{
+	OptionIntegerSignednessInference()
+	    : OptionBase(Option::IntegerSignednessInference)
+	{
+	}
+	bool enable = false;
+};
+
+struct OptionLoopInvariantHoisting : OptionBase
+{
+	OptionLoopInvariantHoisting()
+	    : OptionBase(Option::LoopInvariantHoisting)
+	{
+	}
+	bool enable = false;
+};
+
+struct OptionPhysicalAddressFolding : OptionBase
+{
+	OptionPhysicalAddressFolding()
+	    : OptionBase(Option::PhysicalAddressFolding)
+	{
+	}
+	bool enable = false;
+};
+
+struct OptionVectorizedRootConstants : OptionBase
+{
+	OptionVectorizedRootConstants()
+	    : OptionBase(Option::VectorizedRootConstants)
+	{
+	}
+	bool enable = false;
+};
+
+// Moves pipeline state out of the conversion, so one SPIR-V module can serve many pipelines.
+struct OptionPipelineStateSpecConstants : OptionBase
+{
+	OptionPipelineStateSpecConstants()
+	    : OptionBase(Option::PipelineStateSpecConstants)
+	{
+	}
+	// Swizzle for render target i is read from spec constant output_swizzle_spec_id + i,
+	// with the same encoding as OptionOutputSwizzle.
+	bool output_swizzle = false;
+	unsigned output_swizzle_spec_id = 0;
+	// Root constant block is sized by a spec constant. The word count of the remapper is the upper bound.
+	// Ignored with the inline uniform block.
+	bool root_constant_word_count = false;
+	unsigned root_constant_word_count_spec_id = 0;
+};
+
+// Which globals each export of a library can reach through its call graph.
+// It is computed once per parsed library and is read-only afterwards,
+// so converters for different exports can share it across threads.
+// Non-library modules have no exports here.
+struct LibraryAnalysis
+{
+	struct Export
+	{
+		std::string name;
+		std::unordered_set<const llvm::Value *> globals;
+	};
+	std::vector<Export> exports;
+};
+
 class Converter
 {
 public:
@@ -271,8 +364,22 @@ public:
 	~Converter();
 	ConvertedFunction convert_entry_point();
 	void set_resource_remapping_interface(ResourceRemappingInterface *iface);
-
-	static ShaderStage get_shader_stage(const LLVMBCParser &bitcode_parser);
+	// Counts passes over the IR. Does nothing if stats is nullptr.
+	void set_statistics(Statistics *stats);
+	// Aborts conversion once budget is exceeded or cancelled. Does nothing if budget is nullptr.
+	void set_budget(BudgetTracker *budget);
+	// Reuses pool for the next convert_entry_point. It is reset and handed back in ConvertedFunction::node_pool.
+	void set_node_pool(std::unique_ptr<CFGNodePool> pool);
+
+	// For libraries, entry selects an export by name. If nullptr, the first entry point is used.
+	static ShaderStage get_shader_stage(const LLVMBCParser &bitcode_parser, const char *entry = nullptr);
+	// Names of all entry points. Libraries list every export.
+	static void get_entry_points(const LLVMBCParser &bitcode_parser, std::vector<std::string> &entry_points);
+	void set_entry_point(const char *entry);
+	static void analyze_library(const LLVMBCParser &bitcode_parser, LibraryAnalysis &analysis);
+	// Exports selected with set_entry_point only declare the resources and global variables they reference.
+	// Does nothing if analysis is nullptr.
+	void set_library_analysis(const LibraryAnalysis *analysis);
 	static void scan_resources(ResourceRemappingInterface *iface, const LLVMBCParser &bitcode_parser);
 
 	void add_option(const OptionBase &cap);
@@ -27,7 +27,7 @@ using namespace dxil_spv;
 
 static void print_help()
 {
-	LOGE("dxil-extract <DXIL blob> [--output file.bc]\n");
+	LOGE("dxil-extract <DXIL blob> [--output file.bc] [--list-parts] [--print-psv] [--print-root-signature]\n");
 }
 
 static std::vector<uint8_t> read_file(const char *path)
@@ -67,9 +67,126 @@ static bool write_file(const char *path, const void *data, size_t size)
 	return ret;
 }
 
+static bool print_parts(const std::vector<uint8_t> &container)
+{
+	unsigned count = 0;
+	if (dxil_spv_index_dxil_container(container.data(), container.size(), nullptr, &count) != DXIL_SPV_SUCCESS)
+	{
+		LOGE("Failed to index container.\n");
+		return false;
+	}
+
+	std::vector<dxil_spv_container_part> parts(count);
+	if (dxil_spv_index_dxil_container(container.data(), container.size(), parts.data(), &count) != DXIL_SPV_SUCCESS)
+		return false;
+
+	for (auto &part : parts)
+	{
+		printf("%c%c%c%c: offset %u, size %u\n", char(part.fourcc), char(part.fourcc >> 8), char(part.fourcc >> 16),
+		       char(part.fourcc >> 24), part.offset, part.size);
+	}
+
+	return true;
+}
+
+static bool print_psv(const std::vector<uint8_t> &container)
+{
+	dxil_spv_shader_stage stage;
+	if (dxil_spv_psv_get_shader_stage(container.data(), container.size(), &stage) != DXIL_SPV_SUCCESS)
+	{
+		LOGE("Failed to get shader stage from PSV0.\n");
+		return false;
+	}
+	printf("stage: %u\n", unsigned(stage));
+
+	unsigned count = 0;
+	if (dxil_spv_psv_get_resource_bindings(container.data(), container.size(), nullptr, &count) != DXIL_SPV_SUCCESS)
+		return false;
+	std::vector<dxil_spv_psv_resource_binding> bindings(count);
+	if (dxil_spv_psv_get_resource_bindings(container.data(), container.size(), bindings.data(), &count) !=
+	    DXIL_SPV_SUCCESS)
+	{
+		return false;
+	}
+
+	for (auto &binding : bindings)
+	{
+		printf("resource: class %u, kind %u, space %u, register %u, range %u%s\n", unsigned(binding.resource_class),
+		       unsigned(binding.kind), binding.register_space, binding.register_index, binding.range_size,
+		       binding.has_counter ? ", counter" : "");
+	}
+
+	static const char *signature_names[] = { "input", "output", "patch constant" };
+	for (unsigned i = 0; i < 3; i++)
+	{
+		auto signature = static_cast<dxil_spv_psv_signature>(i);
+		if (dxil_spv_psv_get_signature_elements(container.data(), container.size(), signature, nullptr, &count) !=
+		    DXIL_SPV_SUCCESS)
+		{
+			return false;
+		}
+
+		std::vector<dxil_spv_psv_signature_element> elements(count);
+		if (dxil_spv_psv_get_signature_elements(container.data(), container.size(), signature, elements.data(),
+		                                        &count) != DXIL_SPV_SUCCESS)
+		{
+			return false;
+		}
+
+		for (auto &element : elements)
+		{
+			printf("%s: %s%u, row %u (%u rows), col %u (%u cols), system value %u, component type %u\n",
+			       signature_names[i], element.semantic, element.semantic_index, element.start_row, element.rows,
+			       element.start_col, element.cols, element.system_value_semantic, element.component_type);
+		}
+	}
+
+	return true;
+}
+
+static bool print_root_signature(const std::vector<uint8_t> &container)
+{
+	dxil_spv_root_signature root_signature;
+	if (dxil_spv_parse_root_signature(container.data(), container.size(), &root_signature) != DXIL_SPV_SUCCESS)
+	{
+		LOGE("Failed to parse root signature.\n");
+		return false;
+	}
+
+	unsigned count = 0;
+	std::vector<dxil_spv_root_signature_binding> bindings;
+	bool ret = dxil_spv_root_signature_get_bindings(root_signature, nullptr, &count) == DXIL_SPV_SUCCESS;
+	if (ret)
+	{
+		bindings.resize(count);
+		ret = dxil_spv_root_signature_get_bindings(root_signature, bindings.data(), &count) == DXIL_SPV_SUCCESS;
+	}
+
+	if (ret)
+	{
+		printf("root constant words: %u\n",
+		       dxil_spv_root_signature_get_root_constant_word_count(root_signature));
+
+		static const char *type_names[] = { "table", "root constants", "root descriptor", "static sampler" };
+		for (auto &binding : bindings)
+		{
+			printf("%s: class %u, visibility %u, space %u, register %u, count %u, parameter %u, word %u, offset %u\n",
+			       type_names[binding.type], unsigned(binding.resource_class), binding.visibility,
+			       binding.register_space, binding.register_index, binding.num_descriptors, binding.parameter_index,
+			       binding.root_constant_word, binding.offset_in_table);
+		}
+	}
+
+	dxil_spv_root_signature_free(root_signature);
+	return ret;
+}
+
 int main(int argc, char **argv)
 {
 	std::string input, output;
+	bool list_parts = false;
+	bool print_psv_info = false;
+	bool print_root_signature_info = false;
 
 	CLICallbacks cbs;
 	cbs.add("--help", [](CLIParser &parser) {
@@ -77,6 +194,9 @@ int main(int argc, char **argv)
 		parser.end();
 	});
 	cbs.add("--output", [&](CLIParser &parser) { output = parser.next_string(); });
+	cbs.add("--list-parts", [&](CLIParser &) { list_parts = true; });
+	cbs.add("--print-psv", [&](CLIParser &) { print_psv_info = true; });
+	cbs.add("--print-root-signature", [&](CLIParser &) { print_root_signature_info = true; });
 	cbs.default_handler = [&](const char *arg) { input = arg; };
 	CLIParser parser(std::move(cbs), argc - 1, argv + 1);
 
@@ -98,32 +218,40 @@ int main(int argc, char **argv)
 		return EXIT_FAILURE;
 	}
 
-	dxil_spv_parsed_blob blob;
-	if (dxil_spv_parse_dxil_blob(input_file.data(), input_file.size(), &blob) != DXIL_SPV_SUCCESS)
-	{
-		LOGE("Failed to parse blob.\n");
-		return EXIT_FAILURE;
-	}
+	if (list_parts)
+		return print_parts(input_file) ? EXIT_SUCCESS : EXIT_FAILURE;
+	if (print_psv_info)
+		return print_psv(input_file) ? EXIT_SUCCESS : EXIT_FAILURE;
+	if (print_root_signature_info)
+		return print_root_signature(input_file) ? EXIT_SUCCESS : EXIT_FAILURE;
 
-	const void *ir_data;
-	size_t ir_size;
-	if (dxil_spv_parsed_blob_get_raw_ir(blob, &ir_data, &ir_size) != DXIL_SPV_SUCCESS)
+	// Extracting the bitcode only needs the container index, not a full parse.
+	if (!output.empty())
 	{
-		LOGE("Failed to extract raw IR.\n");
-		return EXIT_FAILURE;
-	}
+		const void *ir_data;
+		size_t ir_size;
+		if (dxil_spv_find_dxil_bitcode(input_file.data(), input_file.size(), &ir_data, &ir_size) != DXIL_SPV_SUCCESS)
+		{
+			LOGE("Failed to find DXIL in container.\n");
+			return EXIT_FAILURE;
+		}
 
-	if (output.empty())
-	{
-		dxil_spv_parsed_blob_dump_llvm_ir(blob);
-		dxil_spv_parsed_blob_free(blob);
+		if (!write_file(output.c_str(), ir_data, ir_size))
+		{
+			LOGE("Failed to write IR to %s.\n", output.c_str());
+			return EXIT_FAILURE;
+		}
 		return EXIT_SUCCESS;
 	}
 
-	if (!write_file(output.c_str(), ir_data, ir_size))
+	dxil_spv_parsed_blob blob;
+	if (dxil_spv_parse_dxil_blob(input_file.data(), input_file.size(), &blob) != DXIL_SPV_SUCCESS)
 	{
-		LOGE("Failed to write IR to %s.\n", output.c_str());
+		LOGE("Failed to parse blob.\n");
 		return EXIT_FAILURE;
 	}
+
+	dxil_spv_parsed_blob_dump_llvm_ir(blob);
 	dxil_spv_parsed_blob_free(blob);
+	return EXIT_SUCCESS;
 }
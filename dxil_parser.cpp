@@ -19,18 +19,101 @@
 #include "dxil_parser.hpp"
 #include "dxil.hpp"
 #include "memory_stream.hpp"
+#include <algorithm>
 #include <stdio.h>
+#include <string.h>
 #include <vector>
 
 namespace dxil_spv
 {
-std::vector<uint8_t> &DXILContainerParser::get_blob()
+bool DXILContainerIndex::index_container(const void *data, size_t size)
 {
-	return dxil_blob;
+	container = nullptr;
+	part_offsets = nullptr;
+	part_count = 0;
+
+	MemoryStream stream(data, size);
+
+	DXIL::ContainerHeader container_header;
+	if (!stream.read(container_header))
+		return false;
+
+	if (static_cast<DXIL::FourCC>(container_header.header_fourcc) != DXIL::FourCC::Container)
+		return false;
+	if (container_header.container_size_in_bytes > size)
+		return false;
+
+	// Part offsets directly follow the container header.
+	size_t part_offsets_offset = stream.get_offset();
+	if (container_header.part_count > (size - part_offsets_offset) / sizeof(uint32_t))
+		return false;
+
+	// Validate every part here, so they can be decoded later without bounds checking.
+	for (uint32_t i = 0; i < container_header.part_count; i++)
+	{
+		uint32_t part_offset;
+		if (!stream.seek(part_offsets_offset + i * sizeof(uint32_t)) || !stream.read(part_offset))
+			return false;
+
+		DXIL::PartHeader part_header;
+		if (!stream.seek(part_offset) || !stream.read(part_header))
+			return false;
+
+		size_t payload_offset = stream.get_offset();
+		if (part_header.part_size > size - payload_offset)
+			return false;
+	}
+
+	container = static_cast<const uint8_t *>(data);
+	part_offsets = container + part_offsets_offset;
+	part_count = container_header.part_count;
+	return true;
+}
+
+unsigned DXILContainerIndex::get_part_count() const
+{
+	return part_count;
+}
+
+DXILContainerPart DXILContainerIndex::get_part(unsigned index) const
+{
+	uint32_t part_offset;
+	memcpy(&part_offset, part_offsets + index * sizeof(uint32_t), sizeof(part_offset));
+
+	DXIL::PartHeader part_header;
+	memcpy(&part_header, container + part_offset, sizeof(part_header));
+
+	DXILContainerPart part;
+	part.fourcc = static_cast<DXIL::FourCC>(part_header.part_fourcc);
+	part.offset = uint32_t(part_offset + sizeof(part_header));
+	part.size = part_header.part_size;
+	return part;
+}
+
+bool DXILContainerIndex::find_part(DXIL::FourCC fourcc, DXILContainerPart &part) const
+{
+	for (unsigned i = 0; i < part_count; i++)
+	{
+		part = get_part(i);
+		if (part.fourcc == fourcc)
+			return true;
+	}
+	return false;
+}
+
+const uint8_t *DXILContainerIndex::get_part_data(const DXILContainerPart &part) const
+{
+	return container + part.offset;
 }
 
-bool DXILContainerParser::parse_dxil(MemoryStream &stream)
+bool DXILContainerIndex::find_dxil_bitcode(const uint8_t **bitcode, size_t *bitcode_size) const
 {
+	DXILContainerPart part;
+	if (!find_part(DXIL::FourCC::DXIL, part))
+		return false;
+
+	MemoryStream stream(get_part_data(part), part.size);
+
 	DXIL::ProgramHeader program_header;
 	if (!stream.read(program_header))
 		return false;
@@ -38,146 +121,518 @@ bool DXILContainerParser::parse_dxil(MemoryStream &stream)
 	if (static_cast<DXIL::FourCC>(program_header.dxil_magic) != DXIL::FourCC::DXIL)
 		return false;
 
+	// The bitcode offset is relative to the DXIL magic.
 	if (program_header.bitcode_offset < 16)
 		return false;
 
-	auto substream = stream.create_substream(stream.get_offset() + program_header.bitcode_offset - 16);
-
-	dxil_blob.resize(substream.get_size());
-	if (!substream.read(dxil_blob.data(), substream.get_size()))
+	size_t offset = stream.get_offset() + program_header.bitcode_offset - 16;
+	if (offset > part.size)
 		return false;
 
+	*bitcode = get_part_data(part) + offset;
+	*bitcode_size = part.size - offset;
 	return true;
 }
 
-bool DXILContainerParser::parse_iosg1(MemoryStream &stream, std::vector<DXIL::IOElement> &elements)
+bool DXILPSVParser::parse(const DXILContainerIndex &index)
 {
-	uint32_t element_count;
-	if (!stream.read(element_count))
+	DXILContainerPart part;
+	if (!index.find_part(DXIL::FourCC::PipelineStateValidation, part))
 		return false;
 
-	if (!stream.skip(sizeof(uint32_t)))
+	data = index.get_part_data(part);
+	size = part.size;
+	MemoryStream stream(data, size);
+
+	uint32_t runtime_info_size;
+	if (!stream.read(runtime_info_size))
 		return false;
 
-	elements.resize(element_count);
-	for (uint32_t i = 0; i < element_count; i++)
-	{
-		if (!stream.read(elements[i].stream_index))
-			return false;
+	if (runtime_info_size < sizeof(DXIL::PSVRuntimeInfo0))
+		return false;
 
-		uint32_t string_offset;
-		if (!stream.read(string_offset))
-			return false;
+	has_runtime_info1 = runtime_info_size >= sizeof(DXIL::PSVRuntimeInfo1);
+	runtime_info = {};
+	if (!stream.read(&runtime_info, std::min<size_t>(runtime_info_size, sizeof(runtime_info))))
+		return false;
+	if (!stream.seek(sizeof(uint32_t) + runtime_info_size))
+		return false;
 
-		if (!stream.read(elements[i].semantic_index))
-			return false;
-		if (!stream.read(elements[i].system_value_semantic))
-			return false;
-		if (!stream.read(elements[i].component_type))
-			return false;
-		if (!stream.read(elements[i].register_index))
-			return false;
-		if (!stream.read(elements[i].mask))
-			return false;
-		if (!stream.read(elements[i].min_precision))
-			return false;
+	if (!stream.read(resource_count))
+		return false;
 
-		size_t offset = stream.get_offset();
-		if (!stream.seek(string_offset))
+	if (resource_count)
+	{
+		if (!stream.read(resource_stride) || resource_stride < sizeof(DXIL::PSVResourceBindInfo0))
 			return false;
-		if (!stream.read_string(elements[i].semantic_name))
+		resources_offset = uint32_t(stream.get_offset());
+		if (!stream.skip(size_t(resource_count) * resource_stride))
 			return false;
-		if (!stream.seek(offset))
+	}
+
+	for (auto &count : signature_counts)
+		count = 0;
+
+	// Everything past the resources was added along with version 1 runtime info.
+	if (!has_runtime_info1)
+		return true;
+
+	if (!stream.read(string_table_size))
+		return false;
+	string_table_offset = uint32_t(stream.get_offset());
+	if (!stream.skip(string_table_size))
+		return false;
+
+	if (!stream.read(semantic_index_count))
+		return false;
+	semantic_index_table_offset = uint32_t(stream.get_offset());
+	if (!stream.skip(size_t(semantic_index_count) * sizeof(uint32_t)))
+		return false;
+
+	signature_counts[unsigned(DXIL::PSVSignature::Input)] = runtime_info.sig_input_elements;
+	signature_counts[unsigned(DXIL::PSVSignature::Output)] = runtime_info.sig_output_elements;
+	signature_counts[unsigned(DXIL::PSVSignature::PatchConstantOrPrimitive)] =
+	    runtime_info.sig_patch_constant_or_primitive_elements;
+
+	uint32_t total_elements = 0;
+	for (auto &count : signature_counts)
+		total_elements += count;
+
+	if (total_elements)
+	{
+		if (!stream.read(signature_element_stride) || signature_element_stride < sizeof(DXIL::PSVSignatureElement0))
 			return false;
+
+		for (unsigned i = 0; i < unsigned(DXIL::PSVSignature::Count); i++)
+		{
+			signature_offsets[i] = uint32_t(stream.get_offset());
+			if (!stream.skip(size_t(signature_counts[i]) * signature_element_stride))
+				return false;
+		}
 	}
 
 	return true;
 }
 
-bool DXILContainerParser::parse_container(const void *data, size_t size)
+DXIL::ShaderKind DXILPSVParser::get_shader_kind() const
 {
+	if (!has_runtime_info1)
+		return DXIL::ShaderKind::Invalid;
+
+	switch (static_cast<DXIL::PSVShaderKind>(runtime_info.shader_stage))
+	{
+	case DXIL::PSVShaderKind::Pixel:
+		return DXIL::ShaderKind::Pixel;
+	case DXIL::PSVShaderKind::Vertex:
+		return DXIL::ShaderKind::Vertex;
+	case DXIL::PSVShaderKind::Geometry:
+		return DXIL::ShaderKind::Geometry;
+	case DXIL::PSVShaderKind::Hull:
+		return DXIL::ShaderKind::Hull;
+	case DXIL::PSVShaderKind::Domain:
+		return DXIL::ShaderKind::Domain;
+	case DXIL::PSVShaderKind::Compute:
+		return DXIL::ShaderKind::Compute;
+	case DXIL::PSVShaderKind::Library:
+		return DXIL::ShaderKind::Library;
+	case DXIL::PSVShaderKind::Mesh:
+		return DXIL::ShaderKind::Mesh;
+	case DXIL::PSVShaderKind::Amplification:
+		return DXIL::ShaderKind::Amplification;
+	default:
+		return DXIL::ShaderKind::Invalid;
+	}
+}
+
+unsigned DXILPSVParser::get_resource_count() const
+{
+	return resource_count;
+}
+
+bool DXILPSVParser::get_resource(unsigned index, DXIL::PSVResourceBindInfo1 &info) const
+{
+	if (index >= resource_count)
+		return false;
+
+	info = {};
+	memcpy(&info, data + resources_offset + index * resource_stride, std::min<size_t>(resource_stride, sizeof(info)));
+	return true;
+}
+
+unsigned DXILPSVParser::get_signature_element_count(DXIL::PSVSignature signature) const
+{
+	return signature_counts[unsigned(signature)];
+}
+
+bool DXILPSVParser::get_signature_element(DXIL::PSVSignature signature, unsigned index,
+                                          DXIL::PSVSignatureElement0 &element, const char **semantic_name,
+                                          uint32_t *semantic_index) const
+{
+	if (index >= signature_counts[unsigned(signature)])
+		return false;
+
+	memcpy(&element, data + signature_offsets[unsigned(signature)] + index * signature_element_stride,
+	       sizeof(element));
+
+	// Names are NUL-terminated within the string table, don't trust that for truncated containers.
+	auto *strings = reinterpret_cast<const char *>(data + string_table_offset);
+	if (element.semantic_name_offset >= string_table_size ||
+	    !memchr(strings + element.semantic_name_offset, '\0', string_table_size - element.semantic_name_offset))
+	{
+		return false;
+	}
+	*semantic_name = strings + element.semantic_name_offset;
+
+	// Each row has its own semantic index, the first one is the base index.
+	if (element.rows && element.semantic_indices_offset < semantic_index_count)
+		memcpy(semantic_index, data + semantic_index_table_offset + element.semantic_indices_offset * sizeof(uint32_t),
+		       sizeof(uint32_t));
+	else
+		*semantic_index = 0;
+
+	return true;
+}
+
+bool DXILRootSignatureParser::parse(const DXILContainerIndex &index)
+{
+	DXILContainerPart part;
+	if (!index.find_part(DXIL::FourCC::RootSignature, part))
+		return false;
+	return parse(index.get_part_data(part), part.size);
+}
+
+bool DXILRootSignatureParser::parse(const void *data, size_t size)
+{
+	bindings.clear();
+	root_constant_word_count = 0;
+
 	MemoryStream stream(data, size);
+	DXIL::RootSignatureDesc desc;
+	if (!stream.read(desc))
+		return false;
 
-	DXIL::ContainerHeader container_header;
-	if (!stream.read(container_header))
+	if (desc.version != DXIL::RootSignatureVersion::Version1_0 &&
+	    desc.version != DXIL::RootSignatureVersion::Version1_1)
 		return false;
 
-	if (static_cast<DXIL::FourCC>(container_header.header_fourcc) != DXIL::FourCC::Container)
+	version = desc.version;
+	flags = desc.flags;
+
+	if (!parse_root_parameters(stream, desc))
 		return false;
-	if (container_header.container_size_in_bytes > size)
+	if (!parse_static_samplers(stream, desc))
 		return false;
 
-	std::vector<uint32_t> parts(container_header.part_count);
-	for (uint32_t i = 0; i < container_header.part_count; i++)
+	std::stable_sort(bindings.begin(), bindings.end(), [](const RootSignatureBinding &a, const RootSignatureBinding &b) {
+		if (a.resource_type != b.resource_type)
+			return a.resource_type < b.resource_type;
+		else if (a.register_space != b.register_space)
+			return a.register_space < b.register_space;
+		else
+			return a.base_register < b.base_register;
+	});
+
+	unsigned binding_index = 0;
+	for (unsigned type = 0; type < 4; type++)
 	{
-		if (!stream.read(parts[i]))
-			return false;
+		type_offsets[type] = binding_index;
+		while (binding_index < bindings.size() && unsigned(bindings[binding_index].resource_type) == type)
+			binding_index++;
 	}
+	type_offsets[4] = binding_index;
 
-	for (auto &part_offset : parts)
+	return true;
+}
+
+bool DXILRootSignatureParser::parse_descriptor_table(MemoryStream &stream, const DXIL::RootParameter &parameter,
+                                                     uint32_t parameter_index, uint32_t root_constant_word)
+{
+	DXIL::RootDescriptorTable table;
+	if (!stream.seek(parameter.payload_offset) || !stream.read(table))
+		return false;
+
+	if (!stream.seek(table.ranges_offset))
+		return false;
+
+	uint64_t next_offset = 0;
+	for (uint32_t i = 0; i < table.num_ranges; i++)
 	{
-		if (!stream.seek(part_offset))
+		DXIL::DescriptorRange1 range = {};
+		if (version == DXIL::RootSignatureVersion::Version1_0)
+		{
+			DXIL::DescriptorRange0 range0;
+			if (!stream.read(range0))
+				return false;
+			range.range_type = range0.range_type;
+			range.num_descriptors = range0.num_descriptors;
+			range.base_register = range0.base_register;
+			range.register_space = range0.register_space;
+			range.offset_in_table = range0.offset_in_table;
+		}
+		else if (!stream.read(range))
 			return false;
 
-		DXIL::PartHeader part_header;
-		if (!stream.read(part_header))
+		if (unsigned(range.range_type) > unsigned(DXIL::DescriptorRangeType::Sampler))
 			return false;
 
-		switch (static_cast<DXIL::FourCC>(part_header.part_fourcc))
+		uint64_t offset = range.offset_in_table;
+		if (range.offset_in_table == DXIL::DescriptorRangeOffsetAppend)
 		{
-		case DXIL::FourCC::DXIL:
-		{
-			auto substream = stream.create_substream(stream.get_offset(), part_header.part_size);
-			if (!parse_dxil(substream))
+			// Cannot append to an unbounded range.
+			if (next_offset > UINT32_MAX)
 				return false;
-			break;
+			offset = next_offset;
 		}
 
-		case DXIL::FourCC::FeatureInfo:
+		if (range.num_descriptors == DXIL::UnboundedDescriptorCount)
+			next_offset = uint64_t(UINT32_MAX) + 1;
+		else
+			next_offset = offset + range.num_descriptors;
+
+		RootSignatureBinding binding = {};
+		binding.type = RootSignatureBindingType::DescriptorTable;
+		binding.resource_type = static_cast<DXIL::ResourceType>(range.range_type);
+		binding.visibility = parameter.visibility;
+		binding.register_space = range.register_space;
+		binding.base_register = range.base_register;
+		binding.num_descriptors = range.num_descriptors;
+		binding.parameter_index = parameter_index;
+		binding.root_constant_word = root_constant_word;
+		binding.offset_in_table = uint32_t(offset);
+		bindings.push_back(binding);
+	}
+
+	return true;
+}
+
+bool DXILRootSignatureParser::parse_root_parameters(MemoryStream &stream, const DXIL::RootSignatureDesc &desc)
+{
+	for (uint32_t i = 0; i < desc.num_parameters; i++)
+	{
+		DXIL::RootParameter parameter;
+		if (!stream.seek(desc.parameters_offset + size_t(i) * sizeof(parameter)) || !stream.read(parameter))
+			return false;
+
+		if (unsigned(parameter.visibility) > unsigned(DXIL::ShaderVisibility::Mesh))
+			return false;
+
+		RootSignatureBinding binding = {};
+		binding.visibility = parameter.visibility;
+		binding.parameter_index = i;
+		binding.num_descriptors = 1;
+
+		switch (parameter.parameter_type)
+		{
+		case DXIL::RootParameterType::DescriptorTable:
+			if (!parse_descriptor_table(stream, parameter, i, root_constant_word_count))
+				return false;
+			root_constant_word_count++;
 			break;
 
-		case DXIL::FourCC::InputSignature:
+		case DXIL::RootParameterType::Constants32Bit:
 		{
-			auto substream = stream.create_substream(stream.get_offset(), part_header.part_size);
-			if (!parse_iosg1(substream, input_elements))
+			DXIL::RootConstants constants;
+			if (!stream.seek(parameter.payload_offset) || !stream.read(constants))
 				return false;
+			binding.type = RootSignatureBindingType::RootConstants;
+			binding.resource_type = DXIL::ResourceType::CBV;
+			binding.register_space = constants.register_space;
+			binding.base_register = constants.register_index;
+			binding.root_constant_word = root_constant_word_count;
+			root_constant_word_count += constants.num_32bit_values;
+			bindings.push_back(binding);
 			break;
 		}
 
-		case DXIL::FourCC::OutputSignature:
+		case DXIL::RootParameterType::CBV:
+		case DXIL::RootParameterType::SRV:
+		case DXIL::RootParameterType::UAV:
 		{
-			auto substream = stream.create_substream(stream.get_offset(), part_header.part_size);
-			if (!parse_iosg1(substream, output_elements))
+			// Version 1.1 only appends flags, which do not affect the binding.
+			DXIL::RootDescriptor0 descriptor;
+			if (!stream.seek(parameter.payload_offset) || !stream.read(descriptor))
 				return false;
+			binding.type = RootSignatureBindingType::RootDescriptor;
+			if (parameter.parameter_type == DXIL::RootParameterType::CBV)
+				binding.resource_type = DXIL::ResourceType::CBV;
+			else if (parameter.parameter_type == DXIL::RootParameterType::SRV)
+				binding.resource_type = DXIL::ResourceType::SRV;
+			else
+				binding.resource_type = DXIL::ResourceType::UAV;
+			binding.register_space = descriptor.register_space;
+			binding.base_register = descriptor.register_index;
+			bindings.push_back(binding);
 			break;
 		}
 
-		case DXIL::FourCC::PatchConstantSignature:
-			break;
+		default:
+			return false;
+		}
+	}
 
-		case DXIL::FourCC::PrivateData:
-			break;
+	return true;
+}
 
-		case DXIL::FourCC::RootSignature:
-			break;
+bool DXILRootSignatureParser::parse_static_samplers(MemoryStream &stream, const DXIL::RootSignatureDesc &desc)
+{
+	for (uint32_t i = 0; i < desc.num_static_samplers; i++)
+	{
+		DXIL::StaticSampler sampler;
+		if (!stream.seek(desc.static_samplers_offset + size_t(i) * sizeof(sampler)) || !stream.read(sampler))
+			return false;
 
-		case DXIL::FourCC::PipelineStateValidation:
-			break;
+		if (unsigned(sampler.visibility) > unsigned(DXIL::ShaderVisibility::Mesh))
+			return false;
 
-		case DXIL::FourCC::ResourceDef:
-			break;
+		RootSignatureBinding binding = {};
+		binding.type = RootSignatureBindingType::StaticSampler;
+		binding.resource_type = DXIL::ResourceType::Sampler;
+		binding.visibility = sampler.visibility;
+		binding.register_space = sampler.register_space;
+		binding.base_register = sampler.register_index;
+		binding.num_descriptors = 1;
+		binding.parameter_index = i;
+		bindings.push_back(binding);
+	}
 
-		case DXIL::FourCC::ShaderStatistics:
-			break;
+	return true;
+}
 
-		case DXIL::FourCC::ShaderHash:
-			break;
+DXIL::RootSignatureVersion DXILRootSignatureParser::get_version() const
+{
+	return version;
+}
 
-		default:
+uint32_t DXILRootSignatureParser::get_flags() const
+{
+	return flags;
+}
+
+unsigned DXILRootSignatureParser::get_root_constant_word_count() const
+{
+	return root_constant_word_count;
+}
+
+const std::vector<RootSignatureBinding> &DXILRootSignatureParser::get_bindings() const
+{
+	return bindings;
+}
+
+const RootSignatureBinding *DXILRootSignatureParser::find_binding(DXIL::ResourceType type,
+                                                                  DXIL::ShaderVisibility visibility,
+                                                                  uint32_t register_space, uint32_t register_index,
+                                                                  uint32_t range_size) const
+{
+	if (unsigned(type) >= 4)
+		return nullptr;
+
+	auto *begin = bindings.data() + type_offsets[unsigned(type)];
+	auto *end = bindings.data() + type_offsets[unsigned(type) + 1];
+
+	// Find the first binding which starts after the register, then walk back through the space,
+	// since an earlier (possibly unbounded) range may still cover it.
+	auto *itr = std::upper_bound(begin, end, std::make_pair(register_space, register_index),
+	                             [](const std::pair<uint32_t, uint32_t> &key, const RootSignatureBinding &binding) {
+		                             if (key.first != binding.register_space)
+			                             return key.first < binding.register_space;
+		                             else
+			                             return key.second < binding.base_register;
+	                             });
+
+	// Unsized resource arrays can only be covered by unbounded ranges.
+	uint64_t range_end = range_size == ~0u ? UINT64_MAX : uint64_t(register_index) + range_size;
+
+	while (itr != begin)
+	{
+		--itr;
+		if (itr->register_space != register_space)
 			break;
-		}
+
+		if (itr->visibility != DXIL::ShaderVisibility::All && itr->visibility != visibility)
+			continue;
+
+		uint64_t binding_end = itr->num_descriptors == DXIL::UnboundedDescriptorCount ?
+		                           UINT64_MAX :
+		                           uint64_t(itr->base_register) + itr->num_descriptors;
+		if (range_end <= binding_end)
+			return itr;
 	}
 
+	return nullptr;
+}
+
+std::vector<uint8_t> &DXILContainerParser::get_blob()
+{
+	return dxil_blob;
+}
+
+bool DXILContainerParser::parse_iosg1(MemoryStream &stream, std::vector<DXIL::IOElement> &elements)
+{
+	uint32_t element_count;
+	if (!stream.read(element_count))
+		return false;
+
+	if (!stream.skip(sizeof(uint32_t)))
+		return false;
+
+	elements.resize(element_count);
+	for (uint32_t i = 0; i < element_count; i++)
+	{
+		if (!stream.read(elements[i].stream_index))
+			return false;
+
+		uint32_t string_offset;
+		if (!stream.read(string_offset))
+			return false;
+
+		if (!stream.read(elements[i].semantic_index))
+			return false;
+		if (!stream.read(elements[i].system_value_semantic))
+			return false;
+		if (!stream.read(elements[i].component_type))
+			return false;
+		if (!stream.read(elements[i].register_index))
+			return false;
+		if (!stream.read(elements[i].mask))
+			return false;
+		if (!stream.read(elements[i].min_precision))
+			return false;
+
+		size_t offset = stream.get_offset();
+		if (!stream.seek(string_offset))
+			return false;
+		if (!stream.read_string(elements[i].semantic_name))
+			return false;
+		if (!stream.seek(offset))
+			return false;
+	}
+
+	return true;
+}
+
+bool DXILContainerParser::parse_signature(const DXILContainerIndex &index, DXIL::FourCC fourcc,
+                                          std::vector<DXIL::IOElement> &elements)
+{
+	DXILContainerPart part;
+	if (!index.find_part(fourcc, part))
+		return false;
+
+	MemoryStream stream(index.get_part_data(part), part.size);
+	return parse_iosg1(stream, elements);
+}
+
+bool DXILContainerParser::parse_container(const void *data, size_t size)
+{
+	DXILContainerIndex index;
+	if (!index.index_container(data, size))
+		return false;
+
+	const uint8_t *bitcode;
+	size_t bitcode_size;
+	if (!index.find_dxil_bitcode(&bitcode, &bitcode_size))
+		return false;
+
+	dxil_blob.assign(bitcode, bitcode + bitcode_size);
 	return true;
 }
-} // namespace dxil_spv
\ No newline at end of file
+} // namespace dxil_spv
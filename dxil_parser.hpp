@@ -27,18 +27,150 @@ namespace dxil_spv
 {
 class MemoryStream;
 
+struct DXILContainerPart
+{
+	DXIL::FourCC fourcc;
+	// Offset of the part payload, past the part header, from the start of the container.
+	uint32_t offset;
+	uint32_t size;
+};
+
+// Locates the parts of a container in place. Nothing is copied or decoded, so indexing never allocates.
+// The index points into the container memory, which must outlive it.
+// Parts are validated up front and decoded from the part offset table on demand, so any part count is supported.
+class DXILContainerIndex
+{
+public:
+	bool index_container(const void *data, size_t size);
+
+	unsigned get_part_count() const;
+	DXILContainerPart get_part(unsigned index) const;
+	bool find_part(DXIL::FourCC fourcc, DXILContainerPart &part) const;
+	const uint8_t *get_part_data(const DXILContainerPart &part) const;
+
+	// Locates the LLVM bitcode within the DXIL part.
+	bool find_dxil_bitcode(const uint8_t **bitcode, size_t *bitcode_size) const;
+
+private:
+	const uint8_t *container = nullptr;
+	// Offsets of the part headers, directly following the container header.
+	const uint8_t *part_offsets = nullptr;
+	unsigned part_count = 0;
+};
+
+// Decodes the pipeline state validation (PSV0) part in place, which describes the shader stage, resource bindings
+// and I/O signatures without having to parse the bitcode. Like the index, this never allocates.
+class DXILPSVParser
+{
+public:
+	bool parse(const DXILContainerIndex &index);
+
+	// Containers with version 0 runtime info do not record the stage, which yields ShaderKind::Invalid.
+	DXIL::ShaderKind get_shader_kind() const;
+
+	unsigned get_resource_count() const;
+	// Resource kind and flags are zero if the container only has version 0 bindings.
+	bool get_resource(unsigned index, DXIL::PSVResourceBindInfo1 &info) const;
+
+	unsigned get_signature_element_count(DXIL::PSVSignature signature) const;
+	bool get_signature_element(DXIL::PSVSignature signature, unsigned index, DXIL::PSVSignatureElement0 &element,
+	                           const char **semantic_name, uint32_t *semantic_index) const;
+
+private:
+	const uint8_t *data = nullptr;
+	uint32_t size = 0;
+
+	DXIL::PSVRuntimeInfo1 runtime_info = {};
+	bool has_runtime_info1 = false;
+
+	uint32_t resources_offset = 0;
+	uint32_t resource_count = 0;
+	uint32_t resource_stride = 0;
+
+	uint32_t string_table_offset = 0;
+	uint32_t string_table_size = 0;
+	uint32_t semantic_index_table_offset = 0;
+	uint32_t semantic_index_count = 0;
+
+	uint32_t signature_offsets[unsigned(DXIL::PSVSignature::Count)] = {};
+	uint32_t signature_counts[unsigned(DXIL::PSVSignature::Count)] = {};
+	uint32_t signature_element_stride = 0;
+};
+
+enum class RootSignatureBindingType
+{
+	DescriptorTable,
+	RootConstants,
+	RootDescriptor,
+	StaticSampler
+};
+
+// One entry per descriptor range, root parameter or static sampler of a root signature.
+struct RootSignatureBinding
+{
+	RootSignatureBindingType type;
+	DXIL::ResourceType resource_type;
+	DXIL::ShaderVisibility visibility;
+	uint32_t register_space;
+	uint32_t base_register;
+	// UnboundedDescriptorCount for unbounded ranges.
+	uint32_t num_descriptors;
+	// Root parameter index, or static sampler index.
+	uint32_t parameter_index;
+	// First word of the parameter in the root constant block. Descriptor tables take one word,
+	// which holds the heap offset of the table. Root descriptors and static samplers take none.
+	uint32_t root_constant_word;
+	// Offset of base_register from the start of the descriptor table, with appended ranges resolved.
+	uint32_t offset_in_table;
+};
+
+// Decodes a root signature (RTS0, version 1.0 or 1.1) into a flat binding table, sorted by
+// resource type, space and register, so resources can be resolved without walking the serialized layout.
+class DXILRootSignatureParser
+{
+public:
+	bool parse(const DXILContainerIndex &index);
+	bool parse(const void *data, size_t size);
+
+	DXIL::RootSignatureVersion get_version() const;
+	uint32_t get_flags() const;
+	unsigned get_root_constant_word_count() const;
+
+	const std::vector<RootSignatureBinding> &get_bindings() const;
+
+	// Finds the binding which covers [register_index, register_index + range_size) for a given stage.
+	// Only one binding may cover a register range for any given visibility.
+	const RootSignatureBinding *find_binding(DXIL::ResourceType type, DXIL::ShaderVisibility visibility,
+	                                         uint32_t register_space, uint32_t register_index,
+	                                         uint32_t range_size) const;
+
+private:
+	std::vector<RootSignatureBinding> bindings;
+	// Bindings of resource type N are in [type_offsets[N], type_offsets[N + 1]).
+	uint32_t type_offsets[5] = {};
+	DXIL::RootSignatureVersion version = DXIL::RootSignatureVersion::Version1_0;
+	uint32_t flags = 0;
+	uint32_t root_constant_word_count = 0;
+
+	bool parse_descriptor_table(MemoryStream &stream, const DXIL::RootParameter &parameter, uint32_t parameter_index,
+	                            uint32_t root_constant_word);
+	bool parse_root_parameters(MemoryStream &stream, const DXIL::RootSignatureDesc &desc);
+	bool parse_static_samplers(MemoryStream &stream, const DXIL::RootSignatureDesc &desc);
+};
+
 class DXILContainerParser
 {
 public:
 	bool parse_container(const void *data, size_t size);
 	std::vector<uint8_t> &get_blob();
 
+	// I/O signatures are not needed for conversion, so they are only decoded on request.
+	static bool parse_signature(const DXILContainerIndex &index, DXIL::FourCC fourcc,
+	                            std::vector<DXIL::IOElement> &elements);
+
 private:
 	std::vector<uint8_t> dxil_blob;
-	std::vector<DXIL::IOElement> input_elements;
-	std::vector<DXIL::IOElement> output_elements;
 
-	bool parse_dxil(MemoryStream &stream);
-	bool parse_iosg1(MemoryStream &stream, std::vector<DXIL::IOElement> &elements);
+	static bool parse_iosg1(MemoryStream &stream, std::vector<DXIL::IOElement> &elements);
 };
 } // namespace dxil_spv
\ No newline at end of file
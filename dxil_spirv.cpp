@@ -17,10 +17,16 @@
  */
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <thread>
 #include <vector>
 
 #include "dxil_spirv_c.h"
@@ -30,6 +36,21 @@
 #include "spirv-tools/libspirv.hpp"
 #include "spirv_cross_c.h"
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <fcntl.h>
+#include <io.h>
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
 using namespace dxil_spv;
 
 static std::string convert_to_asm(const void *code, size_t size)
@@ -117,6 +138,7 @@ static void print_help()
 {
 	LOGE("Usage: dxil-spirv <input path>\n"
 	     "\t[--output <path>]\n"
+	     "\t[--entry <name>]\n"
 	     "\t[--glsl]\n"
 	     "\t[--validate]\n"
 	     "\t[--glsl-embed-asm]\n"
@@ -129,25 +151,87 @@ static void print_help()
 	     "\t[--bindless]\n"
 	     "\t[--local-root-signature]\n"
 	     "\t[--bindless-cbv-as-ssbo]\n"
-	     "\t[--output-rt-swizzle index xyzw]\n");
+	     "\t[--ssa-cleanup]\n"
+	     "\t[--integer-signedness-inference]\n"
+	     "\t[--loop-invariant-hoisting]\n"
+	     "\t[--physical-address-folding]\n"
+	     "\t[--vectorized-root-constants]\n"
+	     "\t[--spec-constant-output-swizzle spec_id]\n"
+	     "\t[--spec-constant-root-constant-word-count spec_id]\n"
+	     "\t[--statistics]\n"
+	     "\t[--output-rt-swizzle index xyzw]\n"
+	     "\t[--batch]\n"
+	     "\t[--output-dir <path>]\n"
+	     "\t[--threads count]\n"
+	     "\t[--queue-depth count]\n"
+	     "\t[--serve]\n"
+	     "\t[--serve-socket <path>]\n"
+	     "In --batch mode, the input path is a directory or a file with one input path per line.\n"
+	     "In --serve mode, framed conversion requests are read from stdin or a Unix domain socket.\n");
+}
+
+static void print_statistics(const dxil_spv_statistics &stats)
+{
+	LOGI("=== Statistics ===\n");
+	LOGI("  parse: %.3f ms\n", stats.parse_ms);
+	LOGI("  convert_entry_point: %.3f ms\n", stats.convert_entry_point_ms);
+	LOGI("  create_continue_block_ladders: %.3f ms\n", stats.create_continue_block_ladders_ms);
+	LOGI("  split_merge_scopes: %.3f ms\n", stats.split_merge_scopes_ms);
+	LOGI("  structurize: %.3f ms\n", stats.structurize_ms);
+	LOGI("  insert_phi: %.3f ms\n", stats.insert_phi_ms);
+	LOGI("  emit_function_body: %.3f ms\n", stats.emit_function_body_ms);
+	LOGI("  finalize_spirv: %.3f ms\n", stats.finalize_spirv_ms);
+	LOGI("  blocks: %u\n", stats.num_blocks);
+	LOGI("  helper blocks: %u\n", stats.num_helper_blocks);
+	LOGI("  phis: %u\n", stats.num_phis);
+	LOGI("  operations: %u\n", stats.num_operations);
+	LOGI("  constants: %u\n", stats.num_constants);
+	LOGI("  arena bytes: %zu\n", stats.arena_bytes);
+	LOGI("  arena allocations: %u\n", stats.num_arena_allocations);
+	if (stats.num_ir_blocks)
+	{
+		LOGI("  IR blocks: %u (%.2f passes)\n", stats.num_ir_blocks,
+		     double(stats.num_ir_block_visits) / stats.num_ir_blocks);
+	}
 }
 
 struct Arguments
 {
 	std::string input_path;
 	std::string output_path;
+	std::string entry_point;
 	bool dump_module = false;
 	bool glsl = false;
 	bool validate = false;
 	bool glsl_embed_asm = false;
 	bool shader_demote = false;
 	bool dual_source_blending = false;
-	std::vector<unsigned> swizzles;
+	// Begin with identity swizzles.
+	std::vector<unsigned> swizzles = std::vector<unsigned>(8, 0 | (1 << 2) | (2 << 4) | (3 << 6));
 
 	unsigned root_constant_inline_ubo_desc_set = 0;
 	unsigned root_constant_inline_ubo_binding = 0;
 	bool root_constant_inline_ubo = false;
 	bool bindless_cbv_as_ssbo = false;
+	bool ssa_cleanup = false;
+	bool integer_signedness_inference = false;
+	bool loop_invariant_hoisting = false;
+	bool physical_address_folding = false;
+	bool vectorized_root_constants = false;
+	bool spec_constant_output_swizzle = false;
+	unsigned output_swizzle_spec_id = 0;
+	bool spec_constant_root_constant_word_count = false;
+	unsigned root_constant_word_count_spec_id = 0;
+	bool statistics = false;
+	bool local_root_signature = false;
+
+	bool serve = false;
+	std::string serve_socket;
+
+	bool batch = false;
+	std::string output_dir;
+	unsigned num_threads = 0;
+	unsigned queue_depth = 0;
 };
 
 struct Remapper
@@ -180,6 +264,16 @@ struct Remapper
 	};
 	std::vector<StreamOutput> stream_outputs;
 	bool bindless = false;
+
+	// Clears the tables while keeping their allocations.
+	void reset()
+	{
+		root_constants.clear();
+		root_constant_word_count = 0;
+		vertex_inputs.clear();
+		stream_outputs.clear();
+		bindless = false;
+	}
 };
 
 static bool kind_is_buffer(dxil_spv_resource_kind kind)
@@ -361,171 +455,22 @@ static dxil_spv_bool remap_stream_output(void *userdata, const dxil_spv_d3d_stre
 	return DXIL_SPV_TRUE;
 }
 
-int main(int argc, char **argv)
-{
-	Arguments args;
-	Remapper remapper;
-	bool local_root_signature = false;
-
-	// Begin with identity swizzles.
-	args.swizzles.resize(8, 0 | (1 << 2) | (2 << 4) | (3 << 6));
-
-	CLICallbacks cbs;
-	cbs.add("--help", [](CLIParser &parser) {
-		print_help();
-		parser.end();
-	});
-	cbs.add("--dump-module", [&](CLIParser &) { args.dump_module = true; });
-	cbs.add("--glsl-embed-asm", [&](CLIParser &) { args.glsl_embed_asm = true; });
-	cbs.add("--glsl", [&](CLIParser &) { args.glsl = true; });
-	cbs.add("--validate", [&](CLIParser &) { args.validate = true; });
-	cbs.add("--output", [&](CLIParser &parser) { args.output_path = parser.next_string(); });
-	cbs.add("--root-constant", [&](CLIParser &parser) {
-		Remapper::RootConstant root = {};
-		root.register_space = parser.next_uint();
-		root.register_index = parser.next_uint();
-		root.word_offset = parser.next_uint();
-		unsigned word_count = parser.next_uint();
-		remapper.root_constant_word_count = std::max(remapper.root_constant_word_count, word_count + root.word_offset);
-		remapper.root_constants.push_back(root);
-	});
-	cbs.add("--vertex-input", [&](CLIParser &parser) {
-		const char *sem = parser.next_string();
-		unsigned loc = parser.next_uint();
-		remapper.vertex_inputs.push_back({ std::string(sem), loc });
-	});
-	cbs.add("--stream-output", [&](CLIParser &parser) {
-		const char *sem = parser.next_string();
-		unsigned index = parser.next_uint();
-
-		unsigned offset = parser.next_uint();
-		unsigned stride = parser.next_uint();
-		unsigned buffer_index = parser.next_uint();
-		remapper.stream_outputs.push_back({ std::string(sem), index, offset, stride, buffer_index });
-	});
-	cbs.add("--enable-shader-demote", [&](CLIParser &) { args.shader_demote = true; });
-	cbs.add("--enable-dual-source-blending", [&](CLIParser &) { args.dual_source_blending = true; });
-	cbs.add("--bindless", [&](CLIParser &) {
-		remapper.bindless = true;
-		remapper.root_constant_word_count = std::max(remapper.root_constant_word_count, 8u);
-	});
-	cbs.add("--local-root-signature", [&](CLIParser &) {
-		local_root_signature = true;
-	});
-	cbs.add("--output-rt-swizzle", [&](CLIParser &parser) {
-		unsigned index = parser.next_uint();
-		if (index >= args.swizzles.size())
-		{
-			LOGE("RT index out of range.\n");
-			print_help();
-			parser.end();
-			return;
-		}
-
-		const char *arg = parser.next_string();
-		if (strlen(arg) != 4)
-		{
-			LOGE("RT swizzle must be 4 characters (x, y, z, w).\n");
-			print_help();
-			parser.end();
-			return;
-		}
-
-		auto &swiz = args.swizzles[index];
-		swiz = 0;
-
-		for (unsigned c = 0; c < 4; c++)
-		{
-			switch (arg[c])
-			{
-			case 'x':
-			case 'X':
-			case 'r':
-			case 'R':
-				swiz |= 0 << (2 * c);
-				break;
-
-			case 'y':
-			case 'Y':
-			case 'g':
-			case 'G':
-				swiz |= 1 << (2 * c);
-				break;
-
-			case 'z':
-			case 'Z':
-			case 'b':
-			case 'B':
-				swiz |= 2 << (2 * c);
-				break;
-
-			case 'w':
-			case 'W':
-			case 'a':
-			case 'A':
-				swiz |= 3 << (2 * c);
-				break;
-
-			default:
-				LOGE("Invalid swizzle character %c.\n", arg[c]);
-				print_help();
-				parser.end();
-				return;
-			}
-		}
-	});
-	cbs.add("--root-constant-inline-ubo", [&](CLIParser &parser) {
-		args.root_constant_inline_ubo_desc_set = parser.next_uint();
-		args.root_constant_inline_ubo_binding = parser.next_uint();
-		args.root_constant_inline_ubo = true;
-	});
-	cbs.add("--bindless-cbv-as-ssbo", [&](CLIParser &) { args.bindless_cbv_as_ssbo = true; });
-	cbs.error_handler = [] { print_help(); };
-	cbs.default_handler = [&](const char *arg) { args.input_path = arg; };
-	CLIParser cli_parser(std::move(cbs), argc - 1, argv + 1);
-	if (!cli_parser.parse())
-		return EXIT_FAILURE;
-	else if (cli_parser.is_ended_state())
-		return EXIT_SUCCESS;
-
-	if (args.input_path.empty())
-	{
-		LOGE("No input file.\n");
-		print_help();
-		return EXIT_FAILURE;
-	}
-
-	auto binary = read_file(args.input_path.c_str());
-	if (binary.empty())
-	{
-		LOGE("Failed to load file: %s\n", args.input_path.c_str());
-		return EXIT_FAILURE;
-	}
-
-	dxil_spv_parsed_blob blob;
-	if (dxil_spv_parse_dxil_blob(binary.data(), binary.size(), &blob) != DXIL_SPV_SUCCESS)
-	{
-		LOGE("Failed to parse blob.\n");
-		return EXIT_FAILURE;
-	}
-
-	if (args.dump_module)
-		dxil_spv_parsed_blob_dump_llvm_ir(blob);
-
-	dxil_spv_converter converter;
-	if (dxil_spv_create_converter(blob, &converter) != DXIL_SPV_SUCCESS)
-		return EXIT_FAILURE;
 
+static void setup_converter(dxil_spv_converter converter, const Arguments &args, Remapper &remapper)
+{
 	dxil_spv_converter_set_srv_remapper(converter, remap_srv, &remapper);
 	dxil_spv_converter_set_sampler_remapper(converter, remap_sampler, &remapper);
 	dxil_spv_converter_set_uav_remapper(converter, remap_uav, &remapper);
 	dxil_spv_converter_set_cbv_remapper(converter, remap_cbv, &remapper);
 
+	if (!args.entry_point.empty())
+		dxil_spv_converter_set_entry_point(converter, args.entry_point.c_str());
+
 	dxil_spv_converter_set_vertex_input_remapper(converter, remap_vertex_input, &remapper);
 	dxil_spv_converter_set_stream_output_remapper(converter, remap_stream_output, &remapper);
 	dxil_spv_converter_set_root_constant_word_count(converter, remapper.root_constant_word_count);
 
-	if (local_root_signature)
+	if (args.local_root_signature)
 	{
 		dxil_spv_converter_add_local_root_constants(converter, 15, 0, 5);
 		dxil_spv_converter_add_local_root_constants(converter, 15, 1, 6);
@@ -587,92 +532,1091 @@ int main(int argc, char **argv)
 		dxil_spv_converter_add_option(converter, &phys.base);
 	}
 
-	if (dxil_spv_converter_run(converter) != DXIL_SPV_SUCCESS)
+	if (args.ssa_cleanup)
 	{
-		LOGE("Failed to convert DXIL to SPIR-V.\n");
-		return EXIT_FAILURE;
+		const dxil_spv_option_ssa_cleanup cleanup = { { DXIL_SPV_OPTION_SSA_CLEANUP }, DXIL_SPV_TRUE };
+		dxil_spv_converter_add_option(converter, &cleanup.base);
 	}
 
-	dxil_spv_compiled_spirv compiled;
-	if (dxil_spv_converter_get_compiled_spirv(converter, &compiled) != DXIL_SPV_SUCCESS)
-		return EXIT_FAILURE;
+	if (args.integer_signedness_inference)
+	{
+		const dxil_spv_option_integer_signedness_inference inference = {
+			{ DXIL_SPV_OPTION_INTEGER_SIGNEDNESS_INFERENCE }, DXIL_SPV_TRUE
+		};
+		dxil_spv_converter_add_option(converter, &inference.base);
+	}
+
+	if (args.loop_invariant_hoisting)
+	{
+		const dxil_spv_option_loop_invariant_hoisting hoisting = { { DXIL_SPV_OPTION_LOOP_INVARIANT_HOISTING },
+			                                                       DXIL_SPV_TRUE };
+		dxil_spv_converter_add_option(converter, &hoisting.base);
+	}
+
+	if (args.physical_address_folding)
+	{
+		const dxil_spv_option_physical_address_folding folding = { { DXIL_SPV_OPTION_PHYSICAL_ADDRESS_FOLDING },
+			                                                        DXIL_SPV_TRUE };
+		dxil_spv_converter_add_option(converter, &folding.base);
+	}
+
+	if (args.vectorized_root_constants)
+	{
+		const dxil_spv_option_vectorized_root_constants vectorized = {
+			{ DXIL_SPV_OPTION_VECTORIZED_ROOT_CONSTANTS }, DXIL_SPV_TRUE
+		};
+		dxil_spv_converter_add_option(converter, &vectorized.base);
+	}
+
+	if (args.spec_constant_output_swizzle || args.spec_constant_root_constant_word_count)
+	{
+		const dxil_spv_option_pipeline_state_spec_constants spec = {
+			{ DXIL_SPV_OPTION_PIPELINE_STATE_SPEC_CONSTANTS },
+			args.spec_constant_output_swizzle ? DXIL_SPV_TRUE : DXIL_SPV_FALSE,
+			args.output_swizzle_spec_id,
+			args.spec_constant_root_constant_word_count ? DXIL_SPV_TRUE : DXIL_SPV_FALSE,
+			args.root_constant_word_count_spec_id
+		};
+		dxil_spv_converter_add_option(converter, &spec.base);
+	}
+
+	if (args.statistics)
+		dxil_spv_converter_enable_statistics(converter, DXIL_SPV_TRUE);
+}
+
+// Runs the post-conversion steps, validation and cross-compilation, which do not depend on the converter.
+// Text output is GLSL, or SPIR-V assembly if requested, otherwise the SPIR-V binary is written as-is.
+static bool process_spirv(const Arguments &args, const std::vector<uint32_t> &spirv, bool assembly_output,
+                          std::string &text)
+{
+	size_t size = spirv.size() * sizeof(uint32_t);
 
 	if (args.validate)
 	{
-		if (!validate_spirv(compiled.data, compiled.size))
+		if (!validate_spirv(spirv.data(), size))
 		{
 			LOGE("Failed to validate SPIR-V.\n");
-			return EXIT_FAILURE;
+			return false;
 		}
 	}
 
 	std::string spirv_asm_string;
 	if (args.glsl_embed_asm)
-		spirv_asm_string = convert_to_asm(compiled.data, compiled.size);
+		spirv_asm_string = convert_to_asm(spirv.data(), size);
 
 	if (args.glsl)
 	{
-		auto glsl = convert_to_glsl(compiled.data, compiled.size);
-		if (glsl.empty())
+		text = convert_to_glsl(spirv.data(), size);
+		if (text.empty())
 		{
 			LOGE("Failed to convert to GLSL.\n");
-			return EXIT_FAILURE;
+			return false;
 		}
 
 		if (!spirv_asm_string.empty())
 		{
-			glsl += "\n#if 0\n";
-			glsl += "// SPIR-V disassembly\n";
-			glsl += spirv_asm_string;
-			glsl += "#endif";
+			text += "\n#if 0\n";
+			text += "// SPIR-V disassembly\n";
+			text += spirv_asm_string;
+			text += "#endif";
 		}
-
-		if (args.output_path.empty())
+	}
+	else if (assembly_output)
+	{
+		text = convert_to_asm(spirv.data(), size);
+		if (text.empty())
 		{
-			printf("%s\n", glsl.c_str());
+			LOGE("Failed to convert to SPIR-V asm.\n");
+			return false;
 		}
-		else
+	}
+
+	return true;
+}
+
+// An empty output path prints the text output to stdout.
+static bool write_output(const Arguments &args, const std::string &output_path, const std::vector<uint32_t> &spirv,
+                         const std::string &text)
+{
+	if (output_path.empty())
+	{
+		printf("%s\n", text.c_str());
+	}
+	else if (args.glsl)
+	{
+		FILE *file = fopen(output_path.c_str(), "w");
+		if (!file)
 		{
-			FILE *file = fopen(args.output_path.c_str(), "w");
-			if (!file)
-			{
-				LOGE("Failed to open %s for writing.\n", args.output_path.c_str());
-				return EXIT_FAILURE;
-			}
-			fprintf(file, "%s\n", glsl.c_str());
-			fclose(file);
+			LOGE("Failed to open %s for writing.\n", output_path.c_str());
+			return false;
 		}
+		fprintf(file, "%s\n", text.c_str());
+		fclose(file);
 	}
 	else
 	{
-		if (args.output_path.empty())
+		FILE *file = fopen(output_path.c_str(), "wb");
+		if (!file)
 		{
-			auto assembly = convert_to_asm(compiled.data, compiled.size);
-			if (assembly.empty())
-			{
-				LOGE("Failed to convert to SPIR-V asm.\n");
-				return EXIT_FAILURE;
-			}
-			printf("%s\n", assembly.c_str());
+			LOGE("Failed to open %s.\n", output_path.c_str());
+			return false;
 		}
-		else
+
+		size_t size = spirv.size() * sizeof(uint32_t);
+		bool success = fwrite(spirv.data(), 1, size, file) == size;
+		fclose(file);
+		if (!success)
+		{
+			LOGE("Failed to write SPIR-V.\n");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// The name is only used to tell statistics of concurrent conversions apart.
+// If context is not nullptr, the converter reuses its memory.
+static bool convert_blob(const Arguments &args, Remapper &remapper, const void *data, size_t size,
+                         const std::string &name, dxil_spv_converter_context context, std::vector<uint32_t> &spirv)
+{
+	dxil_spv_parsed_blob blob;
+	if (dxil_spv_parse_dxil_blob(data, size, &blob) != DXIL_SPV_SUCCESS)
+	{
+		LOGE("Failed to parse blob.\n");
+		return false;
+	}
+
+	if (args.dump_module)
+		dxil_spv_parsed_blob_dump_llvm_ir(blob);
+
+	dxil_spv_converter converter;
+	dxil_spv_result result = context ? dxil_spv_create_converter_with_context(blob, context, &converter) :
+	                                   dxil_spv_create_converter(blob, &converter);
+	if (result != DXIL_SPV_SUCCESS)
+	{
+		dxil_spv_parsed_blob_free(blob);
+		return false;
+	}
+
+	setup_converter(converter, args, remapper);
+
+	bool success = false;
+	if (dxil_spv_converter_run(converter) == DXIL_SPV_SUCCESS)
+	{
+		if (args.statistics)
 		{
-			FILE *file = fopen(args.output_path.c_str(), "wb");
-			if (file)
+			dxil_spv_statistics stats;
+			if (dxil_spv_converter_get_statistics(converter, &stats) == DXIL_SPV_SUCCESS)
 			{
-				if (fwrite(compiled.data, 1, compiled.size, file) != compiled.size)
-				{
-					LOGE("Failed to write SPIR-V.\n");
-					return EXIT_FAILURE;
-				}
-				fclose(file);
+				// Keep statistics from concurrent batch conversions from interleaving.
+				static std::mutex statistics_lock;
+				std::lock_guard<std::mutex> holder{ statistics_lock };
+				if (!name.empty())
+					LOGI("%s:\n", name.c_str());
+				print_statistics(stats);
 			}
-			else
-				LOGE("Failed to open %s.\n", args.output_path.c_str());
+		}
+
+		dxil_spv_compiled_spirv compiled;
+		if (dxil_spv_converter_get_compiled_spirv(converter, &compiled) == DXIL_SPV_SUCCESS)
+		{
+			auto *words = static_cast<const uint32_t *>(compiled.data);
+			spirv.assign(words, words + compiled.size / sizeof(uint32_t));
+			success = true;
 		}
 	}
+	else
+		LOGE("Failed to convert DXIL to SPIR-V.\n");
 
 	dxil_spv_converter_free(converter);
 	dxil_spv_parsed_blob_free(blob);
-	return EXIT_SUCCESS;
-}
\ No newline at end of file
+	return success;
+}
+
+static bool convert_file(const Arguments &args, Remapper &remapper, const std::string &input_path,
+                         std::vector<uint32_t> &spirv, size_t *input_size)
+{
+	auto binary = read_file(input_path.c_str());
+	if (binary.empty())
+	{
+		LOGE("Failed to load file: %s\n", input_path.c_str());
+		return false;
+	}
+
+	if (input_size)
+		*input_size = binary.size();
+
+	return convert_blob(args, remapper, binary.data(), binary.size(), args.batch ? input_path : std::string(), nullptr,
+	                    spirv);
+}
+
+static bool ends_with(const std::string &str, const char *suffix)
+{
+	size_t len = strlen(suffix);
+	return str.size() >= len && str.compare(str.size() - len, len, suffix) == 0;
+}
+
+static bool list_directory(const std::string &dir, std::vector<std::string> &paths)
+{
+#ifdef _WIN32
+	WIN32_FIND_DATAA data;
+	HANDLE handle = FindFirstFileA((dir + "\\*").c_str(), &data);
+	if (handle == INVALID_HANDLE_VALUE)
+		return false;
+
+	do
+	{
+		if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+			paths.push_back(dir + "/" + data.cFileName);
+	} while (FindNextFileA(handle, &data));
+	FindClose(handle);
+#else
+	DIR *d = opendir(dir.c_str());
+	if (!d)
+		return false;
+
+	while (auto *entry = readdir(d))
+	{
+		if (entry->d_name[0] == '.')
+			continue;
+		paths.push_back(dir + "/" + entry->d_name);
+	}
+	closedir(d);
+#endif
+
+	std::sort(paths.begin(), paths.end());
+	return true;
+}
+
+static bool read_list_file(const std::string &path, std::vector<std::string> &paths)
+{
+	auto list = read_file(path.c_str());
+	if (list.empty())
+		return false;
+
+	std::string line;
+	list.push_back('\n');
+	for (auto c : list)
+	{
+		if (c == '\n' || c == '\r')
+		{
+			// Allow comments and blank lines in list files.
+			auto begin = line.find_first_not_of(" \t");
+			auto end = line.find_last_not_of(" \t");
+			if (begin != std::string::npos && line[begin] != '#')
+				paths.push_back(line.substr(begin, end - begin + 1));
+			line.clear();
+		}
+		else
+			line.push_back(char(c));
+	}
+
+	return true;
+}
+
+static bool gather_batch_inputs(const std::string &path, std::vector<std::string> &inputs)
+{
+	if (list_directory(path, inputs))
+	{
+		// Don't pick up outputs from an earlier batch run which wrote next to the inputs.
+		inputs.erase(std::remove_if(inputs.begin(), inputs.end(),
+		                            [](const std::string &input) {
+			                            return ends_with(input, ".spv") || ends_with(input, ".glsl");
+		                            }),
+		             inputs.end());
+		return true;
+	}
+	else
+		return read_list_file(path, inputs);
+}
+
+static std::string get_batch_output_path(const Arguments &args, const std::string &input_path)
+{
+	std::string path;
+	if (args.output_dir.empty())
+	{
+		path = input_path;
+	}
+	else
+	{
+		auto index = input_path.find_last_of("/\\");
+		path = args.output_dir + "/" + (index != std::string::npos ? input_path.substr(index + 1) : input_path);
+	}
+
+	return path + (args.glsl ? ".glsl" : ".spv");
+}
+
+// Batch conversion is pipelined. Workers prefer post-processing (validation, cross-compilation) of converted
+// shaders over starting new conversions, so post-steps of shader N overlap conversion of shader N + 1.
+// Outputs are written by the calling thread in input order. At most queue_depth shaders are in flight beyond
+// the last written one, which bounds memory use when one slow shader holds up the rest.
+struct BatchPipeline
+{
+	enum class State
+	{
+		Pending,
+		Converting,
+		Converted,
+		Processing,
+		Done
+	};
+
+	struct Job
+	{
+		State state = State::Pending;
+		bool success = false;
+		size_t input_size = 0;
+		std::vector<uint32_t> spirv;
+		std::string text;
+	};
+
+	std::vector<Job> jobs;
+	std::deque<size_t> converted;
+	size_t next_convert = 0;
+	size_t next_write = 0;
+	size_t queue_depth = 0;
+
+	std::mutex lock;
+	std::condition_variable cond;
+};
+
+static void run_batch_worker(const Arguments &args, Remapper &remapper, const std::vector<std::string> &inputs,
+                             BatchPipeline &pipeline)
+{
+	std::unique_lock<std::mutex> holder{ pipeline.lock };
+
+	for (;;)
+	{
+		if (!pipeline.converted.empty())
+		{
+			size_t index = pipeline.converted.front();
+			pipeline.converted.pop_front();
+			auto &job = pipeline.jobs[index];
+			job.state = BatchPipeline::State::Processing;
+			holder.unlock();
+
+			job.success = process_spirv(args, job.spirv, false, job.text);
+
+			holder.lock();
+			job.state = BatchPipeline::State::Done;
+			pipeline.cond.notify_all();
+		}
+		else if (pipeline.next_convert < inputs.size() &&
+		         pipeline.next_convert < pipeline.next_write + pipeline.queue_depth)
+		{
+			size_t index = pipeline.next_convert++;
+			auto &job = pipeline.jobs[index];
+			job.state = BatchPipeline::State::Converting;
+			holder.unlock();
+
+			job.success = convert_file(args, remapper, inputs[index], job.spirv, &job.input_size);
+
+			holder.lock();
+			if (job.success)
+			{
+				job.state = BatchPipeline::State::Converted;
+				pipeline.converted.push_back(index);
+			}
+			else
+				job.state = BatchPipeline::State::Done;
+			pipeline.cond.notify_all();
+		}
+		else if (pipeline.next_convert == inputs.size())
+		{
+			// Nothing left to convert, and the remaining post-steps are taken by other workers.
+			return;
+		}
+		else
+			pipeline.cond.wait(holder);
+	}
+}
+
+static bool run_batch(const Arguments &args, Remapper &remapper)
+{
+	std::vector<std::string> inputs;
+	if (!gather_batch_inputs(args.input_path, inputs))
+	{
+		LOGE("Failed to read batch inputs from %s.\n", args.input_path.c_str());
+		return false;
+	}
+
+	if (inputs.empty())
+	{
+		LOGE("No batch inputs found in %s.\n", args.input_path.c_str());
+		return false;
+	}
+
+	unsigned num_threads = args.num_threads ? args.num_threads : std::thread::hardware_concurrency();
+	num_threads = std::max(1u, std::min(num_threads, unsigned(inputs.size())));
+
+	BatchPipeline pipeline;
+	pipeline.jobs.resize(inputs.size());
+	pipeline.queue_depth = args.queue_depth ? args.queue_depth : 2 * num_threads;
+
+	auto start = std::chrono::steady_clock::now();
+
+	// Remapper callbacks only read shared state, so every worker can use the same remapper.
+	std::vector<std::thread> threads;
+	for (unsigned i = 0; i < num_threads; i++)
+		threads.emplace_back(run_batch_worker, std::cref(args), std::ref(remapper), std::cref(inputs),
+		                     std::ref(pipeline));
+
+	unsigned num_success = 0;
+	size_t total_size = 0;
+
+	for (size_t i = 0; i < inputs.size(); i++)
+	{
+		auto &job = pipeline.jobs[i];
+
+		{
+			std::unique_lock<std::mutex> holder{ pipeline.lock };
+			pipeline.cond.wait(holder, [&]() { return job.state == BatchPipeline::State::Done; });
+		}
+
+		if (job.success)
+			job.success = write_output(args, get_batch_output_path(args, inputs[i]), job.spirv, job.text);
+
+		if (job.success)
+			num_success++;
+		else
+			LOGE("Failed to convert %s.\n", inputs[i].c_str());
+		total_size += job.input_size;
+
+		std::vector<uint32_t>().swap(job.spirv);
+		std::string().swap(job.text);
+
+		{
+			std::lock_guard<std::mutex> holder{ pipeline.lock };
+			pipeline.next_write = i + 1;
+		}
+		pipeline.cond.notify_all();
+	}
+
+	for (auto &thread : threads)
+		thread.join();
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	LOGI("Converted %u / %u shaders in %.3f s on %u threads, %.1f shaders/s, %.3f MiB/s.\n", num_success,
+	     unsigned(inputs.size()), seconds, num_threads, double(inputs.size()) / seconds,
+	     double(total_size) / (1024.0 * 1024.0 * seconds));
+
+	return num_success == inputs.size();
+}
+
+// Options which affect a single conversion. These are shared between regular command lines and --serve requests.
+static void register_conversion_options(CLICallbacks &cbs, Arguments &args, Remapper &remapper)
+{
+	cbs.add("--glsl-embed-asm", [&](CLIParser &) { args.glsl_embed_asm = true; });
+	cbs.add("--glsl", [&](CLIParser &) { args.glsl = true; });
+	cbs.add("--validate", [&](CLIParser &) { args.validate = true; });
+	cbs.add("--entry", [&](CLIParser &parser) { args.entry_point = parser.next_string(); });
+	cbs.add("--root-constant", [&](CLIParser &parser) {
+		Remapper::RootConstant root = {};
+		root.register_space = parser.next_uint();
+		root.register_index = parser.next_uint();
+		root.word_offset = parser.next_uint();
+		unsigned word_count = parser.next_uint();
+		remapper.root_constant_word_count = std::max(remapper.root_constant_word_count, word_count + root.word_offset);
+		remapper.root_constants.push_back(root);
+	});
+	cbs.add("--vertex-input", [&](CLIParser &parser) {
+		const char *sem = parser.next_string();
+		unsigned loc = parser.next_uint();
+		remapper.vertex_inputs.push_back({ std::string(sem), loc });
+	});
+	cbs.add("--stream-output", [&](CLIParser &parser) {
+		const char *sem = parser.next_string();
+		unsigned index = parser.next_uint();
+
+		unsigned offset = parser.next_uint();
+		unsigned stride = parser.next_uint();
+		unsigned buffer_index = parser.next_uint();
+		remapper.stream_outputs.push_back({ std::string(sem), index, offset, stride, buffer_index });
+	});
+	cbs.add("--enable-shader-demote", [&](CLIParser &) { args.shader_demote = true; });
+	cbs.add("--enable-dual-source-blending", [&](CLIParser &) { args.dual_source_blending = true; });
+	cbs.add("--bindless", [&](CLIParser &) {
+		remapper.bindless = true;
+		remapper.root_constant_word_count = std::max(remapper.root_constant_word_count, 8u);
+	});
+	cbs.add("--local-root-signature", [&](CLIParser &) {
+		args.local_root_signature = true;
+	});
+	cbs.add("--output-rt-swizzle", [&](CLIParser &parser) {
+		unsigned index = parser.next_uint();
+		if (index >= args.swizzles.size())
+		{
+			LOGE("RT index out of range.\n");
+			print_help();
+			parser.end();
+			return;
+		}
+
+		const char *arg = parser.next_string();
+		if (strlen(arg) != 4)
+		{
+			LOGE("RT swizzle must be 4 characters (x, y, z, w).\n");
+			print_help();
+			parser.end();
+			return;
+		}
+
+		auto &swiz = args.swizzles[index];
+		swiz = 0;
+
+		for (unsigned c = 0; c < 4; c++)
+		{
+			switch (arg[c])
+			{
+			case 'x':
+			case 'X':
+			case 'r':
+			case 'R':
+				swiz |= 0 << (2 * c);
+				break;
+
+			case 'y':
+			case 'Y':
+			case 'g':
+			case 'G':
+				swiz |= 1 << (2 * c);
+				break;
+
+			case 'z':
+			case 'Z':
+			case 'b':
+			case 'B':
+				swiz |= 2 << (2 * c);
+				break;
+
+			case 'w':
+			case 'W':
+			case 'a':
+			case 'A':
+				swiz |= 3 << (2 * c);
+				break;
+
+			default:
+				LOGE("Invalid swizzle character %c.\n", arg[c]);
+				print_help();
+				parser.end();
+				return;
+			}
+		}
+	});
+	cbs.add("--root-constant-inline-ubo", [&](CLIParser &parser) {
+		args.root_constant_inline_ubo_desc_set = parser.next_uint();
+		args.root_constant_inline_ubo_binding = parser.next_uint();
+		args.root_constant_inline_ubo = true;
+	});
+	cbs.add("--bindless-cbv-as-ssbo", [&](CLIParser &) { args.bindless_cbv_as_ssbo = true; });
+	cbs.add("--ssa-cleanup", [&](CLIParser &) { args.ssa_cleanup = true; });
+	cbs.add("--integer-signedness-inference", [&](CLIParser &) { args.integer_signedness_inference = true; });
+	cbs.add("--loop-invariant-hoisting", [&](CLIParser &) { args.loop_invariant_hoisting = true; });
+	cbs.add("--physical-address-folding", [&](CLIParser &) { args.physical_address_folding = true; });
+	cbs.add("--vectorized-root-constants", [&](CLIParser &) { args.vectorized_root_constants = true; });
+	cbs.add("--spec-constant-output-swizzle", [&](CLIParser &parser) {
+		args.spec_constant_output_swizzle = true;
+		args.output_swizzle_spec_id = parser.next_uint();
+	});
+	cbs.add("--spec-constant-root-constant-word-count", [&](CLIParser &parser) {
+		args.spec_constant_root_constant_word_count = true;
+		args.root_constant_word_count_spec_id = parser.next_uint();
+	});
+	cbs.add("--statistics", [&](CLIParser &) { args.statistics = true; });
+}
+
+// --serve keeps a converter process alive and handles framed requests, either over stdin / stdout,
+// or over a Unix domain socket where every connection is served on its own thread.
+// All integers are little-endian uint32.
+// Request: magic, argument count, { argument length, argument bytes } per argument, DXIL size, DXIL bytes.
+// Reply: magic, status (0 on success), payload size, payload bytes.
+// Arguments are regular conversion options such as --bindless or --root-constant 0 0 4 12.
+// The payload is what would have been written with --output, i.e. GLSL with --glsl, otherwise SPIR-V.
+// A request with the shutdown magic and nothing else stops the server once it has been acknowledged.
+// On a socket, SIGINT and SIGTERM also stop the server. Connections finish the request they are handling.
+constexpr uint32_t ServeMagic = 0x56535844; // DXSV
+constexpr uint32_t ServeShutdownMagic = 0x51535844; // DXSQ
+constexpr uint32_t ServeMaxArguments = 1024;
+constexpr uint32_t ServeMaxArgumentSize = 4096;
+constexpr uint32_t ServeMaxBlobSize = 256 * 1024 * 1024;
+
+struct ServeStream
+{
+	virtual ~ServeStream() = default;
+	virtual bool read(void *data, size_t size) = 0;
+	virtual bool write(const void *data, size_t size) = 0;
+	virtual bool flush() = 0;
+};
+
+struct StdioServeStream : ServeStream
+{
+	bool read(void *data, size_t size) override
+	{
+		return fread(data, 1, size, stdin) == size;
+	}
+
+	bool write(const void *data, size_t size) override
+	{
+		return fwrite(data, 1, size, stdout) == size;
+	}
+
+	bool flush() override
+	{
+		return fflush(stdout) == 0;
+	}
+};
+
+#ifndef _WIN32
+struct SocketServeStream : ServeStream
+{
+	explicit SocketServeStream(int fd_)
+	    : fd(fd_)
+	{
+	}
+
+	~SocketServeStream() override
+	{
+		close(fd);
+	}
+
+	bool read(void *data, size_t size) override
+	{
+		auto *ptr = static_cast<uint8_t *>(data);
+		while (size)
+		{
+			ssize_t ret = ::read(fd, ptr, size);
+			if (ret < 0 && errno == EINTR)
+				continue;
+			else if (ret <= 0)
+				return false;
+			ptr += ret;
+			size -= size_t(ret);
+		}
+		return true;
+	}
+
+	bool write(const void *data, size_t size) override
+	{
+		auto *ptr = static_cast<const uint8_t *>(data);
+		while (size)
+		{
+			ssize_t ret = ::write(fd, ptr, size);
+			if (ret < 0 && errno == EINTR)
+				continue;
+			else if (ret <= 0)
+				return false;
+			ptr += ret;
+			size -= size_t(ret);
+		}
+		return true;
+	}
+
+	bool flush() override
+	{
+		return true;
+	}
+
+	int fd;
+};
+#endif
+
+static bool read_u32(ServeStream &stream, uint32_t &value)
+{
+	uint8_t bytes[4];
+	if (!stream.read(bytes, sizeof(bytes)))
+		return false;
+	value = uint32_t(bytes[0]) | (uint32_t(bytes[1]) << 8) | (uint32_t(bytes[2]) << 16) | (uint32_t(bytes[3]) << 24);
+	return true;
+}
+
+static bool write_u32(ServeStream &stream, uint32_t value)
+{
+	const uint8_t bytes[4] = { uint8_t(value), uint8_t(value >> 8), uint8_t(value >> 16), uint8_t(value >> 24) };
+	return stream.write(bytes, sizeof(bytes));
+}
+
+static bool read_serve_conversion(ServeStream &stream, std::vector<std::string> &arguments, std::vector<uint8_t> &blob)
+{
+	uint32_t num_arguments, blob_size;
+	if (!read_u32(stream, num_arguments) || num_arguments > ServeMaxArguments)
+		return false;
+
+	arguments.resize(num_arguments);
+	for (auto &argument : arguments)
+	{
+		uint32_t len;
+		if (!read_u32(stream, len) || len > ServeMaxArgumentSize)
+			return false;
+		argument.resize(len);
+		if (len && !stream.read(&argument[0], len))
+			return false;
+	}
+
+	if (!read_u32(stream, blob_size) || blob_size > ServeMaxBlobSize)
+		return false;
+
+	blob.resize(blob_size);
+	return !blob_size || stream.read(blob.data(), blob_size);
+}
+
+enum class ServeRequest
+{
+	Convert,
+	Shutdown,
+	Invalid
+};
+
+static ServeRequest read_serve_request(ServeStream &stream, std::vector<std::string> &arguments,
+                                       std::vector<uint8_t> &blob)
+{
+	uint32_t magic;
+	if (!read_u32(stream, magic))
+		return ServeRequest::Invalid;
+	else if (magic == ServeShutdownMagic)
+		return ServeRequest::Shutdown;
+	else if (magic != ServeMagic)
+		return ServeRequest::Invalid;
+	else if (read_serve_conversion(stream, arguments, blob))
+		return ServeRequest::Convert;
+	else
+		return ServeRequest::Invalid;
+}
+
+// State kept by each serving thread, so steady state requests mostly reuse memory.
+struct ServeSession
+{
+	ServeSession()
+	{
+		if (dxil_spv_create_converter_context(&context) != DXIL_SPV_SUCCESS)
+			context = nullptr;
+	}
+
+	~ServeSession()
+	{
+		if (context)
+			dxil_spv_converter_context_free(context);
+	}
+
+	ServeSession(const ServeSession &) = delete;
+	void operator=(const ServeSession &) = delete;
+
+	dxil_spv_converter_context context = nullptr;
+	Arguments args;
+	Remapper remapper;
+	std::vector<std::string> arguments;
+	std::vector<uint8_t> blob;
+	std::vector<uint8_t> payload;
+	std::vector<uint32_t> spirv;
+	std::string text;
+};
+
+static bool handle_serve_request(ServeSession &session)
+{
+	auto &args = session.args;
+	auto &remapper = session.remapper;
+	args = {};
+	remapper.reset();
+	bool valid = true;
+
+	CLICallbacks cbs;
+	register_conversion_options(cbs, args, remapper);
+	cbs.error_handler = [&] { valid = false; };
+	cbs.default_handler = [&](const char *arg) {
+		LOGE("Unexpected argument %s in serve request.\n", arg);
+		valid = false;
+	};
+
+	std::vector<char *> argv;
+	argv.reserve(session.arguments.size());
+	for (auto &argument : session.arguments)
+		argv.push_back(&argument[0]);
+
+	CLIParser cli_parser(std::move(cbs), int(argv.size()), argv.data());
+	if (!cli_parser.parse() || cli_parser.is_ended_state() || !valid)
+		return false;
+
+	auto &spirv = session.spirv;
+	auto &text = session.text;
+	spirv.clear();
+	text.clear();
+
+	if (!convert_blob(args, remapper, session.blob.data(), session.blob.size(), std::string(), session.context, spirv))
+		return false;
+
+	if (!process_spirv(args, spirv, false, text))
+		return false;
+
+	if (args.glsl)
+	{
+		text += "\n";
+		session.payload.assign(text.begin(), text.end());
+	}
+	else
+	{
+		auto *bytes = reinterpret_cast<const uint8_t *>(spirv.data());
+		session.payload.assign(bytes, bytes + spirv.size() * sizeof(uint32_t));
+	}
+
+	return true;
+}
+
+static bool write_serve_reply(ServeStream &stream, bool success, const std::vector<uint8_t> &payload)
+{
+	return write_u32(stream, ServeMagic) && write_u32(stream, success ? 0 : 1) &&
+	       write_u32(stream, uint32_t(payload.size())) &&
+	       (payload.empty() || stream.write(payload.data(), payload.size())) && stream.flush();
+}
+
+// Returns true if the client requested a shutdown.
+static bool serve_stream(ServeStream &stream)
+{
+	ServeSession session;
+
+	for (;;)
+	{
+		auto request = read_serve_request(stream, session.arguments, session.blob);
+		session.payload.clear();
+
+		if (request == ServeRequest::Shutdown)
+		{
+			write_serve_reply(stream, true, session.payload);
+			return true;
+		}
+		else if (request != ServeRequest::Convert)
+			return false;
+
+		bool success = handle_serve_request(session);
+		if (!success)
+			session.payload.clear();
+
+		if (!write_serve_reply(stream, success, session.payload))
+			return false;
+	}
+}
+
+static bool run_serve_stdio()
+{
+#ifdef _WIN32
+	_setmode(_fileno(stdin), _O_BINARY);
+	_setmode(_fileno(stdout), _O_BINARY);
+#endif
+	StdioServeStream stream;
+	serve_stream(stream);
+	return true;
+}
+
+#ifndef _WIN32
+static volatile sig_atomic_t serve_signal_received;
+
+static void serve_signal_handler(int)
+{
+	serve_signal_received = 1;
+}
+
+// Tracks connection threads, so a shutdown can wait for them to finish the request they are handling.
+struct ServeConnections
+{
+	std::mutex lock;
+	std::condition_variable cond;
+	std::vector<int> fds;
+	unsigned num_active = 0;
+	int listen_fd = -1;
+	bool shutting_down = false;
+
+	void request_shutdown()
+	{
+		std::lock_guard<std::mutex> holder{ lock };
+		if (shutting_down)
+			return;
+		shutting_down = true;
+
+		// Wakes up accept(). Connections stop reading, but can still send the reply they are working on.
+		::shutdown(listen_fd, SHUT_RDWR);
+		for (int fd : fds)
+			::shutdown(fd, SHUT_RD);
+	}
+
+	// Must be called before fd is closed, so a shutdown never touches a reused descriptor.
+	void remove_fd(int fd)
+	{
+		std::lock_guard<std::mutex> holder{ lock };
+		fds.erase(std::find(fds.begin(), fds.end(), fd));
+	}
+
+	void end_connection()
+	{
+		std::lock_guard<std::mutex> holder{ lock };
+		num_active--;
+		cond.notify_all();
+	}
+
+	void wait_idle()
+	{
+		std::unique_lock<std::mutex> holder{ lock };
+		cond.wait(holder, [this]() { return num_active == 0; });
+	}
+};
+#endif
+
+static bool run_serve_socket(const std::string &path)
+{
+#ifdef _WIN32
+	LOGE("--serve-socket is not supported on this platform.\n");
+	return false;
+#else
+	sockaddr_un addr = {};
+	addr.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(addr.sun_path))
+	{
+		LOGE("Socket path %s is too long.\n", path.c_str());
+		return false;
+	}
+	memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+	int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listen_fd < 0)
+	{
+		LOGE("Failed to create socket.\n");
+		return false;
+	}
+
+	// Clean up a stale socket left behind by an earlier server, but never remove anything else.
+	struct stat st;
+	if (stat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+		unlink(path.c_str());
+
+	if (bind(listen_fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) < 0 || listen(listen_fd, 16) < 0)
+	{
+		LOGE("Failed to listen on %s.\n", path.c_str());
+		close(listen_fd);
+		return false;
+	}
+
+	// Clients going away should not kill the server.
+	signal(SIGPIPE, SIG_IGN);
+
+	// No SA_RESTART, so accept() returns with EINTR and we can observe the signal.
+	struct sigaction action = {};
+	action.sa_handler = serve_signal_handler;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGINT, &action, nullptr);
+	sigaction(SIGTERM, &action, nullptr);
+
+	// Connection threads block the signals, so they are always delivered to the accepting thread.
+	sigset_t stop_signals, old_signals;
+	sigemptyset(&stop_signals);
+	sigaddset(&stop_signals, SIGINT);
+	sigaddset(&stop_signals, SIGTERM);
+
+	ServeConnections connections;
+	connections.listen_fd = listen_fd;
+	bool success = true;
+
+	while (!serve_signal_received)
+	{
+		int fd = accept(listen_fd, nullptr, nullptr);
+		if (fd < 0)
+		{
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+
+			std::lock_guard<std::mutex> holder{ connections.lock };
+			if (!connections.shutting_down)
+			{
+				LOGE("Failed to accept connection.\n");
+				success = false;
+			}
+			break;
+		}
+
+		std::lock_guard<std::mutex> holder{ connections.lock };
+		if (connections.shutting_down)
+		{
+			close(fd);
+			break;
+		}
+
+		connections.fds.push_back(fd);
+		connections.num_active++;
+		pthread_sigmask(SIG_BLOCK, &stop_signals, &old_signals);
+		std::thread([fd, &connections]() {
+			bool shutdown_requested;
+			{
+				SocketServeStream stream(fd);
+				shutdown_requested = serve_stream(stream);
+				connections.remove_fd(fd);
+			}
+			if (shutdown_requested)
+				connections.request_shutdown();
+			connections.end_connection();
+		}).detach();
+		pthread_sigmask(SIG_SETMASK, &old_signals, nullptr);
+	}
+
+	connections.request_shutdown();
+	connections.wait_idle();
+
+	close(listen_fd);
+	unlink(path.c_str());
+	return success;
+#endif
+}
+
+int main(int argc, char **argv)
+{
+	Arguments args;
+	Remapper remapper;
+
+	CLICallbacks cbs;
+	register_conversion_options(cbs, args, remapper);
+	cbs.add("--help", [](CLIParser &parser) {
+		print_help();
+		parser.end();
+	});
+	cbs.add("--dump-module", [&](CLIParser &) { args.dump_module = true; });
+	cbs.add("--output", [&](CLIParser &parser) { args.output_path = parser.next_string(); });
+	cbs.add("--batch", [&](CLIParser &) { args.batch = true; });
+	cbs.add("--output-dir", [&](CLIParser &parser) { args.output_dir = parser.next_string(); });
+	cbs.add("--threads", [&](CLIParser &parser) { args.num_threads = parser.next_uint(); });
+	cbs.add("--queue-depth", [&](CLIParser &parser) { args.queue_depth = parser.next_uint(); });
+	cbs.add("--serve", [&](CLIParser &) { args.serve = true; });
+	cbs.add("--serve-socket", [&](CLIParser &parser) { args.serve_socket = parser.next_string(); });
+	cbs.error_handler = [] { print_help(); };
+	cbs.default_handler = [&](const char *arg) { args.input_path = arg; };
+	CLIParser cli_parser(std::move(cbs), argc - 1, argv + 1);
+	if (!cli_parser.parse())
+		return EXIT_FAILURE;
+	else if (cli_parser.is_ended_state())
+		return EXIT_SUCCESS;
+
+	if (!args.serve_socket.empty())
+		return run_serve_socket(args.serve_socket) ? EXIT_SUCCESS : EXIT_FAILURE;
+	else if (args.serve)
+		return run_serve_stdio() ? EXIT_SUCCESS : EXIT_FAILURE;
+
+	if (args.input_path.empty())
+	{
+		LOGE("No input file.\n");
+		print_help();
+		return EXIT_FAILURE;
+	}
+
+	if (args.batch)
+		return run_batch(args, remapper) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+	std::vector<uint32_t> spirv;
+	if (!convert_file(args, remapper, args.input_path, spirv, nullptr))
+		return EXIT_FAILURE;
+
+	std::string text;
+	if (!process_spirv(args, spirv, args.output_path.empty(), text))
+		return EXIT_FAILURE;
+
+	if (!write_output(args, args.output_path, spirv, text))
+		return EXIT_FAILURE;
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,573 @@
+/*
+ * Copyright 2019-2020 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "cli_parser.hpp"
+#include "dxil_spirv_c.h"
+#include "logging.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <dirent.h>
+#include <sys/resource.h>
+#endif
+
+using namespace dxil_spv;
+
+// Every heap allocation in the process, i.e. operator new and the arena allocation callbacks,
+// so the benchmark can report the malloc traffic of a conversion.
+static std::atomic<uint64_t> heap_allocation_count;
+
+void *operator new(size_t size)
+{
+	heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+	void *ptr = malloc(size ? size : 1);
+	if (!ptr)
+		abort();
+	return ptr;
+}
+
+void *operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+static void *counting_allocate(void *, size_t size, size_t)
+{
+	heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+	return malloc(size);
+}
+
+static void counting_free(void *, void *ptr)
+{
+	free(ptr);
+}
+
+static void print_help()
+{
+	LOGE("dxil-spirv-bench <directory of DXIL containers>\n"
+	     "\t[--iterations count]\n"
+	     "\t[--threads count]\n"
+	     "\t[--output file.json]\n"
+	     "\t[--reuse-context]\n"
+	     "The single-threaded run also reports heap allocations per conversion.\n");
+}
+
+static std::vector<uint8_t> read_file(const std::string &path)
+{
+	FILE *file = fopen(path.c_str(), "rb");
+	if (!file)
+		return {};
+
+	fseek(file, 0, SEEK_END);
+	auto len = ftell(file);
+	rewind(file);
+	std::vector<uint8_t> result(len);
+	if (fread(result.data(), 1, len, file) != size_t(len))
+	{
+		fclose(file);
+		return {};
+	}
+
+	fclose(file);
+	return result;
+}
+
+static bool list_directory(const std::string &dir, std::vector<std::string> &paths)
+{
+#ifdef _WIN32
+	WIN32_FIND_DATAA data;
+	HANDLE handle = FindFirstFileA((dir + "\\*").c_str(), &data);
+	if (handle == INVALID_HANDLE_VALUE)
+		return false;
+
+	do
+	{
+		if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+			paths.push_back(dir + "/" + data.cFileName);
+	} while (FindNextFileA(handle, &data));
+	FindClose(handle);
+#else
+	DIR *d = opendir(dir.c_str());
+	if (!d)
+		return false;
+
+	while (auto *entry = readdir(d))
+	{
+		if (entry->d_name[0] == '.')
+			continue;
+		paths.push_back(dir + "/" + entry->d_name);
+	}
+	closedir(d);
+#endif
+
+	std::sort(paths.begin(), paths.end());
+	return true;
+}
+
+static size_t get_peak_rss()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters = {};
+	if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return counters.PeakWorkingSetSize;
+	return 0;
+#else
+	struct rusage usage = {};
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#ifdef __APPLE__
+	return size_t(usage.ru_maxrss);
+#else
+	return size_t(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+struct Shader
+{
+	std::string path;
+	std::vector<uint8_t> data;
+	bool failed = false;
+	size_t spirv_size = 0;
+	// From an untimed conversion with statistics enabled.
+	unsigned num_ir_blocks = 0;
+	unsigned num_ir_block_visits = 0;
+
+	std::vector<double> single_thread_ms;
+	std::vector<double> multi_thread_ms;
+};
+
+// Runs the full parse, convert, structurize and emit chain once.
+// If context is not nullptr, memory from earlier conversions on the same thread is reused.
+// If stats is not nullptr, statistics are enabled, which adds timing overhead.
+static bool convert_shader(const Shader &shader, dxil_spv_converter_context context, size_t *spirv_size,
+                           dxil_spv_statistics *stats = nullptr)
+{
+	dxil_spv_parsed_blob blob;
+	if (dxil_spv_parse_dxil_blob(shader.data.data(), shader.data.size(), &blob) != DXIL_SPV_SUCCESS)
+		return false;
+
+	dxil_spv_converter converter;
+	dxil_spv_result result = context ? dxil_spv_create_converter_with_context(blob, context, &converter) :
+	                                   dxil_spv_create_converter(blob, &converter);
+	if (result != DXIL_SPV_SUCCESS)
+	{
+		dxil_spv_parsed_blob_free(blob);
+		return false;
+	}
+
+	if (stats)
+		dxil_spv_converter_enable_statistics(converter, DXIL_SPV_TRUE);
+
+	bool ret = dxil_spv_converter_run(converter) == DXIL_SPV_SUCCESS;
+	if (ret && stats)
+		ret = dxil_spv_converter_get_statistics(converter, stats) == DXIL_SPV_SUCCESS;
+	if (ret)
+	{
+		dxil_spv_compiled_spirv compiled;
+		ret = dxil_spv_converter_get_compiled_spirv(converter, &compiled) == DXIL_SPV_SUCCESS;
+		if (ret)
+			*spirv_size = compiled.size;
+	}
+
+	dxil_spv_converter_free(converter);
+	dxil_spv_parsed_blob_free(blob);
+	return ret;
+}
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+static double percentile(std::vector<double> values, double p)
+{
+	if (values.empty())
+		return 0.0;
+
+	std::sort(values.begin(), values.end());
+	size_t index = size_t(p * double(values.size() - 1) + 0.5);
+	return values[std::min(index, values.size() - 1)];
+}
+
+static std::string escape_json(const std::string &str)
+{
+	std::string ret;
+	for (char c : str)
+	{
+		if (c == '"' || c == '\\')
+		{
+			ret += '\\';
+			ret += c;
+		}
+		else if (static_cast<unsigned char>(c) < 0x20)
+		{
+			char escaped[8];
+			snprintf(escaped, sizeof(escaped), "\\u%04x", unsigned(static_cast<unsigned char>(c)));
+			ret += escaped;
+		}
+		else
+			ret += c;
+	}
+	return ret;
+}
+
+struct RunResult
+{
+	double wall_ms = 0.0;
+	std::vector<double> latencies_ms;
+	// Only measured single-threaded, since other threads would add their allocations.
+	double allocations_per_conversion = 0.0;
+};
+
+static dxil_spv_converter_context create_context(bool reuse_context)
+{
+	dxil_spv_converter_context context = nullptr;
+	if (reuse_context && dxil_spv_create_converter_context(&context) != DXIL_SPV_SUCCESS)
+		return nullptr;
+	return context;
+}
+
+static RunResult run_single_threaded(std::vector<Shader> &shaders, unsigned iterations, bool reuse_context)
+{
+	dxil_spv_converter_context context = create_context(reuse_context);
+	RunResult result;
+	auto start = std::chrono::steady_clock::now();
+	uint64_t allocation_count = heap_allocation_count.load(std::memory_order_relaxed);
+
+	for (auto &shader : shaders)
+	{
+		if (shader.failed)
+			continue;
+
+		for (unsigned i = 0; i < iterations; i++)
+		{
+			auto t0 = std::chrono::steady_clock::now();
+			if (!convert_shader(shader, context, &shader.spirv_size))
+			{
+				LOGE("Failed to convert %s.\n", shader.path.c_str());
+				shader.failed = true;
+				break;
+			}
+			auto t1 = std::chrono::steady_clock::now();
+			shader.single_thread_ms.push_back(elapsed_ms(t0, t1));
+		}
+
+		if (!shader.failed)
+			result.latencies_ms.insert(result.latencies_ms.end(), shader.single_thread_ms.begin(),
+			                           shader.single_thread_ms.end());
+	}
+
+	result.wall_ms = elapsed_ms(start, std::chrono::steady_clock::now());
+	if (!result.latencies_ms.empty())
+	{
+		uint64_t num_allocations = heap_allocation_count.load(std::memory_order_relaxed) - allocation_count;
+		result.allocations_per_conversion = double(num_allocations) / double(result.latencies_ms.size());
+	}
+	dxil_spv_converter_context_free(context);
+	return result;
+}
+
+static RunResult run_multi_threaded(std::vector<Shader> &shaders, unsigned iterations, unsigned num_threads,
+                                    bool reuse_context)
+{
+	struct Job
+	{
+		Shader *shader;
+		double ms;
+		bool failed;
+	};
+
+	std::vector<Job> jobs;
+	for (auto &shader : shaders)
+		if (!shader.failed)
+			for (unsigned i = 0; i < iterations; i++)
+				jobs.push_back({ &shader, 0.0, false });
+
+	// Each thread pulls jobs off a shared counter. Latencies are written into the job slot,
+	// so no locking is needed.
+	std::atomic<size_t> counter{ 0 };
+	auto worker = [&]() {
+		dxil_spv_converter_context context = create_context(reuse_context);
+		size_t index;
+		while ((index = counter.fetch_add(1, std::memory_order_relaxed)) < jobs.size())
+		{
+			auto &job = jobs[index];
+			size_t spirv_size = 0;
+			auto t0 = std::chrono::steady_clock::now();
+			job.failed = !convert_shader(*job.shader, context, &spirv_size);
+			job.ms = elapsed_ms(t0, std::chrono::steady_clock::now());
+		}
+		dxil_spv_converter_context_free(context);
+	};
+
+	RunResult result;
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::thread> threads;
+	for (unsigned i = 0; i < num_threads; i++)
+		threads.emplace_back(worker);
+	for (auto &thread : threads)
+		thread.join();
+
+	result.wall_ms = elapsed_ms(start, std::chrono::steady_clock::now());
+
+	// Failures are collected per shader after the threads are done, so a shader which fails on any
+	// thread is reported once and does not contribute latencies.
+	for (auto &job : jobs)
+	{
+		if (job.failed && !job.shader->failed)
+		{
+			LOGE("Failed to convert %s.\n", job.shader->path.c_str());
+			job.shader->failed = true;
+		}
+	}
+
+	for (auto &job : jobs)
+	{
+		if (job.shader->failed)
+			continue;
+		job.shader->multi_thread_ms.push_back(job.ms);
+		result.latencies_ms.push_back(job.ms);
+	}
+
+	return result;
+}
+
+static void print_run(FILE *file, const char *name, const RunResult &run, unsigned num_threads)
+{
+	double throughput = run.wall_ms > 0.0 ? 1000.0 * double(run.latencies_ms.size()) / run.wall_ms : 0.0;
+	fprintf(file, "\t\t\"%s\": {\n", name);
+	fprintf(file, "\t\t\t\"threads\": %u,\n", num_threads);
+	fprintf(file, "\t\t\t\"conversions\": %zu,\n", run.latencies_ms.size());
+	fprintf(file, "\t\t\t\"wall_ms\": %.3f,\n", run.wall_ms);
+	fprintf(file, "\t\t\t\"conversions_per_second\": %.3f,\n", throughput);
+	fprintf(file, "\t\t\t\"p50_ms\": %.3f,\n", percentile(run.latencies_ms, 0.50));
+	fprintf(file, "\t\t\t\"p99_ms\": %.3f", percentile(run.latencies_ms, 0.99));
+	if (run.allocations_per_conversion > 0.0)
+		fprintf(file, ",\n\t\t\t\"allocations_per_conversion\": %.1f", run.allocations_per_conversion);
+	fprintf(file, "\n\t\t}");
+}
+
+static void print_shader_latencies(FILE *file, const char *name, const std::vector<double> &latencies)
+{
+	double total = 0.0;
+	for (double ms : latencies)
+		total += ms;
+	double throughput = total > 0.0 ? 1000.0 * double(latencies.size()) / total : 0.0;
+
+	fprintf(file, "\t\t\t\"%s\": { \"conversions_per_second\": %.3f, \"p50_ms\": %.3f, \"p99_ms\": %.3f }", name,
+	        throughput, percentile(latencies, 0.50), percentile(latencies, 0.99));
+}
+
+static double get_ir_passes(uint64_t num_blocks, uint64_t num_visits)
+{
+	return num_blocks ? double(num_visits) / double(num_blocks) : 0.0;
+}
+
+static void print_report(FILE *file, const std::vector<Shader> &shaders, unsigned iterations,
+                         const RunResult &single, const RunResult &multi, unsigned num_threads)
+{
+	uint64_t total_ir_blocks = 0;
+	uint64_t total_ir_block_visits = 0;
+	for (auto &shader : shaders)
+	{
+		if (!shader.failed)
+		{
+			total_ir_blocks += shader.num_ir_blocks;
+			total_ir_block_visits += shader.num_ir_block_visits;
+		}
+	}
+
+	fprintf(file, "{\n");
+	fprintf(file, "\t\"iterations\": %u,\n", iterations);
+	fprintf(file, "\t\"peak_rss_bytes\": %zu,\n", get_peak_rss());
+	// Passes the converter makes over the IR of the whole corpus, weighted by block count.
+	fprintf(file, "\t\"ir_passes\": %.3f,\n", get_ir_passes(total_ir_blocks, total_ir_block_visits));
+	fprintf(file, "\t\"aggregate\": {\n");
+	print_run(file, "single_thread", single, 1);
+	fprintf(file, ",\n");
+	print_run(file, "multi_thread", multi, num_threads);
+	fprintf(file, "\n\t},\n");
+
+	fprintf(file, "\t\"shaders\": [\n");
+	for (size_t i = 0; i < shaders.size(); i++)
+	{
+		auto &shader = shaders[i];
+		fprintf(file, "\t\t{\n");
+		fprintf(file, "\t\t\t\"path\": \"%s\",\n", escape_json(shader.path).c_str());
+		fprintf(file, "\t\t\t\"dxil_bytes\": %zu,\n", shader.data.size());
+		if (shader.failed)
+			fprintf(file, "\t\t\t\"failed\": true\n");
+		else
+		{
+			fprintf(file, "\t\t\t\"spirv_bytes\": %zu,\n", shader.spirv_size);
+			fprintf(file, "\t\t\t\"ir_passes\": %.3f,\n",
+			        get_ir_passes(shader.num_ir_blocks, shader.num_ir_block_visits));
+			print_shader_latencies(file, "single_thread", shader.single_thread_ms);
+			fprintf(file, ",\n");
+			print_shader_latencies(file, "multi_thread", shader.multi_thread_ms);
+			fprintf(file, "\n");
+		}
+		fprintf(file, "\t\t}%s\n", i + 1 < shaders.size() ? "," : "");
+	}
+	fprintf(file, "\t]\n");
+	fprintf(file, "}\n");
+}
+
+int main(int argc, char **argv)
+{
+	std::string input, output;
+	unsigned iterations = 10;
+	unsigned num_threads = std::max(1u, std::thread::hardware_concurrency());
+	bool reuse_context = false;
+
+	CLICallbacks cbs;
+	cbs.add("--help", [](CLIParser &parser) {
+		print_help();
+		parser.end();
+	});
+	cbs.add("--iterations", [&](CLIParser &parser) { iterations = std::max(1u, parser.next_uint()); });
+	cbs.add("--threads", [&](CLIParser &parser) { num_threads = std::max(1u, parser.next_uint()); });
+	cbs.add("--output", [&](CLIParser &parser) { output = parser.next_string(); });
+	cbs.add("--reuse-context", [&](CLIParser &) { reuse_context = true; });
+	cbs.error_handler = [] { print_help(); };
+	cbs.default_handler = [&](const char *arg) { input = arg; };
+	CLIParser parser(std::move(cbs), argc - 1, argv + 1);
+
+	if (!parser.parse())
+		return EXIT_FAILURE;
+	else if (parser.is_ended_state())
+		return EXIT_SUCCESS;
+
+	if (input.empty())
+	{
+		LOGE("Need input directory.\n");
+		return EXIT_FAILURE;
+	}
+
+	std::vector<std::string> paths;
+	if (!list_directory(input, paths))
+	{
+		LOGE("Failed to list directory %s.\n", input.c_str());
+		return EXIT_FAILURE;
+	}
+
+	// Load everything up front, so file I/O is not part of the measurement.
+	std::vector<Shader> shaders;
+	for (auto &path : paths)
+	{
+		Shader shader;
+		shader.path = path;
+		shader.data = read_file(path);
+		if (shader.data.empty())
+		{
+			LOGE("Failed to read file %s.\n", path.c_str());
+			continue;
+		}
+		shaders.push_back(std::move(shader));
+	}
+
+	if (shaders.empty())
+	{
+		LOGE("No shaders found in %s.\n", input.c_str());
+		return EXIT_FAILURE;
+	}
+
+	// Collect pass counts up front, so statistics overhead stays out of the timed runs.
+	for (auto &shader : shaders)
+	{
+		dxil_spv_statistics stats = {};
+		if (!convert_shader(shader, nullptr, &shader.spirv_size, &stats))
+		{
+			LOGE("Failed to convert %s.\n", shader.path.c_str());
+			shader.failed = true;
+			continue;
+		}
+		shader.num_ir_blocks = stats.num_ir_blocks;
+		shader.num_ir_block_visits = stats.num_ir_block_visits;
+	}
+
+	const dxil_spv_allocation_callbacks callbacks = { counting_allocate, counting_free, nullptr };
+	dxil_spv_set_allocation_callbacks(&callbacks);
+
+	auto single = run_single_threaded(shaders, iterations, reuse_context);
+	auto multi = run_multi_threaded(shaders, iterations, num_threads, reuse_context);
+
+	FILE *file = stdout;
+	if (!output.empty())
+	{
+		file = fopen(output.c_str(), "w");
+		if (!file)
+		{
+			LOGE("Failed to open %s for writing.\n", output.c_str());
+			return EXIT_FAILURE;
+		}
+	}
+
+	print_report(file, shaders, iterations, single, multi, num_threads);
+
+	if (file != stdout)
+		fclose(file);
+
+	unsigned num_failed = 0;
+	for (auto &shader : shaders)
+		if (shader.failed)
+			num_failed++;
+
+	if (num_failed)
+	{
+		LOGE("%u of %u shaders failed to convert.\n", num_failed, unsigned(shaders.size()));
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -17,12 +17,23 @@
  */
 
 #include "dxil_spirv_c.h"
+#include "budget.hpp"
 #include "dxil_converter.hpp"
 #include "dxil_parser.hpp"
+#include "executor.hpp"
 #include "llvm_bitcode_parser.hpp"
 #include "logging.hpp"
+#include "memory_allocator.hpp"
+#include "node_pool.hpp"
 #include "spirv_module.hpp"
+#include "statistics.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <new>
+#include <thread>
+#include <unordered_map>
 
 using namespace dxil_spv;
 
@@ -38,6 +49,77 @@ struct dxil_spv_parsed_blob_s
 	LLVMBCParser bc;
 	std::string disasm;
 	std::vector<uint8_t> dxil_blob;
+	std::vector<std::string> entry_points;
+	LibraryAnalysis library_analysis;
+	uint64_t parse_time_ns = 0;
+};
+
+struct dxil_spv_root_signature_s
+{
+	DXILRootSignatureParser parser;
+};
+
+struct RemappingTableKey
+{
+	uint32_t stage_and_class;
+	uint32_t register_space;
+	uint32_t register_index;
+
+	bool operator==(const RemappingTableKey &other) const
+	{
+		return stage_and_class == other.stage_and_class && register_space == other.register_space &&
+		       register_index == other.register_index;
+	}
+};
+
+struct RemappingTableKeyHasher
+{
+	size_t operator()(const RemappingTableKey &key) const
+	{
+		// FNV-1a over the three words.
+		uint64_t h = 0xcbf29ce484222325ull;
+		h = (h ^ key.stage_and_class) * 0x100000001b3ull;
+		h = (h ^ key.register_space) * 0x100000001b3ull;
+		h = (h ^ key.register_index) * 0x100000001b3ull;
+		return size_t(h ^ (h >> 32));
+	}
+};
+
+struct RemappingTableEntry
+{
+	VulkanBinding buffer;
+	VulkanBinding counter;
+	unsigned push_offset_in_words;
+	bool push_constant;
+};
+
+struct dxil_spv_remapping_table_s
+{
+	std::unordered_map<RemappingTableKey, RemappingTableEntry, RemappingTableKeyHasher> entries;
+
+	static RemappingTableKey make_key(dxil_spv_shader_stage stage, DXIL::ResourceType type, unsigned register_space,
+	                                  unsigned register_index)
+	{
+		return { (uint32_t(stage) << 2) | uint32_t(type), register_space, register_index };
+	}
+
+	const RemappingTableEntry *find(dxil_spv_shader_stage stage, DXIL::ResourceType type, unsigned register_space,
+	                                unsigned register_index) const
+	{
+		auto itr = entries.find(make_key(stage, type, register_space, register_index));
+
+		// Entries for DXIL_SPV_STAGE_UNKNOWN apply to every stage.
+		if (itr == entries.end() && stage != DXIL_SPV_STAGE_UNKNOWN)
+			itr = entries.find(make_key(DXIL_SPV_STAGE_UNKNOWN, type, register_space, register_index));
+
+		return itr != entries.end() ? &itr->second : nullptr;
+	}
+
+	const RemappingTableEntry *find(DXIL::ResourceType type, const D3DBinding &binding) const
+	{
+		return find(static_cast<dxil_spv_shader_stage>(binding.stage), type, binding.register_space,
+		            binding.register_index);
+	}
 };
 
 struct Remapper : ResourceRemappingInterface
@@ -51,8 +133,87 @@ struct Remapper : ResourceRemappingInterface
 		vk_binding.bindless.root_constant_word = c_vk_binding.bindless.root_constant_word;
 	}
 
+	static void copy_c_buffer_binding(dxil_spv_vulkan_binding &c_vk_binding, const VulkanBinding &vk_binding)
+	{
+		c_vk_binding.set = vk_binding.descriptor_set;
+		c_vk_binding.binding = vk_binding.binding;
+		c_vk_binding.bindless.use_heap = vk_binding.bindless.use_heap ? DXIL_SPV_TRUE : DXIL_SPV_FALSE;
+		c_vk_binding.bindless.heap_root_offset = vk_binding.bindless.heap_root_offset;
+		c_vk_binding.bindless.root_constant_word = vk_binding.bindless.root_constant_word;
+	}
+
+	const RootSignatureBinding *find_root_signature_binding(DXIL::ResourceType type, const D3DBinding &binding) const
+	{
+		// Compute shaders can only see parameters which are visible to all stages.
+		auto visibility = DXIL::ShaderVisibility::All;
+		if (binding.stage >= ShaderStage::Vertex && binding.stage <= ShaderStage::Pixel)
+			visibility = static_cast<DXIL::ShaderVisibility>(binding.stage);
+
+		auto *rs_binding = root_signature->parser.find_binding(type, visibility, binding.register_space,
+		                                                       binding.register_index, binding.range_size);
+		if (!rs_binding)
+		{
+			LOGE("Resource (space %u, register %u) is not covered by the root signature.\n", binding.register_space,
+			     binding.register_index);
+		}
+		return rs_binding;
+	}
+
+	void copy_root_signature_binding(VulkanBinding &vk_binding, const dxil_spv_descriptor_binding &heap,
+	                                 const RootSignatureBinding &rs_binding, const D3DBinding &binding) const
+	{
+		vk_binding = {};
+		switch (rs_binding.type)
+		{
+		case RootSignatureBindingType::DescriptorTable:
+			vk_binding.descriptor_set = heap.set;
+			vk_binding.binding = heap.binding;
+			vk_binding.bindless.use_heap = true;
+			vk_binding.bindless.root_constant_word = rs_binding.root_constant_word;
+			vk_binding.bindless.heap_root_offset =
+			    rs_binding.offset_in_table + (binding.register_index - rs_binding.base_register);
+			break;
+
+		case RootSignatureBindingType::RootDescriptor:
+			vk_binding.descriptor_set = root_signature_layout.root_descriptor_set;
+			vk_binding.binding = rs_binding.parameter_index;
+			break;
+
+		case RootSignatureBindingType::StaticSampler:
+			vk_binding.descriptor_set = root_signature_layout.static_sampler_set;
+			vk_binding.binding = rs_binding.parameter_index;
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	bool remap_root_signature(DXIL::ResourceType type, const D3DBinding &binding, VulkanBinding &vk_binding) const
+	{
+		auto *rs_binding = find_root_signature_binding(type, binding);
+		if (!rs_binding)
+			return false;
+		copy_root_signature_binding(vk_binding, root_signature_layout.heaps[unsigned(type)], *rs_binding, binding);
+		return true;
+	}
+
+	bool remap_from_table(DXIL::ResourceType type, const D3DBinding &binding, VulkanBinding &vk_binding) const
+	{
+		auto *entry = remapping_table->find(type, binding);
+		if (!entry)
+			return false;
+		vk_binding = entry->buffer;
+		return true;
+	}
+
 	bool remap_srv(const D3DBinding &binding, VulkanBinding &vk_binding) override
 	{
+		if (root_signature)
+			return remap_root_signature(DXIL::ResourceType::SRV, binding, vk_binding);
+		if (remapping_table && remap_from_table(DXIL::ResourceType::SRV, binding, vk_binding))
+			return true;
+
 		if (srv_remapper)
 		{
 			const dxil_spv_d3d_binding c_binding = { static_cast<dxil_spv_shader_stage>(binding.stage),
@@ -82,6 +243,11 @@ struct Remapper : ResourceRemappingInterface
 
 	bool remap_sampler(const D3DBinding &binding, VulkanBinding &vk_binding) override
 	{
+		if (root_signature)
+			return remap_root_signature(DXIL::ResourceType::Sampler, binding, vk_binding);
+		if (remapping_table && remap_from_table(DXIL::ResourceType::Sampler, binding, vk_binding))
+			return true;
+
 		if (sampler_remapper)
 		{
 			const dxil_spv_d3d_binding c_binding = { static_cast<dxil_spv_shader_stage>(binding.stage),
@@ -111,6 +277,44 @@ struct Remapper : ResourceRemappingInterface
 
 	bool remap_uav(const D3DUAVBinding &binding, VulkanUAVBinding &vk_binding) override
 	{
+		if (root_signature)
+		{
+			auto *rs_binding = find_root_signature_binding(DXIL::ResourceType::UAV, binding.binding);
+			if (!rs_binding)
+				return false;
+
+			copy_root_signature_binding(vk_binding.buffer_binding,
+			                            root_signature_layout.heaps[unsigned(DXIL::ResourceType::UAV)], *rs_binding,
+			                            binding.binding);
+
+			// Root descriptors have no counter in D3D12, so only descriptor tables get a counter binding.
+			// Otherwise, the counter is left unbound rather than aliasing the buffer's binding.
+			if (rs_binding->type == RootSignatureBindingType::DescriptorTable)
+			{
+				copy_root_signature_binding(vk_binding.counter_binding, root_signature_layout.uav_counter_heap,
+				                            *rs_binding, binding.binding);
+			}
+			else if (binding.counter)
+			{
+				LOGE("UAV (space %u, register %u) uses a counter, but root descriptors cannot have counters.\n",
+				     binding.binding.register_space, binding.binding.register_index);
+				return false;
+			}
+			else
+				vk_binding.counter_binding = {};
+			return true;
+		}
+
+		if (remapping_table)
+		{
+			if (auto *entry = remapping_table->find(DXIL::ResourceType::UAV, binding.binding))
+			{
+				vk_binding.buffer_binding = entry->buffer;
+				vk_binding.counter_binding = entry->counter;
+				return true;
+			}
+		}
+
 		if (uav_remapper)
 		{
 			const dxil_spv_uav_d3d_binding c_binding = {
@@ -144,6 +348,37 @@ struct Remapper : ResourceRemappingInterface
 
 	bool remap_cbv(const D3DBinding &binding, VulkanCBVBinding &vk_binding) override
 	{
+		if (root_signature)
+		{
+			auto *rs_binding = find_root_signature_binding(DXIL::ResourceType::CBV, binding);
+			if (!rs_binding)
+				return false;
+
+			vk_binding.push_constant = rs_binding->type == RootSignatureBindingType::RootConstants;
+			if (vk_binding.push_constant)
+				vk_binding.push.offset_in_words = rs_binding->root_constant_word;
+			else
+			{
+				copy_root_signature_binding(vk_binding.buffer,
+				                            root_signature_layout.heaps[unsigned(DXIL::ResourceType::CBV)],
+				                            *rs_binding, binding);
+			}
+			return true;
+		}
+
+		if (remapping_table)
+		{
+			if (auto *entry = remapping_table->find(DXIL::ResourceType::CBV, binding))
+			{
+				vk_binding.push_constant = entry->push_constant;
+				if (vk_binding.push_constant)
+					vk_binding.push.offset_in_words = entry->push_offset_in_words;
+				else
+					vk_binding.buffer = entry->buffer;
+				return true;
+			}
+		}
+
 		if (cbv_remapper)
 		{
 			const dxil_spv_d3d_binding c_binding = { static_cast<dxil_spv_shader_stage>(binding.stage),
@@ -224,7 +459,10 @@ struct Remapper : ResourceRemappingInterface
 
 	unsigned get_root_constant_word_count() override
 	{
-		return root_constant_word_count;
+		if (root_signature)
+			return root_signature->parser.get_root_constant_word_count();
+		else
+			return root_constant_word_count;
 	}
 
 	dxil_spv_srv_sampler_remapper_cb srv_remapper = nullptr;
@@ -246,57 +484,528 @@ struct Remapper : ResourceRemappingInterface
 	void *output_userdata = nullptr;
 
 	unsigned root_constant_word_count = 0;
+
+	const dxil_spv_root_signature_s *root_signature = nullptr;
+	dxil_spv_root_signature_layout root_signature_layout = {};
+
+	const dxil_spv_remapping_table_s *remapping_table = nullptr;
+};
+
+struct dxil_spv_converter_context_s
+{
+	SPIRVModule module;
+	std::unique_ptr<CFGNodePool> node_pool;
+	std::vector<uint32_t> spirv;
+	bool in_use = false;
 };
 
 struct dxil_spv_converter_s
 {
-	explicit dxil_spv_converter_s(LLVMBCParser &bc_parser)
-	    : converter(bc_parser, module)
+	dxil_spv_converter_s(LLVMBCParser &bc_parser_, SPIRVModule &module_)
+	    : bc_parser(bc_parser_)
+	    , module(module_)
+	    , converter(bc_parser_, module_)
 	{
 	}
-	SPIRVModule module;
+	LLVMBCParser &bc_parser;
+	SPIRVModule &module;
+	std::unique_ptr<SPIRVModule> owned_module;
+	dxil_spv_converter_context context = nullptr;
 	Converter converter;
 	std::vector<uint32_t> spirv;
 	Remapper remapper;
+	std::unique_ptr<Statistics> statistics;
+	uint64_t parse_time_ns = 0;
+	AllocationCallbacks allocation_callbacks = {};
+	bool has_allocation_callbacks = false;
+	Budget budget;
+	bool has_budget = false;
+	ExecutorPriority priority = ExecutorPriority::Interactive;
 };
 
-dxil_spv_result dxil_spv_parse_dxil_blob(const void *data, size_t size, dxil_spv_parsed_blob *blob)
+static Budget convert_budget(const dxil_spv_budget &budget)
 {
-	auto *parsed = new (std::nothrow) dxil_spv_parsed_blob_s;
-	if (!parsed)
-		return DXIL_SPV_ERROR_OUT_OF_MEMORY;
+	Budget result;
+	result.max_nodes = budget.max_nodes;
+	result.max_operations = budget.max_operations;
+	result.max_arena_bytes = budget.max_arena_bytes;
+	result.max_time_ns = uint64_t(budget.max_time_us) * 1000;
+	return result;
+}
 
-	DXILContainerParser parser;
-	if (!parser.parse_container(data, size))
+dxil_spv_result dxil_spv_index_dxil_container(const void *data, size_t size, dxil_spv_container_part *parts,
+                                              unsigned *part_count)
+{
+	DXILContainerIndex index;
+	if (!index.index_container(data, size))
+		return DXIL_SPV_ERROR_PARSER;
+
+	unsigned count = index.get_part_count();
+	if (parts)
 	{
-		delete parsed;
+		if (*part_count < count)
+		{
+			*part_count = count;
+			return DXIL_SPV_ERROR_GENERIC;
+		}
+
+		for (unsigned i = 0; i < count; i++)
+		{
+			auto part = index.get_part(i);
+			parts[i].fourcc = unsigned(part.fourcc);
+			parts[i].offset = part.offset;
+			parts[i].size = part.size;
+		}
+	}
+
+	*part_count = count;
+	return DXIL_SPV_SUCCESS;
+}
+
+dxil_spv_result dxil_spv_find_dxil_bitcode(const void *data, size_t size, const void **bitcode, size_t *bitcode_size)
+{
+	DXILContainerIndex index;
+	if (!index.index_container(data, size))
+		return DXIL_SPV_ERROR_PARSER;
+
+	const uint8_t *code;
+	if (!index.find_dxil_bitcode(&code, bitcode_size))
 		return DXIL_SPV_ERROR_PARSER;
+
+	*bitcode = code;
+	return DXIL_SPV_SUCCESS;
+}
+
+static bool parse_psv(const void *data, size_t size, DXILContainerIndex &index, DXILPSVParser &psv)
+{
+	return index.index_container(data, size) && psv.parse(index);
+}
+
+dxil_spv_result dxil_spv_psv_get_shader_stage(const void *data, size_t size, dxil_spv_shader_stage *stage)
+{
+	DXILContainerIndex index;
+	DXILPSVParser psv;
+	if (!parse_psv(data, size, index, psv))
+		return DXIL_SPV_ERROR_PARSER;
+
+	switch (psv.get_shader_kind())
+	{
+	case DXIL::ShaderKind::Vertex:
+		*stage = DXIL_SPV_STAGE_VERTEX;
+		break;
+	case DXIL::ShaderKind::Hull:
+		*stage = DXIL_SPV_STAGE_HULL;
+		break;
+	case DXIL::ShaderKind::Domain:
+		*stage = DXIL_SPV_STAGE_DOMAIN;
+		break;
+	case DXIL::ShaderKind::Geometry:
+		*stage = DXIL_SPV_STAGE_GEOMETRY;
+		break;
+	case DXIL::ShaderKind::Pixel:
+		*stage = DXIL_SPV_STAGE_PIXEL;
+		break;
+	case DXIL::ShaderKind::Compute:
+		*stage = DXIL_SPV_STAGE_COMPUTE;
+		break;
+	case DXIL::ShaderKind::Invalid:
+		return DXIL_SPV_ERROR_UNSUPPORTED_FEATURE;
+	default:
+		*stage = DXIL_SPV_STAGE_UNKNOWN;
+		break;
 	}
 
-	parsed->dxil_blob = std::move(parser.get_blob());
+	return DXIL_SPV_SUCCESS;
+}
+
+static void convert_psv_resource_binding(const DXIL::PSVResourceBindInfo1 &info,
+                                         dxil_spv_psv_resource_binding &binding)
+{
+	binding = {};
+	binding.register_space = info.space;
+	binding.register_index = info.lower_bound;
+	binding.range_size = info.upper_bound == ~0u ? ~0u : info.upper_bound - info.lower_bound + 1;
+	binding.kind = static_cast<dxil_spv_resource_kind>(info.resource_kind);
 
-	if (!parsed->bc.parse(parsed->dxil_blob.data(), parsed->dxil_blob.size()))
+	switch (info.resource_type)
 	{
-		delete parsed;
+	case DXIL::PSVResourceType::Sampler:
+		binding.resource_class = DXIL_SPV_RESOURCE_CLASS_SAMPLER;
+		binding.kind = DXIL_SPV_RESOURCE_KIND_SAMPLER;
+		break;
+
+	case DXIL::PSVResourceType::CBV:
+		binding.resource_class = DXIL_SPV_RESOURCE_CLASS_CBV;
+		binding.kind = DXIL_SPV_RESOURCE_KIND_CONSTANT_BUFFER;
+		break;
+
+	case DXIL::PSVResourceType::SRVTyped:
+		binding.resource_class = DXIL_SPV_RESOURCE_CLASS_SRV;
+		break;
+
+	case DXIL::PSVResourceType::SRVRaw:
+		binding.resource_class = DXIL_SPV_RESOURCE_CLASS_SRV;
+		binding.kind = DXIL_SPV_RESOURCE_KIND_RAW_BUFFER;
+		break;
+
+	case DXIL::PSVResourceType::SRVStructured:
+		binding.resource_class = DXIL_SPV_RESOURCE_CLASS_SRV;
+		// Acceleration structures are also structured SRVs.
+		if (binding.kind != DXIL_SPV_RESOURCE_KIND_RT_ACCELERATION_STRUCTURE)
+			binding.kind = DXIL_SPV_RESOURCE_KIND_STRUCTURED_BUFFER;
+		break;
+
+	case DXIL::PSVResourceType::UAVTyped:
+		binding.resource_class = DXIL_SPV_RESOURCE_CLASS_UAV;
+		break;
+
+	case DXIL::PSVResourceType::UAVRaw:
+		binding.resource_class = DXIL_SPV_RESOURCE_CLASS_UAV;
+		binding.kind = DXIL_SPV_RESOURCE_KIND_RAW_BUFFER;
+		break;
+
+	case DXIL::PSVResourceType::UAVStructured:
+	case DXIL::PSVResourceType::UAVStructuredWithCounter:
+		binding.resource_class = DXIL_SPV_RESOURCE_CLASS_UAV;
+		binding.kind = DXIL_SPV_RESOURCE_KIND_STRUCTURED_BUFFER;
+		binding.has_counter = info.resource_type == DXIL::PSVResourceType::UAVStructuredWithCounter;
+		break;
+
+	default:
+		break;
+	}
+}
+
+dxil_spv_result dxil_spv_psv_get_resource_bindings(const void *data, size_t size,
+                                                   dxil_spv_psv_resource_binding *bindings, unsigned *binding_count)
+{
+	DXILContainerIndex index;
+	DXILPSVParser psv;
+	if (!parse_psv(data, size, index, psv))
 		return DXIL_SPV_ERROR_PARSER;
+
+	unsigned count = psv.get_resource_count();
+	if (bindings)
+	{
+		if (*binding_count < count)
+		{
+			*binding_count = count;
+			return DXIL_SPV_ERROR_GENERIC;
+		}
+
+		for (unsigned i = 0; i < count; i++)
+		{
+			DXIL::PSVResourceBindInfo1 info;
+			if (!psv.get_resource(i, info))
+				return DXIL_SPV_ERROR_PARSER;
+			convert_psv_resource_binding(info, bindings[i]);
+		}
 	}
 
-	*blob = parsed;
+	*binding_count = count;
 	return DXIL_SPV_SUCCESS;
 }
 
+dxil_spv_result dxil_spv_psv_get_signature_elements(const void *data, size_t size, dxil_spv_psv_signature signature,
+                                                    dxil_spv_psv_signature_element *elements,
+                                                    unsigned *element_count)
+{
+	if (unsigned(signature) >= unsigned(DXIL::PSVSignature::Count))
+		return DXIL_SPV_ERROR_GENERIC;
+
+	DXILContainerIndex index;
+	DXILPSVParser psv;
+	if (!parse_psv(data, size, index, psv))
+		return DXIL_SPV_ERROR_PARSER;
+
+	auto psv_signature = static_cast<DXIL::PSVSignature>(signature);
+	unsigned count = psv.get_signature_element_count(psv_signature);
+	if (elements)
+	{
+		if (*element_count < count)
+		{
+			*element_count = count;
+			return DXIL_SPV_ERROR_GENERIC;
+		}
+
+		for (unsigned i = 0; i < count; i++)
+		{
+			DXIL::PSVSignatureElement0 element;
+			auto &out = elements[i];
+			if (!psv.get_signature_element(psv_signature, i, element, &out.semantic, &out.semantic_index))
+				return DXIL_SPV_ERROR_PARSER;
+
+			out.start_row = element.start_row;
+			out.rows = element.rows;
+			out.start_col = (element.cols_and_start >> 4) & 3;
+			out.cols = element.cols_and_start & 0xf;
+			out.system_value_semantic = element.semantic_kind;
+			out.component_type = element.component_type;
+			out.interpolation_mode = element.interpolation_mode;
+			out.stream = (element.dynamic_mask_and_stream >> 4) & 3;
+		}
+	}
+
+	*element_count = count;
+	return DXIL_SPV_SUCCESS;
+}
+
+dxil_spv_result dxil_spv_parse_root_signature(const void *data, size_t size, dxil_spv_root_signature *root_signature)
+{
+	DXILContainerIndex index;
+	if (!index.index_container(data, size))
+		return DXIL_SPV_ERROR_PARSER;
+
+	auto *rs = new (std::nothrow) dxil_spv_root_signature_s;
+	if (!rs)
+		return DXIL_SPV_ERROR_OUT_OF_MEMORY;
+
+	if (!rs->parser.parse(index))
+	{
+		delete rs;
+		return DXIL_SPV_ERROR_PARSER;
+	}
+
+	*root_signature = rs;
+	return DXIL_SPV_SUCCESS;
+}
+
+void dxil_spv_root_signature_free(dxil_spv_root_signature root_signature)
+{
+	delete root_signature;
+}
+
+unsigned dxil_spv_root_signature_get_root_constant_word_count(dxil_spv_root_signature root_signature)
+{
+	return root_signature->parser.get_root_constant_word_count();
+}
+
+dxil_spv_result dxil_spv_root_signature_get_bindings(dxil_spv_root_signature root_signature,
+                                                     dxil_spv_root_signature_binding *bindings,
+                                                     unsigned *binding_count)
+{
+	auto &rs_bindings = root_signature->parser.get_bindings();
+	unsigned count = unsigned(rs_bindings.size());
+
+	if (bindings)
+	{
+		if (*binding_count < count)
+		{
+			*binding_count = count;
+			return DXIL_SPV_ERROR_GENERIC;
+		}
+
+		for (unsigned i = 0; i < count; i++)
+		{
+			auto &rs_binding = rs_bindings[i];
+			auto &binding = bindings[i];
+			binding.type = static_cast<dxil_spv_root_signature_binding_type>(rs_binding.type);
+			binding.resource_class = static_cast<dxil_spv_resource_class>(rs_binding.resource_type);
+			binding.visibility = unsigned(rs_binding.visibility);
+			binding.register_space = rs_binding.register_space;
+			binding.register_index = rs_binding.base_register;
+			binding.num_descriptors = rs_binding.num_descriptors;
+			binding.parameter_index = rs_binding.parameter_index;
+			binding.root_constant_word = rs_binding.root_constant_word;
+			binding.offset_in_table = rs_binding.offset_in_table;
+		}
+	}
+
+	*binding_count = count;
+	return DXIL_SPV_SUCCESS;
+}
+
+dxil_spv_result dxil_spv_create_remapping_table(dxil_spv_remapping_table *table)
+{
+	auto *t = new (std::nothrow) dxil_spv_remapping_table_s;
+	if (!t)
+		return DXIL_SPV_ERROR_OUT_OF_MEMORY;
+	*table = t;
+	return DXIL_SPV_SUCCESS;
+}
+
+void dxil_spv_remapping_table_free(dxil_spv_remapping_table table)
+{
+	delete table;
+}
+
+void dxil_spv_remapping_table_reserve(dxil_spv_remapping_table table, unsigned num_entries)
+{
+	table->entries.reserve(num_entries);
+}
+
+void dxil_spv_remapping_table_add_srv(dxil_spv_remapping_table table, dxil_spv_shader_stage stage,
+                                      unsigned register_space, unsigned register_index,
+                                      const dxil_spv_vulkan_binding *binding)
+{
+	RemappingTableEntry entry = {};
+	Remapper::copy_buffer_binding(entry.buffer, *binding);
+	table->entries[dxil_spv_remapping_table_s::make_key(stage, DXIL::ResourceType::SRV, register_space,
+	                                                    register_index)] = entry;
+}
+
+void dxil_spv_remapping_table_add_sampler(dxil_spv_remapping_table table, dxil_spv_shader_stage stage,
+                                          unsigned register_space, unsigned register_index,
+                                          const dxil_spv_vulkan_binding *binding)
+{
+	RemappingTableEntry entry = {};
+	Remapper::copy_buffer_binding(entry.buffer, *binding);
+	table->entries[dxil_spv_remapping_table_s::make_key(stage, DXIL::ResourceType::Sampler, register_space,
+	                                                    register_index)] = entry;
+}
+
+void dxil_spv_remapping_table_add_uav(dxil_spv_remapping_table table, dxil_spv_shader_stage stage,
+                                      unsigned register_space, unsigned register_index,
+                                      const dxil_spv_uav_vulkan_binding *binding)
+{
+	RemappingTableEntry entry = {};
+	Remapper::copy_buffer_binding(entry.buffer, binding->buffer_binding);
+	Remapper::copy_buffer_binding(entry.counter, binding->counter_binding);
+	table->entries[dxil_spv_remapping_table_s::make_key(stage, DXIL::ResourceType::UAV, register_space,
+	                                                    register_index)] = entry;
+}
+
+void dxil_spv_remapping_table_add_cbv(dxil_spv_remapping_table table, dxil_spv_shader_stage stage,
+                                      unsigned register_space, unsigned register_index,
+                                      const dxil_spv_cbv_vulkan_binding *binding)
+{
+	RemappingTableEntry entry = {};
+	entry.push_constant = bool(binding->push_constant);
+	if (entry.push_constant)
+		entry.push_offset_in_words = binding->vulkan.push_constant.offset_in_words;
+	else
+		Remapper::copy_buffer_binding(entry.buffer, binding->vulkan.uniform_binding);
+	table->entries[dxil_spv_remapping_table_s::make_key(stage, DXIL::ResourceType::CBV, register_space,
+	                                                    register_index)] = entry;
+}
+
+dxil_spv_bool dxil_spv_remapping_table_find_srv(dxil_spv_remapping_table table, dxil_spv_shader_stage stage,
+                                                unsigned register_space, unsigned register_index,
+                                                dxil_spv_vulkan_binding *binding)
+{
+	auto *entry = table->find(stage, DXIL::ResourceType::SRV, register_space, register_index);
+	if (!entry)
+		return DXIL_SPV_FALSE;
+	Remapper::copy_c_buffer_binding(*binding, entry->buffer);
+	return DXIL_SPV_TRUE;
+}
+
+dxil_spv_bool dxil_spv_remapping_table_find_sampler(dxil_spv_remapping_table table, dxil_spv_shader_stage stage,
+                                                    unsigned register_space, unsigned register_index,
+                                                    dxil_spv_vulkan_binding *binding)
+{
+	auto *entry = table->find(stage, DXIL::ResourceType::Sampler, register_space, register_index);
+	if (!entry)
+		return DXIL_SPV_FALSE;
+	Remapper::copy_c_buffer_binding(*binding, entry->buffer);
+	return DXIL_SPV_TRUE;
+}
+
+dxil_spv_bool dxil_spv_remapping_table_find_uav(dxil_spv_remapping_table table, dxil_spv_shader_stage stage,
+                                                unsigned register_space, unsigned register_index,
+                                                dxil_spv_uav_vulkan_binding *binding)
+{
+	auto *entry = table->find(stage, DXIL::ResourceType::UAV, register_space, register_index);
+	if (!entry)
+		return DXIL_SPV_FALSE;
+	Remapper::copy_c_buffer_binding(binding->buffer_binding, entry->buffer);
+	Remapper::copy_c_buffer_binding(binding->counter_binding, entry->counter);
+	return DXIL_SPV_TRUE;
+}
+
+dxil_spv_bool dxil_spv_remapping_table_find_cbv(dxil_spv_remapping_table table, dxil_spv_shader_stage stage,
+                                                unsigned register_space, unsigned register_index,
+                                                dxil_spv_cbv_vulkan_binding *binding)
+{
+	auto *entry = table->find(stage, DXIL::ResourceType::CBV, register_space, register_index);
+	if (!entry)
+		return DXIL_SPV_FALSE;
+
+	*binding = {};
+	binding->push_constant = entry->push_constant ? DXIL_SPV_TRUE : DXIL_SPV_FALSE;
+	if (entry->push_constant)
+		binding->vulkan.push_constant.offset_in_words = entry->push_offset_in_words;
+	else
+		Remapper::copy_c_buffer_binding(binding->vulkan.uniform_binding, entry->buffer);
+	return DXIL_SPV_TRUE;
+}
+
+dxil_spv_result dxil_spv_parse_dxil_blob(const void *data, size_t size, dxil_spv_parsed_blob *blob)
+{
+	return dxil_spv_parse_dxil_blob_with_budget(data, size, nullptr, blob);
+}
+
 dxil_spv_result dxil_spv_parse_dxil(const void *data, size_t size, dxil_spv_parsed_blob *blob)
+{
+	return dxil_spv_parse_dxil_with_budget(data, size, nullptr, blob);
+}
+
+static dxil_spv_result parse_bitcode(dxil_spv_parsed_blob parsed, const void *data, size_t size,
+                                     const dxil_spv_budget *budget)
+{
+	BudgetTracker tracker(budget ? convert_budget(*budget) : Budget{});
+	if (!parsed->bc.parse(data, size, budget ? &tracker : nullptr))
+		return tracker.is_exceeded() ? DXIL_SPV_ERROR_BUDGET_EXCEEDED : DXIL_SPV_ERROR_PARSER;
+	else
+		return DXIL_SPV_SUCCESS;
+}
+
+dxil_spv_result dxil_spv_parse_dxil_blob_with_budget(const void *data, size_t size, const dxil_spv_budget *budget,
+                                                     dxil_spv_parsed_blob *blob)
 {
 	auto *parsed = new (std::nothrow) dxil_spv_parsed_blob_s;
 	if (!parsed)
 		return DXIL_SPV_ERROR_OUT_OF_MEMORY;
 
-	if (!parsed->bc.parse(data, size))
+	Statistics stats;
 	{
-		delete parsed;
-		return DXIL_SPV_ERROR_PARSER;
+		ScopedPhaseTimer timer(&stats, StatisticsPhase::Parse);
+
+		DXILContainerParser parser;
+		if (!parser.parse_container(data, size))
+		{
+			delete parsed;
+			return DXIL_SPV_ERROR_PARSER;
+		}
+
+		parsed->dxil_blob = std::move(parser.get_blob());
+
+		dxil_spv_result result = parse_bitcode(parsed, parsed->dxil_blob.data(), parsed->dxil_blob.size(), budget);
+		if (result != DXIL_SPV_SUCCESS)
+		{
+			delete parsed;
+			return result;
+		}
+	}
+
+	Converter::get_entry_points(parsed->bc, parsed->entry_points);
+	Converter::analyze_library(parsed->bc, parsed->library_analysis);
+	parsed->parse_time_ns = stats.phase_time_ns[unsigned(StatisticsPhase::Parse)];
+	*blob = parsed;
+	return DXIL_SPV_SUCCESS;
+}
+
+dxil_spv_result dxil_spv_parse_dxil_with_budget(const void *data, size_t size, const dxil_spv_budget *budget,
+                                                dxil_spv_parsed_blob *blob)
+{
+	auto *parsed = new (std::nothrow) dxil_spv_parsed_blob_s;
+	if (!parsed)
+		return DXIL_SPV_ERROR_OUT_OF_MEMORY;
+
+	Statistics stats;
+	{
+		ScopedPhaseTimer timer(&stats, StatisticsPhase::Parse);
+		dxil_spv_result result = parse_bitcode(parsed, data, size, budget);
+		if (result != DXIL_SPV_SUCCESS)
+		{
+			delete parsed;
+			return result;
+		}
 	}
 
+	Converter::get_entry_points(parsed->bc, parsed->entry_points);
+	Converter::analyze_library(parsed->bc, parsed->library_analysis);
+	parsed->parse_time_ns = stats.phase_time_ns[unsigned(StatisticsPhase::Parse)];
 	*blob = parsed;
 	return DXIL_SPV_SUCCESS;
 }
@@ -346,6 +1055,27 @@ dxil_spv_shader_stage dxil_spv_parsed_blob_get_shader_stage(dxil_spv_parsed_blob
 	return static_cast<dxil_spv_shader_stage>(Converter::get_shader_stage(blob->bc));
 }
 
+unsigned dxil_spv_parsed_blob_get_num_entry_points(dxil_spv_parsed_blob blob)
+{
+	return unsigned(blob->entry_points.size());
+}
+
+dxil_spv_result dxil_spv_parsed_blob_get_entry_point_name(dxil_spv_parsed_blob blob, unsigned index,
+                                                         const char **name)
+{
+	if (index >= blob->entry_points.size())
+		return DXIL_SPV_ERROR_GENERIC;
+
+	*name = blob->entry_points[index].c_str();
+	return DXIL_SPV_SUCCESS;
+}
+
+dxil_spv_shader_stage dxil_spv_parsed_blob_get_entry_point_shader_stage(dxil_spv_parsed_blob blob,
+                                                                        const char *entry)
+{
+	return static_cast<dxil_spv_shader_stage>(Converter::get_shader_stage(blob->bc, entry));
+}
+
 dxil_spv_result dxil_spv_parsed_blob_scan_resources(dxil_spv_parsed_blob blob,
                                                     dxil_spv_srv_sampler_remapper_cb srv_remapper,
                                                     dxil_spv_srv_sampler_remapper_cb sampler_remapper,
@@ -373,32 +1103,183 @@ void dxil_spv_parsed_blob_free(dxil_spv_parsed_blob blob)
 
 dxil_spv_result dxil_spv_create_converter(dxil_spv_parsed_blob blob, dxil_spv_converter *converter)
 {
-	auto *conv = new (std::nothrow) dxil_spv_converter_s(blob->bc);
+	std::unique_ptr<SPIRVModule> module(new (std::nothrow) SPIRVModule);
+	if (!module)
+		return DXIL_SPV_ERROR_OUT_OF_MEMORY;
+
+	auto *conv = new (std::nothrow) dxil_spv_converter_s(blob->bc, *module);
+	if (!conv)
+		return DXIL_SPV_ERROR_OUT_OF_MEMORY;
+
+	conv->owned_module = std::move(module);
+	conv->converter.set_resource_remapping_interface(&conv->remapper);
+	conv->converter.set_library_analysis(&blob->library_analysis);
+	conv->parse_time_ns = blob->parse_time_ns;
+	*converter = conv;
+	return DXIL_SPV_SUCCESS;
+}
+
+dxil_spv_result dxil_spv_create_converter_context(dxil_spv_converter_context *context)
+{
+	auto *ctx = new (std::nothrow) dxil_spv_converter_context_s;
+	if (!ctx)
+		return DXIL_SPV_ERROR_OUT_OF_MEMORY;
+
+	*context = ctx;
+	return DXIL_SPV_SUCCESS;
+}
+
+void dxil_spv_converter_context_free(dxil_spv_converter_context context)
+{
+	delete context;
+}
+
+dxil_spv_result dxil_spv_create_converter_with_context(dxil_spv_parsed_blob blob, dxil_spv_converter_context context,
+                                                       dxil_spv_converter *converter)
+{
+	if (context->in_use)
+	{
+		LOGE("Converter context is already used by another converter.\n");
+		return DXIL_SPV_ERROR_GENERIC;
+	}
+
+	context->module.reset();
+	auto *conv = new (std::nothrow) dxil_spv_converter_s(blob->bc, context->module);
 	if (!conv)
 		return DXIL_SPV_ERROR_OUT_OF_MEMORY;
 
+	context->in_use = true;
+	conv->context = context;
+	conv->spirv = std::move(context->spirv);
 	conv->converter.set_resource_remapping_interface(&conv->remapper);
+	conv->converter.set_library_analysis(&blob->library_analysis);
+	conv->parse_time_ns = blob->parse_time_ns;
 	*converter = conv;
 	return DXIL_SPV_SUCCESS;
 }
 
 void dxil_spv_converter_free(dxil_spv_converter converter)
 {
+	if (converter && converter->context)
+	{
+		// Hand buffers back for the next converter.
+		converter->context->spirv = std::move(converter->spirv);
+		converter->context->in_use = false;
+	}
 	delete converter;
 }
 
-dxil_spv_result dxil_spv_converter_run(dxil_spv_converter converter)
+void dxil_spv_converter_set_entry_point(dxil_spv_converter converter, const char *entry)
+{
+	converter->converter.set_entry_point(entry);
+}
+
+static void count_spirv_operations(const std::vector<uint32_t> &spirv, Statistics &stats)
+{
+	// Skip the 5 word module header.
+	size_t offset = 5;
+	while (offset < spirv.size())
+	{
+		uint32_t word_count = spirv[offset] >> 16;
+		auto op = spv::Op(spirv[offset] & 0xffff);
+		if (word_count == 0)
+			break;
+
+		stats.num_operations++;
+		switch (op)
+		{
+		case spv::OpConstant:
+		case spv::OpConstantTrue:
+		case spv::OpConstantFalse:
+		case spv::OpConstantComposite:
+		case spv::OpConstantNull:
+		case spv::OpSpecConstant:
+		case spv::OpSpecConstantTrue:
+		case spv::OpSpecConstantFalse:
+		case spv::OpSpecConstantComposite:
+		case spv::OpSpecConstantOp:
+			stats.num_constants++;
+			break;
+
+		default:
+			break;
+		}
+
+		offset += word_count;
+	}
+}
+
+// Called at phase boundaries of run_converter, where no phase timer is active.
+// Only asynchronous conversions yield, since the executor never runs tasks on application threads.
+static void yield_to_higher_priority(dxil_spv_converter converter, BudgetTracker &tracker)
+{
+	if (converter->priority == ExecutorPriority::Interactive)
+		return;
+
+	// Nothing can be queued if no conversion was ever submitted.
+	auto *executor = Executor::try_get_global();
+	if (!executor)
+		return;
+
+	// Preempting conversions must not inherit the allocation callbacks of this one.
+	// Neither should their allocations count towards the statistics of this one.
+	auto *callbacks = get_thread_allocation_callbacks();
+	uint64_t allocation_count = get_thread_allocation_count();
+	get_thread_allocation_callbacks() = nullptr;
+	tracker.exclude_time(executor->yield(converter->priority));
+	get_thread_allocation_callbacks() = callbacks;
+	get_thread_allocation_count() = allocation_count;
+}
+
+static dxil_spv_result get_abort_result(const BudgetTracker &tracker)
+{
+	return tracker.is_cancelled() ? DXIL_SPV_ERROR_CANCELLED : DXIL_SPV_ERROR_BUDGET_EXCEEDED;
+}
+
+static dxil_spv_result run_converter(dxil_spv_converter converter, ConvertedFunction &entry_point,
+                                     const std::atomic<bool> *cancel)
 {
-	auto entry_point = converter->converter.convert_entry_point();
+	Statistics *stats = converter->statistics.get();
+	if (stats)
+	{
+		*stats = {};
+		stats->phase_time_ns[unsigned(StatisticsPhase::Parse)] = converter->parse_time_ns;
+	}
+
+	uint64_t allocation_count = get_thread_allocation_count();
+	BudgetTracker tracker(converter->budget);
+	tracker.set_cancellation_flag(cancel);
+	tracker.set_fixed_arena_bytes(converter->bc_parser.get_arena_bytes());
+	BudgetTracker *budget = converter->has_budget || cancel ? &tracker : nullptr;
+
+	converter->converter.set_statistics(stats);
+	converter->converter.set_budget(budget);
+
+	{
+		ScopedPhaseTimer timer(stats, StatisticsPhase::ConvertEntryPoint);
+		entry_point = converter->converter.convert_entry_point();
+	}
+
+	converter->converter.set_budget(nullptr);
+
 	if (entry_point.entry == nullptr)
 	{
 		LOGE("Failed to convert function.\n");
-		return DXIL_SPV_ERROR_GENERIC;
+		return tracker.is_exceeded() || tracker.is_cancelled() ? get_abort_result(tracker) : DXIL_SPV_ERROR_GENERIC;
 	}
 
+	if (stats)
+		stats->num_blocks = uint32_t(entry_point.node_pool->get_node_count());
+
+	yield_to_higher_priority(converter, tracker);
+
 	{
 		dxil_spv::CFGStructurizer structurizer(entry_point.entry, *entry_point.node_pool, converter->module);
-		structurizer.run();
+		structurizer.set_statistics(stats);
+		structurizer.set_budget(budget);
+		if (!structurizer.run())
+			return get_abort_result(tracker);
+		ScopedPhaseTimer timer(stats, StatisticsPhase::EmitFunctionBody);
 		converter->module.emit_entry_point_function_body(structurizer);
 	}
 
@@ -409,20 +1290,291 @@ dxil_spv_result dxil_spv_converter_run(dxil_spv_converter converter)
 			LOGE("Leaf function is nullptr!\n");
 			return DXIL_SPV_ERROR_GENERIC;
 		}
+
+		yield_to_higher_priority(converter, tracker);
+
 		dxil_spv::CFGStructurizer structurizer(leaf.entry, *entry_point.node_pool, converter->module);
-		structurizer.run();
+		structurizer.set_statistics(stats);
+		structurizer.set_budget(budget);
+		if (!structurizer.run())
+			return get_abort_result(tracker);
+		ScopedPhaseTimer timer(stats, StatisticsPhase::EmitFunctionBody);
 		converter->module.emit_leaf_function_body(leaf.func, structurizer);
 	}
 
-	if (!converter->module.finalize_spirv(converter->spirv))
+	yield_to_higher_priority(converter, tracker);
+
+	if (budget && !budget->check())
+		return get_abort_result(tracker);
+
+	{
+		ScopedPhaseTimer timer(stats, StatisticsPhase::FinalizeSPIRV);
+		if (!converter->module.finalize_spirv(converter->spirv))
+		{
+			LOGE("Failed to finalize SPIR-V.\n");
+			return DXIL_SPV_ERROR_GENERIC;
+		}
+	}
+
+	if (stats)
+	{
+		count_spirv_operations(converter->spirv, *stats);
+		stats->arena_bytes = converter->bc_parser.get_arena_bytes();
+		stats->num_arena_allocations = uint32_t(get_thread_allocation_count() - allocation_count);
+	}
+
+	return DXIL_SPV_SUCCESS;
+}
+
+void dxil_spv_set_allocation_callbacks(const dxil_spv_allocation_callbacks *callbacks)
+{
+	if (callbacks)
 	{
-		LOGE("Failed to finalize SPIR-V.\n");
+		AllocationCallbacks helper = { callbacks->allocate, callbacks->free, callbacks->userdata };
+		set_global_allocation_callbacks(&helper);
+	}
+	else
+		set_global_allocation_callbacks(nullptr);
+}
+
+void dxil_spv_converter_set_allocation_callbacks(dxil_spv_converter converter,
+                                                 const dxil_spv_allocation_callbacks *callbacks)
+{
+	if (callbacks)
+	{
+		converter->allocation_callbacks = { callbacks->allocate, callbacks->free, callbacks->userdata };
+		converter->has_allocation_callbacks = true;
+	}
+	else
+	{
+		converter->allocation_callbacks = {};
+		converter->has_allocation_callbacks = false;
+	}
+}
+
+void dxil_spv_converter_set_budget(dxil_spv_converter converter, const dxil_spv_budget *budget)
+{
+	if (budget)
+	{
+		converter->budget = convert_budget(*budget);
+		converter->has_budget = true;
+	}
+	else
+	{
+		converter->budget = {};
+		converter->has_budget = false;
+	}
+}
+
+static dxil_spv_result run_converter_in_context(dxil_spv_converter converter, const std::atomic<bool> *cancel)
+{
+	ScopedAllocationCallbacks scoped_callbacks(converter->has_allocation_callbacks ?
+	                                           &converter->allocation_callbacks : nullptr);
+	auto *context = converter->context;
+	if (context && context->node_pool)
+		converter->converter.set_node_pool(std::move(context->node_pool));
+
+	ConvertedFunction entry_point;
+	dxil_spv_result result = run_converter(converter, entry_point, cancel);
+
+	if (context && entry_point.node_pool)
+		context->node_pool = std::move(entry_point.node_pool);
+	return result;
+}
+
+dxil_spv_result dxil_spv_converter_run(dxil_spv_converter converter)
+{
+	return run_converter_in_context(converter, nullptr);
+}
+
+struct dxil_spv_async_conversion_s
+{
+	dxil_spv_converter converter = nullptr;
+	std::atomic<bool> cancel{ false };
+	std::mutex lock;
+	std::condition_variable cond;
+	bool done = false;
+	dxil_spv_result result = DXIL_SPV_SUCCESS;
+};
+
+dxil_spv_result dxil_spv_converter_run_async(dxil_spv_converter converter, dxil_spv_async_conversion *conversion)
+{
+	auto *async = new (std::nothrow) dxil_spv_async_conversion_s;
+	if (!async)
+		return DXIL_SPV_ERROR_OUT_OF_MEMORY;
+	async->converter = converter;
+
+	Executor::get_global().submit([async]() {
+		// Cancelled conversions which did not start yet are dropped right away.
+		dxil_spv_result result = DXIL_SPV_ERROR_CANCELLED;
+		if (!async->cancel.load(std::memory_order_relaxed))
+			result = run_converter_in_context(async->converter, &async->cancel);
+
+		std::lock_guard<std::mutex> holder{ async->lock };
+		async->result = result;
+		async->done = true;
+		async->cond.notify_all();
+	}, converter->priority);
+
+	*conversion = async;
+	return DXIL_SPV_SUCCESS;
+}
+
+dxil_spv_bool dxil_spv_async_conversion_poll(dxil_spv_async_conversion conversion, dxil_spv_result *result)
+{
+	std::lock_guard<std::mutex> holder{ conversion->lock };
+	if (!conversion->done)
+		return DXIL_SPV_FALSE;
+
+	if (result)
+		*result = conversion->result;
+	return DXIL_SPV_TRUE;
+}
+
+dxil_spv_result dxil_spv_async_conversion_wait(dxil_spv_async_conversion conversion)
+{
+	std::unique_lock<std::mutex> holder{ conversion->lock };
+	conversion->cond.wait(holder, [conversion]() { return conversion->done; });
+	return conversion->result;
+}
+
+void dxil_spv_async_conversion_cancel(dxil_spv_async_conversion conversion)
+{
+	conversion->cancel.store(true, std::memory_order_relaxed);
+}
+
+void dxil_spv_async_conversion_free(dxil_spv_async_conversion conversion)
+{
+	if (conversion)
+	{
+		dxil_spv_async_conversion_cancel(conversion);
+		dxil_spv_async_conversion_wait(conversion);
+		delete conversion;
+	}
+}
+
+void dxil_spv_converter_set_priority(dxil_spv_converter converter, dxil_spv_priority priority)
+{
+	converter->priority = priority == DXIL_SPV_PRIORITY_BACKGROUND ? ExecutorPriority::Background :
+	                                                                 ExecutorPriority::Interactive;
+}
+
+dxil_spv_result dxil_spv_get_queue_statistics(dxil_spv_priority priority, dxil_spv_queue_statistics *stats)
+{
+	ExecutorPriority executor_priority;
+	switch (priority)
+	{
+	case DXIL_SPV_PRIORITY_INTERACTIVE:
+		executor_priority = ExecutorPriority::Interactive;
+		break;
+
+	case DXIL_SPV_PRIORITY_BACKGROUND:
+		executor_priority = ExecutorPriority::Background;
+		break;
+
+	default:
 		return DXIL_SPV_ERROR_GENERIC;
 	}
 
+	*stats = {};
+	auto *executor = Executor::try_get_global();
+	if (!executor)
+		return DXIL_SPV_SUCCESS;
+
+	auto s = executor->get_statistics(executor_priority);
+	stats->queue_depth = s.queue_depth;
+	stats->num_running = s.num_running;
+	stats->num_completed = s.num_completed;
+	stats->total_wait_ms = double(s.total_wait_ns) * 1e-6;
+	stats->max_wait_ms = double(s.max_wait_ns) * 1e-6;
+	stats->total_run_ms = double(s.total_run_ns) * 1e-6;
 	return DXIL_SPV_SUCCESS;
 }
 
+void dxil_spv_converter_enable_statistics(dxil_spv_converter converter, dxil_spv_bool enable)
+{
+	if (enable == DXIL_SPV_TRUE)
+	{
+		if (!converter->statistics)
+			converter->statistics.reset(new Statistics);
+	}
+	else
+		converter->statistics.reset();
+}
+
+static double phase_time_ms(const Statistics &stats, StatisticsPhase phase)
+{
+	return double(stats.phase_time_ns[unsigned(phase)]) * 1e-6;
+}
+
+dxil_spv_result dxil_spv_converter_get_statistics(dxil_spv_converter converter, dxil_spv_statistics *stats)
+{
+	if (!converter->statistics)
+		return DXIL_SPV_ERROR_GENERIC;
+
+	auto &s = *converter->statistics;
+	stats->parse_ms = phase_time_ms(s, StatisticsPhase::Parse);
+	stats->convert_entry_point_ms = phase_time_ms(s, StatisticsPhase::ConvertEntryPoint);
+	stats->create_continue_block_ladders_ms = phase_time_ms(s, StatisticsPhase::CreateContinueBlockLadders);
+	stats->split_merge_scopes_ms = phase_time_ms(s, StatisticsPhase::SplitMergeScopes);
+	stats->structurize_ms = phase_time_ms(s, StatisticsPhase::Structurize);
+	stats->insert_phi_ms = phase_time_ms(s, StatisticsPhase::InsertPhi);
+	stats->emit_function_body_ms = phase_time_ms(s, StatisticsPhase::EmitFunctionBody);
+	stats->finalize_spirv_ms = phase_time_ms(s, StatisticsPhase::FinalizeSPIRV);
+
+	stats->num_blocks = s.num_blocks;
+	stats->num_helper_blocks = s.num_helper_blocks;
+	stats->num_phis = s.num_phis;
+	stats->num_operations = s.num_operations;
+	stats->num_constants = s.num_constants;
+	stats->arena_bytes = s.arena_bytes;
+	stats->num_arena_allocations = s.num_arena_allocations;
+	stats->num_ir_blocks = s.num_ir_blocks;
+	stats->num_ir_block_visits = s.num_ir_block_visits;
+	return DXIL_SPV_SUCCESS;
+}
+
+dxil_spv_result dxil_spv_converter_run_parallel(const dxil_spv_converter *converters, unsigned count,
+                                                unsigned num_threads, dxil_spv_result *results)
+{
+	if (num_threads == 0)
+		num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+	num_threads = std::min(num_threads, count);
+
+	// Each worker pulls converters off a shared counter. Converters only read the parsed module,
+	// so they may share one parsed blob.
+	std::atomic<unsigned> next_index{ 0 };
+	std::atomic<bool> all_success{ true };
+	auto worker = [&]() {
+		unsigned index;
+		while ((index = next_index.fetch_add(1, std::memory_order_relaxed)) < count)
+		{
+			dxil_spv_result result = dxil_spv_converter_run(converters[index]);
+			if (results)
+				results[index] = result;
+			if (result != DXIL_SPV_SUCCESS)
+				all_success.store(false, std::memory_order_relaxed);
+		}
+	};
+
+	if (num_threads <= 1)
+	{
+		worker();
+	}
+	else
+	{
+		std::vector<std::thread> threads;
+		threads.reserve(num_threads - 1);
+		for (unsigned i = 1; i < num_threads; i++)
+			threads.emplace_back(worker);
+		worker();
+		for (auto &thread : threads)
+			thread.join();
+	}
+
+	return all_success.load() ? DXIL_SPV_SUCCESS : DXIL_SPV_ERROR_GENERIC;
+}
+
 dxil_spv_result dxil_spv_converter_get_compiled_spirv(dxil_spv_converter converter, dxil_spv_compiled_spirv *compiled)
 {
 	if (converter->spirv.empty())
@@ -452,6 +1604,19 @@ void dxil_spv_converter_set_root_constant_word_count(dxil_spv_converter converte
 	converter->remapper.root_constant_word_count = num_words;
 }
 
+void dxil_spv_converter_set_root_signature(dxil_spv_converter converter, dxil_spv_root_signature root_signature,
+                                           const dxil_spv_root_signature_layout *layout)
+{
+	converter->remapper.root_signature = root_signature;
+	if (root_signature)
+		converter->remapper.root_signature_layout = *layout;
+}
+
+void dxil_spv_converter_set_remapping_table(dxil_spv_converter converter, dxil_spv_remapping_table table)
+{
+	converter->remapper.remapping_table = table;
+}
+
 void dxil_spv_converter_set_uav_remapper(dxil_spv_converter converter, dxil_spv_uav_remapper_cb remapper,
                                          void *userdata)
 {
@@ -567,6 +1732,62 @@ dxil_spv_result dxil_spv_converter_add_option(dxil_spv_converter converter, cons
 		break;
 	}
 
+	case DXIL_SPV_OPTION_SSA_CLEANUP:
+	{
+		OptionSSACleanup helper;
+		helper.enable = reinterpret_cast<const dxil_spv_option_ssa_cleanup *>(option)->enable == DXIL_SPV_TRUE;
+		converter->converter.add_option(helper);
+		break;
+	}
+
+	case DXIL_SPV_OPTION_INTEGER_SIGNEDNESS_INFERENCE:
+	{
+		OptionIntegerSignednessInference helper;
+		helper.enable = reinterpret_cast<const dxil_spv_option_integer_signedness_inference *>(option)->enable ==
+		                DXIL_SPV_TRUE;
+		converter->converter.add_option(helper);
+		break;
+	}
+
+	case DXIL_SPV_OPTION_LOOP_INVARIANT_HOISTING:
+	{
+		OptionLoopInvariantHoisting helper;
+		helper.enable =
+		    reinterpret_cast<const dxil_spv_option_loop_invariant_hoisting *>(option)->enable == DXIL_SPV_TRUE;
+		converter->converter.add_option(helper);
+		break;
+	}
+
+	case DXIL_SPV_OPTION_PHYSICAL_ADDRESS_FOLDING:
+	{
+		OptionPhysicalAddressFolding helper;
+		helper.enable =
+		    reinterpret_cast<const dxil_spv_option_physical_address_folding *>(option)->enable == DXIL_SPV_TRUE;
+		converter->converter.add_option(helper);
+		break;
+	}
+
+	case DXIL_SPV_OPTION_VECTORIZED_ROOT_CONSTANTS:
+	{
+		OptionVectorizedRootConstants helper;
+		helper.enable =
+		    reinterpret_cast<const dxil_spv_option_vectorized_root_constants *>(option)->enable == DXIL_SPV_TRUE;
+		converter->converter.add_option(helper);
+		break;
+	}
+
+	case DXIL_SPV_OPTION_PIPELINE_STATE_SPEC_CONSTANTS:
+	{
+		OptionPipelineStateSpecConstants helper;
+		const auto *spec = reinterpret_cast<const dxil_spv_option_pipeline_state_spec_constants *>(option);
+		helper.output_swizzle = spec->output_swizzle == DXIL_SPV_TRUE;
+		helper.output_swizzle_spec_id = spec->output_swizzle_spec_id;
+		helper.root_constant_word_count = spec->root_constant_word_count == DXIL_SPV_TRUE;
+		helper.root_constant_word_count_spec_id = spec->root_constant_word_count_spec_id;
+		converter->converter.add_option(helper);
+		break;
+	}
+
 	default:
 		return DXIL_SPV_ERROR_UNSUPPORTED_FEATURE;
 	}
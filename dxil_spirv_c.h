@@ -60,6 +60,8 @@ typedef enum dxil_spv_result
 	DXIL_SPV_ERROR_UNSUPPORTED_FEATURE = -3,
 	DXIL_SPV_ERROR_PARSER = -4,
 	DXIL_SPV_ERROR_FAILED_VALIDATION = -5,
+	DXIL_SPV_ERROR_BUDGET_EXCEEDED = -6,
+	DXIL_SPV_ERROR_CANCELLED = -7,
 	DXIL_SPV_RESULT_INT_MAX = 0x7fffffff
 } dxil_spv_result;
 
@@ -198,6 +200,70 @@ typedef struct dxil_spv_compiled_spirv
 	size_t size;
 } dxil_spv_compiled_spirv;
 
+/* Wall time is reported in milliseconds. Structurizer phases accumulate over all functions. */
+typedef struct dxil_spv_statistics
+{
+	double parse_ms;
+	double convert_entry_point_ms;
+	double create_continue_block_ladders_ms;
+	double split_merge_scopes_ms;
+	double structurize_ms;
+	double insert_phi_ms;
+	double emit_function_body_ms;
+	double finalize_spirv_ms;
+
+	unsigned num_blocks;
+	unsigned num_helper_blocks;
+	unsigned num_phis;
+	unsigned num_operations;
+	unsigned num_constants;
+	size_t arena_bytes;
+	/* Arena blocks and CFG nodes allocated by dxil_spv_converter_run.
+	 * Converters created from a warmed up converter context should allocate little or nothing. */
+	unsigned num_arena_allocations;
+
+	/* Reachable LLVM IR blocks in converted functions, and the number of times the converter visited them.
+	 * The ratio is the number of passes over the IR. */
+	unsigned num_ir_blocks;
+	unsigned num_ir_block_visits;
+} dxil_spv_statistics;
+
+/* Priority classes of conversions. Interactive conversions always run before queued background conversions,
+ * and running background conversions let queued interactive conversions run on their thread at phase boundaries.
+ * The phase boundaries are after dxil_spv_converter_run has converted the entry point, before structurizing
+ * each function, and before finalizing the module. Converting the entry point itself is never preempted. */
+typedef enum dxil_spv_priority
+{
+	DXIL_SPV_PRIORITY_INTERACTIVE = 0,
+	DXIL_SPV_PRIORITY_BACKGROUND = 1,
+	DXIL_SPV_PRIORITY_INT_MAX = 0x7fffffff
+} dxil_spv_priority;
+
+/* Telemetry of the internal conversion queue for one priority class. Times are in milliseconds.
+ * Wait time is measured from submission until a conversion starts.
+ * Run time excludes time where a background conversion was preempted. */
+typedef struct dxil_spv_queue_statistics
+{
+	unsigned queue_depth;
+	unsigned num_running;
+	unsigned num_completed;
+	double total_wait_ms;
+	double max_wait_ms;
+	double total_run_ms;
+} dxil_spv_queue_statistics;
+
+/* Limits for parsing and conversion. 0 means unlimited.
+ * Limits are checked at cheap points, e.g. once per block, so they may be overshot slightly.
+ * Parsing only considers max_arena_bytes and max_time_us.
+ * max_arena_bytes covers the parsed module and the operations allocated while converting. */
+typedef struct dxil_spv_budget
+{
+	unsigned max_nodes;
+	unsigned max_operations;
+	size_t max_arena_bytes;
+	unsigned max_time_us;
+} dxil_spv_budget;
+
 /* Remaps SRVs and Samplers to desired binding points. */
 typedef dxil_spv_bool (*dxil_spv_srv_sampler_remapper_cb)(void *userdata,
                                                           const dxil_spv_d3d_binding *d3d_binding,
@@ -221,6 +287,12 @@ typedef enum dxil_spv_option
 	DXIL_SPV_OPTION_BINDLESS_CBV_SSBO_EMULATION = 6,
 	DXIL_SPV_OPTION_PHYSICAL_STORAGE_BUFFER = 7,
 	DXIL_SPV_OPTION_SBT_DESCRIPTOR_SIZE_LOG2 = 8,
+	DXIL_SPV_OPTION_SSA_CLEANUP = 9,
+	DXIL_SPV_OPTION_INTEGER_SIGNEDNESS_INFERENCE = 10,
+	DXIL_SPV_OPTION_LOOP_INVARIANT_HOISTING = 11,
+	DXIL_SPV_OPTION_PHYSICAL_ADDRESS_FOLDING = 12,
+	DXIL_SPV_OPTION_VECTORIZED_ROOT_CONSTANTS = 13,
+	DXIL_SPV_OPTION_PIPELINE_STATE_SPEC_CONSTANTS = 14,
 	DXIL_SPV_OPTION_INT_MAX = 0x7fffffff
 } dxil_spv_option;
 
@@ -290,9 +362,297 @@ typedef struct dxil_spv_option_sbt_descriptor_size_log2
 	unsigned size_log2_sampler;
 } dxil_spv_option_sbt_descriptor_size_log2;
 
+/* Runs a cleanup pass on the structurized IR before emitting SPIR-V.
+ * Forwards copies, redundant bitcasts and trivial PHIs, and removes unused side-effect free operations. */
+typedef struct dxil_spv_option_ssa_cleanup
+{
+	dxil_spv_option_base base;
+	dxil_spv_bool enable;
+} dxil_spv_option_ssa_cleanup;
+
+/* Keeps values loaded from signed typed resources in signed form if they only flow through
+ * integer arithmetic into signed typed stores, which avoids bitcasting through uint. */
+typedef struct dxil_spv_option_integer_signedness_inference
+{
+	dxil_spv_option_base base;
+	dxil_spv_bool enable;
+} dxil_spv_option_integer_signedness_inference;
+
+/* Moves resource handle creation with loop invariant arguments out of loops. */
+typedef struct dxil_spv_option_loop_invariant_hoisting
+{
+	dxil_spv_option_base base;
+	dxil_spv_bool enable;
+} dxil_spv_option_loop_invariant_hoisting;
+
+/* For raw loads and stores through physical storage buffers, folds constant offsets into access chains
+ * and shares the converted base pointer between accesses in the same block. */
+typedef struct dxil_spv_option_physical_address_folding
+{
+	dxil_spv_option_base base;
+	dxil_spv_bool enable;
+} dxil_spv_option_physical_address_folding;
+
+/* Declares the root constant block as an array of uvec4 rows when the word count allows it,
+ * so CBufferLoadLegacy from root constants becomes a single vector load. */
+typedef struct dxil_spv_option_vectorized_root_constants
+{
+	dxil_spv_option_base base;
+	dxil_spv_bool enable;
+} dxil_spv_option_vectorized_root_constants;
+
+/* Moves pipeline state which would otherwise be baked into the SPIR-V into specialization constants,
+ * so a single conversion can serve many pipelines. Options replaced this way do not need to be part of a cache key.
+ * output_swizzle: The swizzle of render target i is read from spec constant output_swizzle_spec_id + i,
+ * encoded as in dxil_spv_option_output_swizzle. It defaults to the swizzle set with that option, or identity.
+ * root_constant_word_count: The root constant block is an array sized by spec constant
+ * root_constant_word_count_spec_id. It defaults to the root constant word count given to the converter,
+ * which is the upper bound, and must cover every root constant the shader uses.
+ * Vectorized root constants are not used in this mode.
+ * It has no effect with the inline uniform block, since a uniform block array of words is not a valid layout.
+ * Dual-source blending changes the Location and Index decorations, which cannot be specialized,
+ * so it must remain part of the cache key. */
+typedef struct dxil_spv_option_pipeline_state_spec_constants
+{
+	dxil_spv_option_base base;
+	dxil_spv_bool output_swizzle;
+	unsigned output_swizzle_spec_id;
+	dxil_spv_bool root_constant_word_count;
+	unsigned root_constant_word_count_spec_id;
+} dxil_spv_option_pipeline_state_spec_constants;
+
+/* Allocation callbacks for the arenas of the library: the LLVM IR arena of parsed blobs,
+ * the operation and CFG node pools of converters.
+ * Smaller bookkeeping allocations, e.g. in STL containers, still use the default allocator.
+ * alignment is at most alignof(max_align_t). free may be NULL if memory is released in bulk,
+ * but objects which use the memory must be freed first.
+ * Every allocation is freed through the callbacks it was made with. */
+typedef void *(*dxil_spv_allocate_cb)(void *userdata, size_t size, size_t alignment);
+typedef void (*dxil_spv_free_cb)(void *userdata, void *ptr);
+
+typedef struct dxil_spv_allocation_callbacks
+{
+	dxil_spv_allocate_cb allocate;
+	dxil_spv_free_cb free;
+	void *userdata;
+} dxil_spv_allocation_callbacks;
+
+/* Sets callbacks for all later allocations, including parsing. NULL restores malloc.
+ * Must not be called while other threads use the library. */
+DXIL_SPV_PUBLIC_API void dxil_spv_set_allocation_callbacks(const dxil_spv_allocation_callbacks *callbacks);
+
 /* Gets the ABI version used to build this library. Used to detect API/ABI mismatches. */
 DXIL_SPV_PUBLIC_API void dxil_spv_get_version(unsigned *major, unsigned *minor, unsigned *patch);
 
+/* Container index API */
+/* Locates parts of a DXBC container without copying or decoding them, and without allocating memory. */
+#define DXIL_SPV_FOURCC(a, b, c, d) \
+	((unsigned)(a) | ((unsigned)(b) << 8) | ((unsigned)(c) << 16) | ((unsigned)(d) << 24))
+
+typedef struct dxil_spv_container_part
+{
+	/* E.g. DXIL_SPV_FOURCC('D', 'X', 'I', 'L'), 'RTS0', 'PSV0' or 'HASH'. */
+	unsigned fourcc;
+	/* Offset of the part payload from the start of the container, and its size in bytes. */
+	unsigned offset;
+	unsigned size;
+} dxil_spv_container_part;
+
+/* If parts is NULL, the number of parts is written to part_count.
+ * Otherwise, part_count holds the capacity of parts, and is updated with the number of parts in the container.
+ * DXIL_SPV_ERROR_GENERIC is returned if the capacity is too small. */
+DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_index_dxil_container(const void *data, size_t size,
+                                                                   dxil_spv_container_part *parts,
+                                                                   unsigned *part_count);
+
+/* Locates the raw LLVM BC in a DXBC container. The returned pointer points into data. */
+DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_find_dxil_bitcode(const void *data, size_t size,
+                                                                const void **bitcode, size_t *bitcode_size);
+/* Container index API */
+
+/* Early classification API */
+/* Answers queries from the pipeline state validation (PSV0) part of a DXBC container,
+ * without parsing the bitcode. No memory is allocated. */
+
+/* Ray tracing, mesh and amplification stages are reported as DXIL_SPV_STAGE_UNKNOWN.
+ * Fails if the container has no PSV0 part, or the part is too old to record the stage. */
+DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_psv_get_shader_stage(const void *data, size_t size,
+                                                                   dxil_spv_shader_stage *stage);
+
+typedef struct dxil_spv_psv_resource_binding
+{
+	dxil_spv_resource_class resource_class;
+	/* Older containers do not record the resource kind. In that case, typed resources are
+	 * reported as DXIL_SPV_RESOURCE_KIND_INVALID, since they may be either textures or typed buffers. */
+	dxil_spv_resource_kind kind;
+	unsigned register_space;
+	unsigned register_index;
+	/* ~0u for unbounded ranges. */
+	unsigned range_size;
+	dxil_spv_bool has_counter;
+} dxil_spv_psv_resource_binding;
+
+/* If bindings is NULL, the number of bindings is written to binding_count.
+ * Otherwise, binding_count holds the capacity of bindings, and is updated with the number of bindings.
+ * DXIL_SPV_ERROR_GENERIC is returned if the capacity is too small. */
+DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_psv_get_resource_bindings(const void *data, size_t size,
+                                                                        dxil_spv_psv_resource_binding *bindings,
+                                                                        unsigned *binding_count);
+
+typedef enum dxil_spv_psv_signature
+{
+	DXIL_SPV_PSV_SIGNATURE_INPUT = 0,
+	DXIL_SPV_PSV_SIGNATURE_OUTPUT = 1,
+	DXIL_SPV_PSV_SIGNATURE_PATCH_CONSTANT_OR_PRIMITIVE = 2,
+	DXIL_SPV_PSV_SIGNATURE_INT_MAX = 0x7fffffff
+} dxil_spv_psv_signature;
+
+typedef struct dxil_spv_psv_signature_element
+{
+	/* Points into the string table of the container. */
+	const char *semantic;
+	unsigned semantic_index;
+	unsigned start_row;
+	unsigned rows;
+	unsigned start_col;
+	unsigned cols;
+	/* Matches DXIL enums. */
+	unsigned system_value_semantic;
+	unsigned component_type;
+	unsigned interpolation_mode;
+	unsigned stream;
+} dxil_spv_psv_signature_element;
+
+/* Same count semantics as dxil_spv_psv_get_resource_bindings. */
+DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_psv_get_signature_elements(const void *data, size_t size,
+                                                                         dxil_spv_psv_signature signature,
+                                                                         dxil_spv_psv_signature_element *elements,
+                                                                         unsigned *element_count);
+/* Early classification API */
+
+/* Root signature API */
+/* Decodes the root signature (RTS0, version 1.0 or 1.1) part of a DXBC container into a flat binding table.
+ * The container can be a shader with an embedded root signature, or a serialized root signature. */
+typedef struct dxil_spv_root_signature_s *dxil_spv_root_signature;
+
+typedef enum dxil_spv_root_signature_binding_type
+{
+	DXIL_SPV_ROOT_SIGNATURE_BINDING_DESCRIPTOR_TABLE = 0,
+	DXIL_SPV_ROOT_SIGNATURE_BINDING_ROOT_CONSTANTS = 1,
+	DXIL_SPV_ROOT_SIGNATURE_BINDING_ROOT_DESCRIPTOR = 2,
+	DXIL_SPV_ROOT_SIGNATURE_BINDING_STATIC_SAMPLER = 3,
+	DXIL_SPV_ROOT_SIGNATURE_BINDING_INT_MAX = 0x7fffffff
+} dxil_spv_root_signature_binding_type;
+
+typedef struct dxil_spv_root_signature_binding
+{
+	dxil_spv_root_signature_binding_type type;
+	dxil_spv_resource_class resource_class;
+	/* Matches D3D12_SHADER_VISIBILITY. */
+	unsigned visibility;
+	unsigned register_space;
+	unsigned register_index;
+	/* ~0u for unbounded ranges. */
+	unsigned num_descriptors;
+	/* Root parameter index, or static sampler index. */
+	unsigned parameter_index;
+	/* Root parameters are packed into one root constant block in declaration order.
+	 * Descriptor tables take one word which holds the heap offset of the table,
+	 * root constants take their declared word count, root descriptors and static samplers take none. */
+	unsigned root_constant_word;
+	/* Offset of register_index from the start of its descriptor table. */
+	unsigned offset_in_table;
+} dxil_spv_root_signature_binding;
+
+DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_parse_root_signature(const void *data, size_t size,
+                                                                   dxil_spv_root_signature *root_signature);
+DXIL_SPV_PUBLIC_API void dxil_spv_root_signature_free(dxil_spv_root_signature root_signature);
+
+DXIL_SPV_PUBLIC_API unsigned dxil_spv_root_signature_get_root_constant_word_count(
+		dxil_spv_root_signature root_signature);
+
+/* Same count semantics as dxil_spv_psv_get_resource_bindings.
+ * Bindings are sorted by resource class, register space and register index. */
+DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_root_signature_get_bindings(dxil_spv_root_signature root_signature,
+                                                                          dxil_spv_root_signature_binding *bindings,
+                                                                          unsigned *binding_count);
+
+typedef struct dxil_spv_descriptor_binding
+{
+	unsigned set;
+	unsigned binding;
+} dxil_spv_descriptor_binding;
+
+/* Describes how the Vulkan pipeline layout is derived from a root signature. */
+typedef struct dxil_spv_root_signature_layout
+{
+	/* Descriptor heap for each resource class, indexed by dxil_spv_resource_class.
+	 * Resources in descriptor tables are accessed as
+	 * HEAP[root_constants[root_constant_word] + offset_in_table + array_index]. */
+	dxil_spv_descriptor_binding heaps[4];
+	/* Holds UAV counters, indexed in the same way as the UAV heap. */
+	dxil_spv_descriptor_binding uav_counter_heap;
+	/* Root descriptors use binding = root parameter index in this set.
+	 * They have no UAV counter, so UAVs which use a counter must be in a descriptor table. */
+	unsigned root_descriptor_set;
+	/* Static samplers use binding = static sampler index in this set. */
+	unsigned static_sampler_set;
+} dxil_spv_root_signature_layout;
+/* Root signature API */
+
+/* Remapping table API */
+/* A static remapping table, keyed by shader stage, resource class, register space and register index.
+ * Lookups are hashed, and no callbacks are involved. Entries added with DXIL_SPV_STAGE_UNKNOWN apply to
+ * any stage which does not have its own entry for the same register.
+ * Adding an entry for an existing key replaces it.
+ * Once attached to converters, the table must not be modified or freed until they are done converting,
+ * but it can be shared between any number of converters on any thread. */
+typedef struct dxil_spv_remapping_table_s *dxil_spv_remapping_table;
+
+DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_create_remapping_table(dxil_spv_remapping_table *table);
+DXIL_SPV_PUBLIC_API void dxil_spv_remapping_table_free(dxil_spv_remapping_table table);
+
+/* Avoids rehashing while adding a known number of entries. */
+DXIL_SPV_PUBLIC_API void dxil_spv_remapping_table_reserve(dxil_spv_remapping_table table, unsigned num_entries);
+
+DXIL_SPV_PUBLIC_API void dxil_spv_remapping_table_add_srv(dxil_spv_remapping_table table,
+                                                          dxil_spv_shader_stage stage,
+                                                          unsigned register_space, unsigned register_index,
+                                                          const dxil_spv_vulkan_binding *binding);
+DXIL_SPV_PUBLIC_API void dxil_spv_remapping_table_add_sampler(dxil_spv_remapping_table table,
+                                                              dxil_spv_shader_stage stage,
+                                                              unsigned register_space, unsigned register_index,
+                                                              const dxil_spv_vulkan_binding *binding);
+DXIL_SPV_PUBLIC_API void dxil_spv_remapping_table_add_uav(dxil_spv_remapping_table table,
+                                                          dxil_spv_shader_stage stage,
+                                                          unsigned register_space, unsigned register_index,
+                                                          const dxil_spv_uav_vulkan_binding *binding);
+DXIL_SPV_PUBLIC_API void dxil_spv_remapping_table_add_cbv(dxil_spv_remapping_table table,
+                                                          dxil_spv_shader_stage stage,
+                                                          unsigned register_space, unsigned register_index,
+                                                          const dxil_spv_cbv_vulkan_binding *binding);
+
+/* Looks up a binding with the same stage fallback the converter uses.
+ * Returns DXIL_SPV_FALSE and leaves binding untouched if there is no entry. */
+DXIL_SPV_PUBLIC_API dxil_spv_bool dxil_spv_remapping_table_find_srv(dxil_spv_remapping_table table,
+                                                                    dxil_spv_shader_stage stage,
+                                                                    unsigned register_space, unsigned register_index,
+                                                                    dxil_spv_vulkan_binding *binding);
+DXIL_SPV_PUBLIC_API dxil_spv_bool dxil_spv_remapping_table_find_sampler(dxil_spv_remapping_table table,
+                                                                        dxil_spv_shader_stage stage,
+                                                                        unsigned register_space,
+                                                                        unsigned register_index,
+                                                                        dxil_spv_vulkan_binding *binding);
+DXIL_SPV_PUBLIC_API dxil_spv_bool dxil_spv_remapping_table_find_uav(dxil_spv_remapping_table table,
+                                                                    dxil_spv_shader_stage stage,
+                                                                    unsigned register_space, unsigned register_index,
+                                                                    dxil_spv_uav_vulkan_binding *binding);
+DXIL_SPV_PUBLIC_API dxil_spv_bool dxil_spv_remapping_table_find_cbv(dxil_spv_remapping_table table,
+                                                                    dxil_spv_shader_stage stage,
+                                                                    unsigned register_space, unsigned register_index,
+                                                                    dxil_spv_cbv_vulkan_binding *binding);
+/* Remapping table API */
+
 /* Parsing API */
 /* Parses and frees a DXBC blob. */
 typedef struct dxil_spv_parsed_blob_s *dxil_spv_parsed_blob;
@@ -301,6 +661,13 @@ typedef struct dxil_spv_parsed_blob_s *dxil_spv_parsed_blob;
 DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_parse_dxil_blob(const void *data, size_t size, dxil_spv_parsed_blob *blob);
 /* Parses raw DXIL (LLVM BC). */
 DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_parse_dxil(const void *data, size_t size, dxil_spv_parsed_blob *blob);
+/* As above, but parsing fails with DXIL_SPV_ERROR_BUDGET_EXCEEDED once budget is exceeded. budget may be NULL. */
+DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_parse_dxil_blob_with_budget(const void *data, size_t size,
+                                                                         const dxil_spv_budget *budget,
+                                                                         dxil_spv_parsed_blob *blob);
+DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_parse_dxil_with_budget(const void *data, size_t size,
+                                                                    const dxil_spv_budget *budget,
+                                                                    dxil_spv_parsed_blob *blob);
 
 /* Dumps the LLVM IR representation to console. For debugging. */
 DXIL_SPV_PUBLIC_API void dxil_spv_parsed_blob_dump_llvm_ir(dxil_spv_parsed_blob blob);
@@ -310,6 +677,14 @@ DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_parsed_blob_get_raw_ir(dxil_spv_par
 
 DXIL_SPV_PUBLIC_API dxil_spv_shader_stage dxil_spv_parsed_blob_get_shader_stage(dxil_spv_parsed_blob blob);
 
+/* Entry points of the module. A library has one per export, other shaders have exactly one.
+ * The name is owned by the blob. */
+DXIL_SPV_PUBLIC_API unsigned dxil_spv_parsed_blob_get_num_entry_points(dxil_spv_parsed_blob blob);
+DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_parsed_blob_get_entry_point_name(dxil_spv_parsed_blob blob,
+                                                                             unsigned index, const char **name);
+DXIL_SPV_PUBLIC_API dxil_spv_shader_stage dxil_spv_parsed_blob_get_entry_point_shader_stage(
+		dxil_spv_parsed_blob blob, const char *entry);
+
 DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_parsed_blob_scan_resources(
 		dxil_spv_parsed_blob blob,
 		dxil_spv_srv_sampler_remapper_cb srv_remapper,
@@ -326,6 +701,25 @@ typedef struct dxil_spv_converter_s *dxil_spv_converter;
 DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_create_converter(dxil_spv_parsed_blob blob, dxil_spv_converter *converter);
 DXIL_SPV_PUBLIC_API void dxil_spv_converter_free(dxil_spv_converter converter);
 
+/* A converter context keeps memory alive between conversions, so steady state conversion
+ * mostly reuses memory instead of allocating it. Use one context per thread.
+ * The operation arena, CFG nodes and the SPIR-V buffer are reused. Memory the context has to grow is allocated
+ * with the allocation callbacks of the converter which runs at that point.
+ * The SPIR-V builder and per-module lookup tables are still created for every converter.
+ * Only one converter may use a context at a time. Free the converter before creating the next one.
+ * The compiled SPIR-V of a converter is valid until it is freed, as with dxil_spv_create_converter. */
+typedef struct dxil_spv_converter_context_s *dxil_spv_converter_context;
+DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_create_converter_context(dxil_spv_converter_context *context);
+DXIL_SPV_PUBLIC_API void dxil_spv_converter_context_free(dxil_spv_converter_context context);
+DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_create_converter_with_context(dxil_spv_parsed_blob blob,
+                                                                           dxil_spv_converter_context context,
+                                                                           dxil_spv_converter *converter);
+
+/* Selects which export of a library to convert. By default, or if entry is NULL, the first entry point is used.
+ * Any number of converters may be created from the same parsed blob, one per export.
+ * A selected export only declares the resources and global variables it references. */
+DXIL_SPV_PUBLIC_API void dxil_spv_converter_set_entry_point(dxil_spv_converter converter, const char *entry);
+
 DXIL_SPV_PUBLIC_API void dxil_spv_converter_set_vertex_input_remapper(
 		dxil_spv_converter converter,
 		dxil_spv_vertex_input_remapper_cb remapper,
@@ -359,6 +753,21 @@ DXIL_SPV_PUBLIC_API void dxil_spv_converter_set_cbv_remapper(
 		dxil_spv_cbv_remapper_cb remapper,
 		void *userdata);
 
+/* Resolves SRV, sampler, CBV and UAV bindings by looking them up in the root signature,
+ * instead of calling the remapper callbacks. The root constant word count is taken from the root signature.
+ * A resource which is not covered by the root signature fails conversion.
+ * The root signature is not modified by conversion, so it may be shared between converters on any thread,
+ * but must outlive them. Passing NULL restores the remapper callbacks. */
+DXIL_SPV_PUBLIC_API void dxil_spv_converter_set_root_signature(dxil_spv_converter converter,
+                                                               dxil_spv_root_signature root_signature,
+                                                               const dxil_spv_root_signature_layout *layout);
+
+/* Looks up SRV, sampler, CBV and UAV bindings in the table first. Resources which are not in the table
+ * fall back to the remapper callbacks. A root signature set with dxil_spv_converter_set_root_signature
+ * takes precedence over the table. Passing NULL detaches the table. */
+DXIL_SPV_PUBLIC_API void dxil_spv_converter_set_remapping_table(dxil_spv_converter converter,
+                                                                dxil_spv_remapping_table table);
+
 DXIL_SPV_PUBLIC_API void dxil_spv_converter_add_local_root_constants(
 	dxil_spv_converter converter,
 	unsigned register_space,
@@ -379,9 +788,53 @@ DXIL_SPV_PUBLIC_API void dxil_spv_converter_add_local_root_descriptor_table(
 	unsigned num_descriptors_in_range,
 	unsigned offset_in_heap);
 
+/* Allocations made by dxil_spv_converter_run on this converter go through callbacks,
+ * taking precedence over dxil_spv_set_allocation_callbacks. NULL restores the global callbacks.
+ * If the converter uses a converter context, the context keeps that memory for later converters,
+ * so the callbacks must then outlive the context. */
+DXIL_SPV_PUBLIC_API void dxil_spv_converter_set_allocation_callbacks(dxil_spv_converter converter,
+                                                                     const dxil_spv_allocation_callbacks *callbacks);
+
+/* dxil_spv_converter_run fails with DXIL_SPV_ERROR_BUDGET_EXCEEDED once budget is exceeded.
+ * Time is measured from the start of the run. NULL removes the budget. */
+DXIL_SPV_PUBLIC_API void dxil_spv_converter_set_budget(dxil_spv_converter converter, const dxil_spv_budget *budget);
+
 /* After setting up converter, runs the converted to SPIR-V. */
 DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_converter_run(dxil_spv_converter converter);
 
+/* Runs several converters on up to num_threads threads. num_threads = 0 uses the hardware concurrency.
+ * Converters may share a parsed blob, which is only read during conversion,
+ * but remapper callbacks must then be safe to call from multiple threads.
+ * If results is not NULL, it receives the result of every converter.
+ * Returns DXIL_SPV_SUCCESS only if all converters succeeded. */
+DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_converter_run_parallel(const dxil_spv_converter *converters,
+                                                                    unsigned count, unsigned num_threads,
+                                                                    dxil_spv_result *results);
+
+/* Asynchronous conversion.
+ * Runs dxil_spv_converter_run on an internal thread pool.
+ * The converter must not be used or freed until the async conversion is freed. */
+typedef struct dxil_spv_async_conversion_s *dxil_spv_async_conversion;
+DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_converter_run_async(dxil_spv_converter converter,
+                                                                 dxil_spv_async_conversion *conversion);
+/* Returns DXIL_SPV_TRUE once the conversion completed. If result is not NULL, it receives the result. */
+DXIL_SPV_PUBLIC_API dxil_spv_bool dxil_spv_async_conversion_poll(dxil_spv_async_conversion conversion,
+                                                                 dxil_spv_result *result);
+/* Blocks until the conversion completed, and returns its result. */
+DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_async_conversion_wait(dxil_spv_async_conversion conversion);
+/* Requests cancellation and returns immediately. The conversion stops at its next phase boundary
+ * or structurizer iteration, and then completes with DXIL_SPV_ERROR_CANCELLED. */
+DXIL_SPV_PUBLIC_API void dxil_spv_async_conversion_cancel(dxil_spv_async_conversion conversion);
+/* Cancels the conversion if still pending, and waits for it to stop. */
+DXIL_SPV_PUBLIC_API void dxil_spv_async_conversion_free(dxil_spv_async_conversion conversion);
+
+/* Converters are interactive by default. Only conversions started with dxil_spv_converter_run_async yield,
+ * a synchronous dxil_spv_converter_run never runs other conversions on the calling thread.
+ * A time budget does not count the time spent preempted. */
+DXIL_SPV_PUBLIC_API void dxil_spv_converter_set_priority(dxil_spv_converter converter, dxil_spv_priority priority);
+DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_get_queue_statistics(dxil_spv_priority priority,
+                                                                  dxil_spv_queue_statistics *stats);
+
 /* Obtain final SPIR-V. */
 DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_converter_get_compiled_spirv(dxil_spv_converter converter,
                                                                           dxil_spv_compiled_spirv *compiled);
@@ -393,6 +846,12 @@ DXIL_SPV_PUBLIC_API dxil_spv_bool dxil_spv_converter_supports_option(dxil_spv_op
 DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_converter_add_option(dxil_spv_converter converter,
                                                                   const dxil_spv_option_base *option);
 
+/* Opt-in collection of per-phase timing and counters. Must be enabled before dxil_spv_converter_run.
+ * Statistics can be queried after a successful run. */
+DXIL_SPV_PUBLIC_API void dxil_spv_converter_enable_statistics(dxil_spv_converter converter, dxil_spv_bool enable);
+DXIL_SPV_PUBLIC_API dxil_spv_result dxil_spv_converter_get_statistics(dxil_spv_converter converter,
+                                                                      dxil_spv_statistics *stats);
+
 /* Converter API */
 
 #ifdef __cplusplus
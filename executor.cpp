@@ -0,0 +1,169 @@
+/*
+ * Copyright 2019-2020 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "executor.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace dxil_spv
+{
+std::atomic<bool> Executor::global_created{ false };
+
+// Time spent in tasks run by yield() on this thread, so it can be excluded from the run time of the yielding task.
+static thread_local uint64_t preempted_ns;
+// Executor which owns the current thread, if any.
+static thread_local Executor *worker_executor;
+
+static uint64_t get_elapsed_ns(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+	return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
+
+Executor::Executor(unsigned num_threads)
+{
+	if (num_threads == 0)
+		num_threads = std::thread::hardware_concurrency();
+	if (num_threads == 0)
+		num_threads = 1;
+
+	threads.reserve(num_threads);
+	for (unsigned i = 0; i < num_threads; i++)
+		threads.emplace_back(&Executor::thread_main, this);
+}
+
+Executor::~Executor()
+{
+	{
+		std::lock_guard<std::mutex> holder{ lock };
+		dead = true;
+	}
+	cond.notify_all();
+
+	for (auto &thread : threads)
+		thread.join();
+}
+
+void Executor::submit(std::function<void()> task, ExecutorPriority priority)
+{
+	{
+		std::lock_guard<std::mutex> holder{ lock };
+		queues[int(priority)].push_back({ std::move(task), std::chrono::steady_clock::now() });
+	}
+	cond.notify_one();
+}
+
+ExecutorPriority Executor::find_queued_priority(ExecutorPriority end) const
+{
+	for (int i = 0; i < int(end); i++)
+		if (!queues[i].empty())
+			return ExecutorPriority(i);
+	return ExecutorPriority::Count;
+}
+
+void Executor::run_task(std::unique_lock<std::mutex> &holder, ExecutorPriority priority)
+{
+	auto &queue = queues[int(priority)];
+	auto &stats = statistics[int(priority)];
+
+	Task task = std::move(queue.front());
+	queue.pop_front();
+
+	auto start_time = std::chrono::steady_clock::now();
+	uint64_t wait_ns = get_elapsed_ns(task.submit_time, start_time);
+	stats.total_wait_ns += wait_ns;
+	stats.max_wait_ns = std::max(stats.max_wait_ns, wait_ns);
+	stats.num_running++;
+	holder.unlock();
+
+	uint64_t preempted_start_ns = preempted_ns;
+	task.func();
+	uint64_t run_ns = get_elapsed_ns(start_time, std::chrono::steady_clock::now());
+	run_ns -= std::min(run_ns, preempted_ns - preempted_start_ns);
+
+	holder.lock();
+	stats.num_running--;
+	stats.num_completed++;
+	stats.total_run_ns += run_ns;
+}
+
+void Executor::thread_main()
+{
+	worker_executor = this;
+	std::unique_lock<std::mutex> holder{ lock };
+	for (;;)
+	{
+		ExecutorPriority priority = ExecutorPriority::Count;
+		cond.wait(holder, [&]() {
+			priority = find_queued_priority(ExecutorPriority::Count);
+			return dead || priority != ExecutorPriority::Count;
+		});
+
+		if (priority == ExecutorPriority::Count)
+			return;
+
+		run_task(holder, priority);
+	}
+}
+
+uint64_t Executor::yield(ExecutorPriority priority)
+{
+	// Tasks submitted to this executor must never run on application threads.
+	if (worker_executor != this)
+		return 0;
+
+	auto start_time = std::chrono::steady_clock::now();
+	bool ran_task = false;
+
+	{
+		std::unique_lock<std::mutex> holder{ lock };
+		ExecutorPriority queued_priority;
+		while ((queued_priority = find_queued_priority(priority)) != ExecutorPriority::Count)
+		{
+			run_task(holder, queued_priority);
+			ran_task = true;
+		}
+	}
+
+	if (!ran_task)
+		return 0;
+
+	uint64_t elapsed_ns = get_elapsed_ns(start_time, std::chrono::steady_clock::now());
+	preempted_ns += elapsed_ns;
+	return elapsed_ns;
+}
+
+ExecutorStatistics Executor::get_statistics(ExecutorPriority priority)
+{
+	std::lock_guard<std::mutex> holder{ lock };
+	ExecutorStatistics stats = statistics[int(priority)];
+	stats.queue_depth = uint32_t(queues[int(priority)].size());
+	return stats;
+}
+
+Executor &Executor::get_global()
+{
+	static Executor executor(0);
+	global_created.store(true, std::memory_order_release);
+	return executor;
+}
+
+Executor *Executor::try_get_global()
+{
+	return global_created.load(std::memory_order_acquire) ? &get_global() : nullptr;
+}
+} // namespace dxil_spv
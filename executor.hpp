@@ -0,0 +1,103 @@
+/*
+ * Copyright 2019-2020 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+namespace dxil_spv
+{
+// Lower values run first.
+enum class ExecutorPriority
+{
+	Interactive = 0,
+	Background = 1,
+	Count
+};
+
+struct ExecutorStatistics
+{
+	uint32_t queue_depth = 0;
+	uint32_t num_running = 0;
+	uint32_t num_completed = 0;
+	// Time from submission until a task starts running.
+	uint64_t total_wait_ns = 0;
+	uint64_t max_wait_ns = 0;
+	// Time spent running, excluding time where higher priority tasks ran inside yield().
+	uint64_t total_run_ns = 0;
+};
+
+// Small thread pool which runs conversions in the background.
+// Each priority class is served in FIFO order, and higher priority classes are always served first.
+class Executor
+{
+public:
+	// num_threads = 0 uses the hardware concurrency.
+	explicit Executor(unsigned num_threads);
+	// Queued tasks still run before the threads are joined.
+	~Executor();
+	void operator=(const Executor &) = delete;
+	Executor(const Executor &) = delete;
+
+	void submit(std::function<void()> task, ExecutorPriority priority);
+
+	// Long-running tasks call this at safe points. Queued tasks with a higher priority than priority
+	// run on the calling thread before it returns, so they never wait for a slow task to complete.
+	// Only tasks running on a thread of this executor yield, other callers return immediately.
+	// Returns the time spent running other tasks.
+	uint64_t yield(ExecutorPriority priority);
+
+	ExecutorStatistics get_statistics(ExecutorPriority priority);
+
+	// Created on first use and destroyed at exit.
+	static Executor &get_global();
+	// Returns nullptr if get_global() was never called.
+	static Executor *try_get_global();
+
+private:
+	struct Task
+	{
+		std::function<void()> func;
+		std::chrono::steady_clock::time_point submit_time;
+	};
+
+	std::vector<std::thread> threads;
+	std::deque<Task> queues[int(ExecutorPriority::Count)];
+	ExecutorStatistics statistics[int(ExecutorPriority::Count)];
+	std::mutex lock;
+	std::condition_variable cond;
+	bool dead = false;
+
+	static std::atomic<bool> global_created;
+
+	void thread_main();
+	// Must be called with lock held. Returns the highest priority class below end with a queued task,
+	// or ExecutorPriority::Count if there is none.
+	ExecutorPriority find_queued_priority(ExecutorPriority end) const;
+	// Pops a task of priority and runs it. Must be called with lock held, which is released while running.
+	void run_task(std::unique_lock<std::mutex> &holder, ExecutorPriority priority);
+};
+} // namespace dxil_spv
@@ -139,6 +139,10 @@ struct Operation
 	spv::Id arguments[MaxArguments];
 	unsigned num_arguments = 0;
 	uint8_t literal_mask = 0;
+
+	// Set for operations which only read state that is constant for the whole invocation,
+	// e.g. resource handle creation. They can be moved out of loops if their arguments are loop invariant.
+	bool hoistable = false;
 };
 
 struct Terminator
@@ -47,10 +47,10 @@ LLVMBCParser::~LLVMBCParser()
 {
 }
 
-bool LLVMBCParser::parse(const void *data, size_t size)
+bool LLVMBCParser::parse(const void *data, size_t size, BudgetTracker *budget)
 {
 #ifdef HAVE_LLVMBC
-	impl->module = llvm::parseIR(impl->context, data, size);
+	impl->module = llvm::parseIR(impl->context, data, size, budget);
 	if (!impl->module)
 		return false;
 #else
@@ -64,6 +64,9 @@ bool LLVMBCParser::parse(const void *data, size_t size)
 		error.print("DXIL", llvm::errs());
 		return false;
 	}
+
+	if (budget && !budget->check())
+		return false;
 #endif
 
 	return true;
@@ -78,4 +81,13 @@ const llvm::Module &LLVMBCParser::get_module() const
 {
 	return *impl->module;
 }
+
+size_t LLVMBCParser::get_arena_bytes() const
+{
+#ifdef HAVE_LLVMBC
+	return impl->context.get_allocated_bytes();
+#else
+	return 0;
+#endif
+}
 } // namespace dxil_spv
\ No newline at end of file
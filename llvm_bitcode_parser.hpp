@@ -25,6 +25,7 @@
 #include <llvm/IR/Module.h>
 #endif
 
+#include "budget.hpp"
 #include <memory>
 #include <stddef.h>
 
@@ -35,9 +36,11 @@ class LLVMBCParser
 public:
 	LLVMBCParser();
 	~LLVMBCParser();
-	bool parse(const void *data, size_t size);
+	// With the LLVM backend, the budget is only checked once parsing completes.
+	bool parse(const void *data, size_t size, BudgetTracker *budget = nullptr);
 	llvm::Module &get_module();
 	const llvm::Module &get_module() const;
+	size_t get_arena_bytes() const;
 
 private:
 	struct Impl;
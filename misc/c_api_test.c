@@ -0,0 +1,512 @@
+/*
+ * Copyright 2019-2020 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+/* Tests the C APIs which work on DXBC containers directly, using containers built in memory,
+ * so no compiled shaders are needed. Written in C to make sure the header stays usable from C. */
+
+#include "dxil_spirv_c.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECK(cond)                                                                         \
+	do                                                                                      \
+	{                                                                                       \
+		if (!(cond))                                                                        \
+		{                                                                                   \
+			fprintf(stderr, "%s:%d: Check failed: %s\n", __FILE__, __LINE__, #cond);       \
+			return 0;                                                                       \
+		}                                                                                   \
+	} while (0)
+
+#define CONTAINER_HEADER_SIZE 32
+#define PART_HEADER_SIZE 8
+
+typedef struct test_part
+{
+	unsigned fourcc;
+	const void *data;
+	unsigned size;
+} test_part;
+
+static uint8_t *write_u32(uint8_t *ptr, uint32_t value)
+{
+	memcpy(ptr, &value, sizeof(value));
+	return ptr + sizeof(value);
+}
+
+static uint8_t *write_u16(uint8_t *ptr, uint16_t value)
+{
+	memcpy(ptr, &value, sizeof(value));
+	return ptr + sizeof(value);
+}
+
+/* Serializes a container with the given parts. Returns the size, or 0 if it does not fit. */
+static size_t build_container(const test_part *parts, unsigned count, uint8_t *out, size_t capacity)
+{
+	size_t size = CONTAINER_HEADER_SIZE + count * sizeof(uint32_t);
+	unsigned i;
+	uint8_t *ptr;
+
+	for (i = 0; i < count; i++)
+		size += PART_HEADER_SIZE + parts[i].size;
+	if (size > capacity)
+		return 0;
+
+	memset(out, 0, CONTAINER_HEADER_SIZE);
+	ptr = write_u32(out, DXIL_SPV_FOURCC('D', 'X', 'B', 'C'));
+	ptr += 16;
+	ptr = write_u16(ptr, 1);
+	ptr = write_u16(ptr, 0);
+	ptr = write_u32(ptr, (uint32_t)size);
+	ptr = write_u32(ptr, count);
+
+	{
+		uint8_t *part_ptr = ptr + count * sizeof(uint32_t);
+		for (i = 0; i < count; i++)
+		{
+			ptr = write_u32(ptr, (uint32_t)(part_ptr - out));
+			part_ptr = write_u32(part_ptr, parts[i].fourcc);
+			part_ptr = write_u32(part_ptr, parts[i].size);
+			if (parts[i].size)
+				memcpy(part_ptr, parts[i].data, parts[i].size);
+			part_ptr += parts[i].size;
+		}
+	}
+
+	return size;
+}
+
+static int test_container_index(void)
+{
+	enum { NumPrivateParts = 40 };
+	static const uint8_t bitcode[] = { 'B', 'C', 0xc0, 0xde, 1, 2, 3, 4 };
+	uint32_t private_data[NumPrivateParts];
+	uint8_t program[24 + sizeof(bitcode)];
+	test_part parts[NumPrivateParts + 1];
+	dxil_spv_container_part indexed[NumPrivateParts + 1];
+	static uint8_t container[4096];
+	const void *found_bitcode;
+	size_t found_bitcode_size;
+	unsigned count, i;
+	size_t size;
+	uint8_t *ptr;
+
+	/* More parts than the index used to have room for. */
+	for (i = 0; i < NumPrivateParts; i++)
+	{
+		private_data[i] = i;
+		parts[i].fourcc = DXIL_SPV_FOURCC('P', 'R', 'I', 'V');
+		parts[i].data = &private_data[i];
+		parts[i].size = sizeof(uint32_t);
+	}
+
+	/* The bitcode offset is relative to the DXIL magic, which is 8 bytes into the program header. */
+	ptr = write_u32(program, 0x60);
+	ptr = write_u32(ptr, (uint32_t)(sizeof(program) / sizeof(uint32_t)));
+	ptr = write_u32(ptr, DXIL_SPV_FOURCC('D', 'X', 'I', 'L'));
+	ptr = write_u32(ptr, 0x100);
+	ptr = write_u32(ptr, 16);
+	ptr = write_u32(ptr, sizeof(bitcode));
+	memcpy(ptr, bitcode, sizeof(bitcode));
+
+	parts[NumPrivateParts].fourcc = DXIL_SPV_FOURCC('D', 'X', 'I', 'L');
+	parts[NumPrivateParts].data = program;
+	parts[NumPrivateParts].size = sizeof(program);
+
+	size = build_container(parts, NumPrivateParts + 1, container, sizeof(container));
+	CHECK(size != 0);
+
+	count = 0;
+	CHECK(dxil_spv_index_dxil_container(container, size, NULL, &count) == DXIL_SPV_SUCCESS);
+	CHECK(count == NumPrivateParts + 1);
+
+	/* Too small capacity reports the required count. */
+	count = 4;
+	CHECK(dxil_spv_index_dxil_container(container, size, indexed, &count) == DXIL_SPV_ERROR_GENERIC);
+	CHECK(count == NumPrivateParts + 1);
+
+	CHECK(dxil_spv_index_dxil_container(container, size, indexed, &count) == DXIL_SPV_SUCCESS);
+	CHECK(count == NumPrivateParts + 1);
+	for (i = 0; i < count; i++)
+	{
+		CHECK(indexed[i].fourcc == parts[i].fourcc);
+		CHECK(indexed[i].size == parts[i].size);
+		CHECK(indexed[i].offset + indexed[i].size <= size);
+		CHECK(memcmp(container + indexed[i].offset, parts[i].data, parts[i].size) == 0);
+	}
+
+	CHECK(dxil_spv_find_dxil_bitcode(container, size, &found_bitcode, &found_bitcode_size) == DXIL_SPV_SUCCESS);
+	CHECK(found_bitcode_size == sizeof(bitcode));
+	CHECK(memcmp(found_bitcode, bitcode, sizeof(bitcode)) == 0);
+	CHECK((const uint8_t *)found_bitcode >= container && (const uint8_t *)found_bitcode < container + size);
+
+	/* The last part no longer fits. */
+	CHECK(dxil_spv_index_dxil_container(container, size - 1, NULL, &count) == DXIL_SPV_ERROR_PARSER);
+
+	/* A part count which cannot fit in the container. */
+	write_u32(container + 28, 0x10000000);
+	CHECK(dxil_spv_index_dxil_container(container, size, NULL, &count) == DXIL_SPV_ERROR_PARSER);
+
+	/* Not a container. */
+	write_u32(container, DXIL_SPV_FOURCC('D', 'X', 'I', 'L'));
+	CHECK(dxil_spv_index_dxil_container(container, size, NULL, &count) == DXIL_SPV_ERROR_PARSER);
+
+	return 1;
+}
+
+/* Builds a PSV0 part with version 1 runtime info, no resources and no signature elements. */
+static size_t build_psv_container(uint8_t psv_stage, uint32_t runtime_info_size, uint8_t *out, size_t capacity)
+{
+	uint8_t psv[4 + 36 + 12];
+	test_part part;
+	uint8_t *ptr;
+
+	memset(psv, 0, sizeof(psv));
+	ptr = write_u32(psv, runtime_info_size);
+	/* PSVRuntimeInfo0 is 24 bytes, the stage is the first member of PSVRuntimeInfo1. */
+	ptr[24] = psv_stage;
+	ptr += runtime_info_size;
+	/* Resource count, string table size and semantic index count. */
+	ptr = write_u32(ptr, 0);
+	ptr = write_u32(ptr, 0);
+	ptr = write_u32(ptr, 0);
+
+	part.fourcc = DXIL_SPV_FOURCC('P', 'S', 'V', '0');
+	part.data = psv;
+	part.size = (unsigned)(ptr - psv);
+	return build_container(&part, 1, out, capacity);
+}
+
+static int test_psv_shader_stage(void)
+{
+	/* PSV numbers stages differently from DXIL::ShaderKind past Library. */
+	static const struct
+	{
+		uint8_t psv_stage;
+		dxil_spv_result result;
+		dxil_spv_shader_stage stage;
+	} cases[] = {
+		{ 0, DXIL_SPV_SUCCESS, DXIL_SPV_STAGE_PIXEL },
+		{ 1, DXIL_SPV_SUCCESS, DXIL_SPV_STAGE_VERTEX },
+		{ 2, DXIL_SPV_SUCCESS, DXIL_SPV_STAGE_GEOMETRY },
+		{ 3, DXIL_SPV_SUCCESS, DXIL_SPV_STAGE_HULL },
+		{ 4, DXIL_SPV_SUCCESS, DXIL_SPV_STAGE_DOMAIN },
+		{ 5, DXIL_SPV_SUCCESS, DXIL_SPV_STAGE_COMPUTE },
+		/* Library, mesh and amplification. */
+		{ 6, DXIL_SPV_SUCCESS, DXIL_SPV_STAGE_UNKNOWN },
+		{ 7, DXIL_SPV_SUCCESS, DXIL_SPV_STAGE_UNKNOWN },
+		{ 8, DXIL_SPV_SUCCESS, DXIL_SPV_STAGE_UNKNOWN },
+		{ 9, DXIL_SPV_ERROR_UNSUPPORTED_FEATURE, DXIL_SPV_STAGE_UNKNOWN },
+	};
+	uint8_t container[256];
+	dxil_spv_shader_stage stage;
+	unsigned count, i;
+	size_t size;
+
+	for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+	{
+		size = build_psv_container(cases[i].psv_stage, 36, container, sizeof(container));
+		CHECK(size != 0);
+
+		stage = DXIL_SPV_STAGE_INT_MAX;
+		CHECK(dxil_spv_psv_get_shader_stage(container, size, &stage) == cases[i].result);
+		if (cases[i].result == DXIL_SPV_SUCCESS)
+			CHECK(stage == cases[i].stage);
+
+		CHECK(dxil_spv_psv_get_resource_bindings(container, size, NULL, &count) == DXIL_SPV_SUCCESS);
+		CHECK(count == 0);
+	}
+
+	/* Version 0 runtime info does not record the stage. */
+	size = build_psv_container(0, 24, container, sizeof(container));
+	CHECK(size != 0);
+	CHECK(dxil_spv_psv_get_shader_stage(container, size, &stage) == DXIL_SPV_ERROR_UNSUPPORTED_FEATURE);
+
+	return 1;
+}
+
+#define RTS0_APPEND 0xffffffffu
+#define RTS0_UNBOUNDED 0xffffffffu
+
+static uint8_t *write_range(uint8_t *ptr, uint32_t version, uint32_t type, uint32_t count, uint32_t base_register,
+                            uint32_t register_space, uint32_t offset_in_table)
+{
+	ptr = write_u32(ptr, type);
+	ptr = write_u32(ptr, count);
+	ptr = write_u32(ptr, base_register);
+	ptr = write_u32(ptr, register_space);
+	/* Version 1.1 adds range flags. */
+	if (version == 2)
+		ptr = write_u32(ptr, 0);
+	return write_u32(ptr, offset_in_table);
+}
+
+static uint8_t *write_parameter(uint8_t *ptr, uint32_t type, uint32_t visibility, uint32_t payload_offset)
+{
+	ptr = write_u32(ptr, type);
+	ptr = write_u32(ptr, visibility);
+	return write_u32(ptr, payload_offset);
+}
+
+/* Builds an RTS0 part with the layout:
+ * 0: table (all) { SRV t0-t3, UAV u1-u2 appended, SRV space1 t8 unbounded appended }
+ * 1: 4 root constants (pixel) at b0
+ * 2: root UAV u0, space2
+ * 3: table (vertex) { sampler s0-s1 }
+ * Static sampler s4 (pixel). */
+static size_t build_root_signature_container(uint32_t version, uint8_t *out, size_t capacity)
+{
+	uint8_t rts0[512];
+	uint32_t table0, table1, ranges0, ranges1, constants, descriptor, samplers;
+	uint8_t *ptr;
+	test_part part;
+	unsigned i;
+
+	memset(rts0, 0, sizeof(rts0));
+
+	/* Payloads follow the descriptor and the four root parameters. */
+	ptr = rts0 + 24 + 4 * 12;
+
+	table0 = (uint32_t)(ptr - rts0);
+	ptr = write_u32(ptr, 3);
+	ranges0 = (uint32_t)(ptr - rts0) + 4;
+	ptr = write_u32(ptr, ranges0);
+	ptr = write_range(ptr, version, 0, 4, 0, 0, 0);
+	ptr = write_range(ptr, version, 1, 2, 1, 0, RTS0_APPEND);
+	ptr = write_range(ptr, version, 0, RTS0_UNBOUNDED, 8, 1, RTS0_APPEND);
+
+	constants = (uint32_t)(ptr - rts0);
+	ptr = write_u32(ptr, 0);
+	ptr = write_u32(ptr, 0);
+	ptr = write_u32(ptr, 4);
+
+	descriptor = (uint32_t)(ptr - rts0);
+	ptr = write_u32(ptr, 0);
+	ptr = write_u32(ptr, 2);
+	if (version == 2)
+		ptr = write_u32(ptr, 0);
+
+	table1 = (uint32_t)(ptr - rts0);
+	ptr = write_u32(ptr, 1);
+	ranges1 = (uint32_t)(ptr - rts0) + 4;
+	ptr = write_u32(ptr, ranges1);
+	ptr = write_range(ptr, version, 3, 2, 0, 0, 0);
+
+	/* The register index, space and visibility are the last three words of a static sampler. */
+	samplers = (uint32_t)(ptr - rts0);
+	for (i = 0; i < 10; i++)
+		ptr = write_u32(ptr, 0);
+	ptr = write_u32(ptr, 4);
+	ptr = write_u32(ptr, 0);
+	ptr = write_u32(ptr, 5);
+
+	part.fourcc = DXIL_SPV_FOURCC('R', 'T', 'S', '0');
+	part.data = rts0;
+	part.size = (unsigned)(ptr - rts0);
+
+	ptr = write_u32(rts0, version);
+	ptr = write_u32(ptr, 4);
+	ptr = write_u32(ptr, 24);
+	ptr = write_u32(ptr, 1);
+	ptr = write_u32(ptr, samplers);
+	ptr = write_u32(ptr, 0);
+
+	ptr = write_parameter(ptr, 0, 0, table0);
+	ptr = write_parameter(ptr, 1, 5, constants);
+	ptr = write_parameter(ptr, 4, 0, descriptor);
+	write_parameter(ptr, 0, 1, table1);
+
+	return build_container(&part, 1, out, capacity);
+}
+
+static int test_root_signature(void)
+{
+	/* Sorted by resource class, register space and register index. */
+	static const dxil_spv_root_signature_binding expected[] = {
+		{ DXIL_SPV_ROOT_SIGNATURE_BINDING_DESCRIPTOR_TABLE, DXIL_SPV_RESOURCE_CLASS_SRV, 0, 0, 0, 4, 0, 0, 0 },
+		{ DXIL_SPV_ROOT_SIGNATURE_BINDING_DESCRIPTOR_TABLE, DXIL_SPV_RESOURCE_CLASS_SRV, 0, 1, 8, RTS0_UNBOUNDED,
+		  0, 0, 6 },
+		{ DXIL_SPV_ROOT_SIGNATURE_BINDING_DESCRIPTOR_TABLE, DXIL_SPV_RESOURCE_CLASS_UAV, 0, 0, 1, 2, 0, 0, 4 },
+		{ DXIL_SPV_ROOT_SIGNATURE_BINDING_ROOT_DESCRIPTOR, DXIL_SPV_RESOURCE_CLASS_UAV, 0, 2, 0, 1, 2, 0, 0 },
+		{ DXIL_SPV_ROOT_SIGNATURE_BINDING_ROOT_CONSTANTS, DXIL_SPV_RESOURCE_CLASS_CBV, 5, 0, 0, 1, 1, 1, 0 },
+		{ DXIL_SPV_ROOT_SIGNATURE_BINDING_DESCRIPTOR_TABLE, DXIL_SPV_RESOURCE_CLASS_SAMPLER, 1, 0, 0, 2, 3, 5, 0 },
+		{ DXIL_SPV_ROOT_SIGNATURE_BINDING_STATIC_SAMPLER, DXIL_SPV_RESOURCE_CLASS_SAMPLER, 5, 0, 4, 1, 0, 0, 0 },
+	};
+	const unsigned expected_count = sizeof(expected) / sizeof(expected[0]);
+	dxil_spv_root_signature_binding bindings[8];
+	dxil_spv_root_signature rs;
+	uint8_t container[1024];
+	unsigned count, i;
+	uint32_t version;
+	size_t size;
+
+	/* 1 = version 1.0, 2 = version 1.1. */
+	for (version = 1; version <= 2; version++)
+	{
+		size = build_root_signature_container(version, container, sizeof(container));
+		CHECK(size != 0);
+		CHECK(dxil_spv_parse_root_signature(container, size, &rs) == DXIL_SPV_SUCCESS);
+
+		/* One word per table and the declared root constant words. */
+		CHECK(dxil_spv_root_signature_get_root_constant_word_count(rs) == 6);
+
+		CHECK(dxil_spv_root_signature_get_bindings(rs, NULL, &count) == DXIL_SPV_SUCCESS);
+		CHECK(count == expected_count);
+		count = expected_count - 1;
+		CHECK(dxil_spv_root_signature_get_bindings(rs, bindings, &count) == DXIL_SPV_ERROR_GENERIC);
+		CHECK(count == expected_count);
+		count = sizeof(bindings) / sizeof(bindings[0]);
+		CHECK(dxil_spv_root_signature_get_bindings(rs, bindings, &count) == DXIL_SPV_SUCCESS);
+		CHECK(count == expected_count);
+
+		for (i = 0; i < count; i++)
+		{
+			CHECK(bindings[i].type == expected[i].type);
+			CHECK(bindings[i].resource_class == expected[i].resource_class);
+			CHECK(bindings[i].visibility == expected[i].visibility);
+			CHECK(bindings[i].register_space == expected[i].register_space);
+			CHECK(bindings[i].register_index == expected[i].register_index);
+			CHECK(bindings[i].num_descriptors == expected[i].num_descriptors);
+			CHECK(bindings[i].parameter_index == expected[i].parameter_index);
+			CHECK(bindings[i].root_constant_word == expected[i].root_constant_word);
+			CHECK(bindings[i].offset_in_table == expected[i].offset_in_table);
+		}
+
+		dxil_spv_root_signature_free(rs);
+	}
+
+	/* Unknown root signature version. */
+	size = build_root_signature_container(3, container, sizeof(container));
+	CHECK(size != 0);
+	CHECK(dxil_spv_parse_root_signature(container, size, &rs) != DXIL_SPV_SUCCESS);
+
+	/* No RTS0 part. */
+	size = build_psv_container(0, 36, container, sizeof(container));
+	CHECK(size != 0);
+	CHECK(dxil_spv_parse_root_signature(container, size, &rs) != DXIL_SPV_SUCCESS);
+
+	return 1;
+}
+
+static dxil_spv_vulkan_binding make_vulkan_binding(unsigned set, unsigned binding)
+{
+	dxil_spv_vulkan_binding vk_binding;
+	memset(&vk_binding, 0, sizeof(vk_binding));
+	vk_binding.set = set;
+	vk_binding.binding = binding;
+	return vk_binding;
+}
+
+static int test_remapping_table(void)
+{
+	dxil_spv_uav_vulkan_binding uav, found_uav;
+	dxil_spv_cbv_vulkan_binding cbv, found_cbv;
+	dxil_spv_vulkan_binding srv, found;
+	dxil_spv_remapping_table table;
+	unsigned i;
+
+	CHECK(dxil_spv_create_remapping_table(&table) == DXIL_SPV_SUCCESS);
+	dxil_spv_remapping_table_reserve(table, 1024);
+
+	/* Enough entries to force rehashing past the reserved size. */
+	for (i = 0; i < 2048; i++)
+	{
+		srv = make_vulkan_binding(i & 7, i);
+		dxil_spv_remapping_table_add_srv(table, DXIL_SPV_STAGE_UNKNOWN, i & 7, i, &srv);
+	}
+
+	for (i = 0; i < 2048; i++)
+	{
+		CHECK(dxil_spv_remapping_table_find_srv(table, DXIL_SPV_STAGE_PIXEL, i & 7, i, &found));
+		CHECK(found.set == (i & 7) && found.binding == i);
+	}
+
+	/* A stage specific entry wins over the DXIL_SPV_STAGE_UNKNOWN fallback, for that stage only. */
+	srv = make_vulkan_binding(9, 100);
+	srv.bindless.use_heap = DXIL_SPV_TRUE;
+	srv.bindless.root_constant_word = 3;
+	srv.bindless.heap_root_offset = 17;
+	dxil_spv_remapping_table_add_srv(table, DXIL_SPV_STAGE_PIXEL, 0, 0, &srv);
+
+	CHECK(dxil_spv_remapping_table_find_srv(table, DXIL_SPV_STAGE_PIXEL, 0, 0, &found));
+	CHECK(found.set == 9 && found.binding == 100);
+	CHECK(found.bindless.use_heap && found.bindless.root_constant_word == 3 && found.bindless.heap_root_offset == 17);
+	CHECK(dxil_spv_remapping_table_find_srv(table, DXIL_SPV_STAGE_VERTEX, 0, 0, &found));
+	CHECK(found.set == 0 && found.binding == 0 && !found.bindless.use_heap);
+	CHECK(dxil_spv_remapping_table_find_srv(table, DXIL_SPV_STAGE_UNKNOWN, 0, 0, &found));
+	CHECK(found.binding == 0);
+
+	/* Adding the same key again replaces the entry. */
+	srv = make_vulkan_binding(10, 200);
+	dxil_spv_remapping_table_add_srv(table, DXIL_SPV_STAGE_PIXEL, 0, 0, &srv);
+	CHECK(dxil_spv_remapping_table_find_srv(table, DXIL_SPV_STAGE_PIXEL, 0, 0, &found));
+	CHECK(found.set == 10 && found.binding == 200 && !found.bindless.use_heap);
+
+	/* Resource classes do not alias. */
+	CHECK(!dxil_spv_remapping_table_find_sampler(table, DXIL_SPV_STAGE_PIXEL, 0, 0, &found));
+	CHECK(!dxil_spv_remapping_table_find_uav(table, DXIL_SPV_STAGE_PIXEL, 0, 0, &found_uav));
+	CHECK(!dxil_spv_remapping_table_find_cbv(table, DXIL_SPV_STAGE_PIXEL, 0, 0, &found_cbv));
+	CHECK(!dxil_spv_remapping_table_find_srv(table, DXIL_SPV_STAGE_PIXEL, 8, 0, &found));
+
+	srv = make_vulkan_binding(1, 2);
+	dxil_spv_remapping_table_add_sampler(table, DXIL_SPV_STAGE_COMPUTE, 0, 0, &srv);
+	CHECK(dxil_spv_remapping_table_find_sampler(table, DXIL_SPV_STAGE_COMPUTE, 0, 0, &found));
+	CHECK(found.set == 1 && found.binding == 2);
+	CHECK(!dxil_spv_remapping_table_find_sampler(table, DXIL_SPV_STAGE_PIXEL, 0, 0, &found));
+
+	uav.buffer_binding = make_vulkan_binding(2, 5);
+	uav.counter_binding = make_vulkan_binding(3, 6);
+	dxil_spv_remapping_table_add_uav(table, DXIL_SPV_STAGE_UNKNOWN, 1, 4, &uav);
+	CHECK(dxil_spv_remapping_table_find_uav(table, DXIL_SPV_STAGE_COMPUTE, 1, 4, &found_uav));
+	CHECK(found_uav.buffer_binding.set == 2 && found_uav.buffer_binding.binding == 5);
+	CHECK(found_uav.counter_binding.set == 3 && found_uav.counter_binding.binding == 6);
+
+	memset(&cbv, 0, sizeof(cbv));
+	cbv.push_constant = DXIL_SPV_TRUE;
+	cbv.vulkan.push_constant.offset_in_words = 12;
+	dxil_spv_remapping_table_add_cbv(table, DXIL_SPV_STAGE_UNKNOWN, 0, 0, &cbv);
+	CHECK(dxil_spv_remapping_table_find_cbv(table, DXIL_SPV_STAGE_PIXEL, 0, 0, &found_cbv));
+	CHECK(found_cbv.push_constant && found_cbv.vulkan.push_constant.offset_in_words == 12);
+
+	cbv.push_constant = DXIL_SPV_FALSE;
+	cbv.vulkan.uniform_binding = make_vulkan_binding(4, 7);
+	dxil_spv_remapping_table_add_cbv(table, DXIL_SPV_STAGE_UNKNOWN, 0, 0, &cbv);
+	CHECK(dxil_spv_remapping_table_find_cbv(table, DXIL_SPV_STAGE_PIXEL, 0, 0, &found_cbv));
+	CHECK(!found_cbv.push_constant);
+	CHECK(found_cbv.vulkan.uniform_binding.set == 4 && found_cbv.vulkan.uniform_binding.binding == 7);
+
+	dxil_spv_remapping_table_free(table);
+	return 1;
+}
+
+int main(void)
+{
+	int ok = 1;
+	ok = test_container_index() && ok;
+	ok = test_psv_shader_stage() && ok;
+	ok = test_root_signature() && ok;
+	ok = test_remapping_table() && ok;
+
+	if (!ok)
+		return EXIT_FAILURE;
+
+	printf("Tests completed!\n");
+	return EXIT_SUCCESS;
+}
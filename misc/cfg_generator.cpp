@@ -0,0 +1,282 @@
+/*
+ * Copyright 2019-2020 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "cfg_generator.hpp"
+#include "SpvBuilder.h"
+#include "node.hpp"
+#include "node_pool.hpp"
+#include "spirv_module.hpp"
+
+namespace dxil_spv
+{
+const char *cfg_shape_to_string(CFGShape shape)
+{
+	switch (shape)
+	{
+	case CFGShape::LoopNest:
+		return "loop-nest";
+	case CFGShape::WideSwitch:
+		return "wide-switch";
+	case CFGShape::DiamondChain:
+		return "diamond-chain";
+	case CFGShape::MultiExitLoop:
+		return "multi-exit-loop";
+	case CFGShape::BreakLadder:
+		return "break-ladder";
+	default:
+		return "unknown";
+	}
+}
+
+CFGGenerator::CFGGenerator(CFGNodePool &pool_, SPIRVModule &module_)
+    : pool(pool_)
+    , module(module_)
+{
+}
+
+unsigned CFGGenerator::get_node_count() const
+{
+	return node_count;
+}
+
+CFGNode *CFGGenerator::create_node(const char *tag)
+{
+	auto *node = pool.create_node();
+	node->name = std::string(tag) + "." + std::to_string(node_count++);
+	node->ir.terminator.type = Terminator::Type::Return;
+	return node;
+}
+
+void CFGGenerator::add_branch(CFGNode *from, CFGNode *to)
+{
+	from->add_branch(to);
+	from->ir.terminator.type = Terminator::Type::Branch;
+	from->ir.terminator.direct_block = to;
+}
+
+void CFGGenerator::add_selection(CFGNode *from, CFGNode *to0, CFGNode *to1)
+{
+	auto &builder = module.get_builder();
+	from->add_branch(to0);
+	from->add_branch(to1);
+	from->ir.terminator.type = Terminator::Type::Condition;
+	from->ir.terminator.true_block = to0;
+	from->ir.terminator.false_block = to1;
+	// Use spec constants so nothing can be folded away.
+	from->ir.terminator.conditional_id = builder.makeBoolConstant(true, true);
+}
+
+void CFGGenerator::add_switch(CFGNode *from, const std::vector<CFGNode *> &cases, CFGNode *default_node)
+{
+	auto &builder = module.get_builder();
+	from->ir.terminator.type = Terminator::Type::Switch;
+	from->ir.terminator.conditional_id = builder.makeUintConstant(0, true);
+	from->ir.terminator.default_node = default_node;
+
+	for (size_t i = 0; i < cases.size(); i++)
+	{
+		from->add_branch(cases[i]);
+		from->ir.terminator.cases.push_back({ cases[i], uint32_t(i) });
+	}
+	from->add_branch(default_node);
+}
+
+void CFGGenerator::add_phi(CFGNode *node, const std::vector<CFGNode *> &incoming)
+{
+	auto &builder = module.get_builder();
+	PHI phi;
+	phi.type_id = builder.makeUintType(32);
+	phi.id = module.allocate_id();
+
+	for (auto *block : incoming)
+	{
+		IncomingValue value = {};
+		value.block = block;
+		value.id = builder.makeUintConstant(uint32_t(phi.incoming.size()), true);
+		phi.incoming.push_back(value);
+	}
+
+	node->ir.phi.push_back(std::move(phi));
+}
+
+// header -> (inner loop or body) -> latch -> header / merge
+CFGNode *CFGGenerator::build_loop_nest(CFGNode *pred, unsigned depth)
+{
+	auto *header = create_node("header");
+	add_branch(pred, header);
+
+	CFGNode *body_exit = header;
+	if (depth > 1)
+		body_exit = build_loop_nest(header, depth - 1);
+
+	auto *latch = create_node("latch");
+	auto *merge = create_node("merge");
+	add_branch(body_exit, latch);
+	add_selection(latch, header, merge);
+	return merge;
+}
+
+// Every third case falls through into the next case.
+CFGNode *CFGGenerator::build_wide_switch(CFGNode *pred, unsigned num_cases)
+{
+	auto *selector = create_node("switch");
+	add_branch(pred, selector);
+
+	auto *merge = create_node("merge");
+	auto *default_node = create_node("default");
+	add_branch(default_node, merge);
+
+	std::vector<CFGNode *> cases;
+	for (unsigned i = 0; i < num_cases; i++)
+		cases.push_back(create_node("case"));
+
+	for (unsigned i = 0; i < num_cases; i++)
+	{
+		if (i % 3 == 0 && i + 1 < num_cases)
+			add_branch(cases[i], cases[i + 1]);
+		else
+			add_branch(cases[i], merge);
+	}
+
+	add_switch(selector, cases, default_node);
+	return merge;
+}
+
+// if/else diamonds in sequence, each join has a PHI.
+CFGNode *CFGGenerator::build_diamond_chain(CFGNode *pred, unsigned length)
+{
+	for (unsigned i = 0; i < length; i++)
+	{
+		auto *top = create_node("top");
+		auto *a = create_node("a");
+		auto *b = create_node("b");
+		auto *join = create_node("join");
+		add_branch(pred, top);
+		add_selection(top, a, b);
+		add_branch(a, join);
+		add_branch(b, join);
+		add_phi(join, { a, b });
+		pred = join;
+	}
+
+	return pred;
+}
+
+// A loop whose body can break out at every step, alternating between
+// breaking to the loop merge and breaking to a block after the merge.
+CFGNode *CFGGenerator::build_multi_exit_loop(CFGNode *pred, unsigned num_exits)
+{
+	auto *header = create_node("header");
+	auto *merge = create_node("merge");
+	auto *outer = create_node("outer");
+	add_branch(pred, header);
+
+	std::vector<CFGNode *> outer_preds;
+	CFGNode *body = header;
+	for (unsigned i = 0; i < num_exits; i++)
+	{
+		auto *next = create_node("body");
+		if (i & 1)
+		{
+			add_selection(body, next, outer);
+			outer_preds.push_back(body);
+		}
+		else
+			add_selection(body, next, merge);
+		body = next;
+	}
+
+	add_selection(body, header, merge);
+	add_branch(merge, outer);
+	outer_preds.push_back(merge);
+	add_phi(outer, outer_preds);
+
+	return outer;
+}
+
+// Nested loops where the innermost body breaks out of every level at once.
+CFGNode *CFGGenerator::build_break_ladder(CFGNode *pred, unsigned depth)
+{
+	auto *exit = create_node("exit");
+
+	std::vector<CFGNode *> headers;
+	std::vector<CFGNode *> merges;
+	for (unsigned i = 0; i < depth; i++)
+	{
+		auto *header = create_node("header");
+		add_branch(pred, header);
+		headers.push_back(header);
+		merges.push_back(create_node("merge"));
+		pred = header;
+	}
+
+	auto *body = create_node("body");
+	auto *cont = create_node("continue");
+	add_branch(pred, body);
+	add_selection(body, exit, cont);
+
+	// Unwind the nest. Each latch either loops or falls out to the next enclosing level.
+	CFGNode *inner_exit = cont;
+	for (unsigned i = depth; i; i--)
+	{
+		add_selection(inner_exit, headers[i - 1], merges[i - 1]);
+		inner_exit = merges[i - 1];
+	}
+
+	add_branch(inner_exit, exit);
+	return exit;
+}
+
+CFGNode *CFGGenerator::generate(CFGShape shape, unsigned scale)
+{
+	if (scale == 0)
+		scale = 1;
+
+	auto *entry = create_node("entry");
+	CFGNode *exit = nullptr;
+
+	switch (shape)
+	{
+	case CFGShape::LoopNest:
+		exit = build_loop_nest(entry, scale);
+		break;
+
+	case CFGShape::WideSwitch:
+		exit = build_wide_switch(entry, scale);
+		break;
+
+	case CFGShape::DiamondChain:
+		exit = build_diamond_chain(entry, scale);
+		break;
+
+	case CFGShape::MultiExitLoop:
+		exit = build_multi_exit_loop(entry, scale);
+		break;
+
+	case CFGShape::BreakLadder:
+		exit = build_break_ladder(entry, scale);
+		break;
+
+	default:
+		return nullptr;
+	}
+
+	exit->ir.terminator.type = Terminator::Type::Return;
+	return entry;
+}
+} // namespace dxil_spv
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2019-2020 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace dxil_spv
+{
+struct CFGNode;
+class CFGNodePool;
+class SPIRVModule;
+
+enum class CFGShape
+{
+	LoopNest,
+	WideSwitch,
+	DiamondChain,
+	MultiExitLoop,
+	BreakLadder,
+	Count
+};
+
+const char *cfg_shape_to_string(CFGShape shape);
+
+// Builds synthetic CFGs through CFGNodePool for stress testing and benchmarking the structurizer.
+// Scale controls the size of the graph, e.g. loop nest depth or number of switch cases.
+class CFGGenerator
+{
+public:
+	CFGGenerator(CFGNodePool &pool, SPIRVModule &module);
+	CFGNode *generate(CFGShape shape, unsigned scale);
+	unsigned get_node_count() const;
+
+private:
+	CFGNodePool &pool;
+	SPIRVModule &module;
+	unsigned node_count = 0;
+
+	CFGNode *create_node(const char *tag);
+	void add_branch(CFGNode *from, CFGNode *to);
+	void add_selection(CFGNode *from, CFGNode *to0, CFGNode *to1);
+	void add_switch(CFGNode *from, const std::vector<CFGNode *> &cases, CFGNode *default_node);
+	void add_phi(CFGNode *node, const std::vector<CFGNode *> &incoming);
+
+	CFGNode *build_loop_nest(CFGNode *pred, unsigned depth);
+	CFGNode *build_wide_switch(CFGNode *pred, unsigned num_cases);
+	CFGNode *build_diamond_chain(CFGNode *pred, unsigned length);
+	CFGNode *build_multi_exit_loop(CFGNode *pred, unsigned num_exits);
+	CFGNode *build_break_ladder(CFGNode *pred, unsigned depth);
+};
+} // namespace dxil_spv
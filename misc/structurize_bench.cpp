@@ -0,0 +1,328 @@
+/*
+ * Copyright 2019-2020 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "cfg_generator.hpp"
+#include "cfg_structurizer.hpp"
+#include "cli_parser.hpp"
+#include "logging.hpp"
+#include "node_pool.hpp"
+#include "spirv_module.hpp"
+#include "statistics.hpp"
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace dxil_spv;
+
+// Times CFGStructurizer::run on synthetic CFGs of increasing size, so
+// super-linear behavior shows up as a growing time per node.
+// Growth is the time per node relative to the smallest scale of the same shape,
+// which does not depend on how fast the machine or the build is.
+// With --baseline, only the samples of a committed baseline are run, and the run fails
+// if helper blocks or PHIs grow, or if growth regresses beyond a tolerance.
+
+static void print_help()
+{
+	LOGE("dxil-spirv-structurize-bench\n"
+	     "\t[--max-scale count]\n"
+	     "\t[--iterations count]\n"
+	     "\t[--max-ms milliseconds]\n"
+	     "\t[--baseline path.csv]\n"
+	     "\t[--tolerance factor]\n"
+	     "\t[--write-baseline path.csv]\n");
+}
+
+struct Sample
+{
+	unsigned nodes = 0;
+	double ms = 0.0;
+	Statistics stats;
+};
+
+static Sample run_structurizer(CFGShape shape, unsigned scale)
+{
+	Sample sample;
+	CFGNodePool pool;
+	SPIRVModule module;
+	CFGGenerator generator(pool, module);
+
+	auto *entry = generator.generate(shape, scale);
+	sample.nodes = generator.get_node_count();
+
+	CFGStructurizer structurizer(entry, pool, module);
+	structurizer.set_statistics(&sample.stats);
+	auto start = std::chrono::steady_clock::now();
+	structurizer.run();
+	auto end = std::chrono::steady_clock::now();
+	sample.ms = std::chrono::duration<double, std::milli>(end - start).count();
+	return sample;
+}
+
+struct BaselineSample
+{
+	CFGShape shape;
+	unsigned scale;
+	unsigned nodes;
+	unsigned helper_nodes;
+	unsigned phis;
+	double growth;
+};
+
+static bool shape_from_string(const char *str, CFGShape &shape)
+{
+	for (unsigned i = 0; i < unsigned(CFGShape::Count); i++)
+	{
+		if (strcmp(cfg_shape_to_string(CFGShape(i)), str) == 0)
+		{
+			shape = CFGShape(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool read_baseline(const char *path, std::vector<BaselineSample> &baseline)
+{
+	FILE *file = fopen(path, "r");
+	if (!file)
+	{
+		LOGE("Failed to open baseline %s.\n", path);
+		return false;
+	}
+
+	char line[1024];
+	unsigned line_index = 0;
+	bool ret = true;
+
+	while (ret && fgets(line, sizeof(line), file))
+	{
+		// Skip the header.
+		if (line_index++ == 0)
+			continue;
+
+		char shape_name[64];
+		BaselineSample sample = {};
+		if (sscanf(line, "%63[^,],%u,%u,%u,%u,%lf", shape_name, &sample.scale, &sample.nodes, &sample.helper_nodes,
+		           &sample.phis, &sample.growth) != 6 ||
+		    !shape_from_string(shape_name, sample.shape))
+		{
+			LOGE("Invalid baseline row %u in %s.\n", line_index, path);
+			ret = false;
+		}
+		else
+			baseline.push_back(sample);
+	}
+
+	fclose(file);
+	return ret;
+}
+
+static bool write_baseline(const char *path, const std::vector<BaselineSample> &baseline)
+{
+	FILE *file = fopen(path, "w");
+	if (!file)
+	{
+		LOGE("Failed to open %s for writing.\n", path);
+		return false;
+	}
+
+	fprintf(file, "shape,scale,nodes,helper_nodes,phis,growth\n");
+	for (auto &sample : baseline)
+	{
+		fprintf(file, "%s,%u,%u,%u,%u,%.2f\n", cfg_shape_to_string(sample.shape), sample.scale, sample.nodes,
+		        sample.helper_nodes, sample.phis, sample.growth);
+	}
+
+	fclose(file);
+	return true;
+}
+
+// The smallest scale of each shape is the reference for growth. It runs in microseconds,
+// so it takes more iterations to get a stable time.
+static constexpr unsigned MinReferenceIterations = 32;
+
+// Node, helper block and PHI counts are deterministic, so they are compared exactly.
+// Growth is still noisy, so it only has to stay within tolerance of the baseline.
+static bool check_baseline(const BaselineSample &baseline, const BaselineSample &sample, double tolerance)
+{
+	const char *shape = cfg_shape_to_string(sample.shape);
+	if (sample.nodes != baseline.nodes)
+	{
+		LOGE("%s at scale %u has %u nodes, but the baseline has %u. Regenerate the baseline.\n", shape,
+		     sample.scale, sample.nodes, baseline.nodes);
+		return false;
+	}
+
+	bool ret = true;
+	if (sample.helper_nodes > baseline.helper_nodes)
+	{
+		LOGE("%s at scale %u: %u helper nodes, baseline is %u.\n", shape, sample.scale, sample.helper_nodes,
+		     baseline.helper_nodes);
+		ret = false;
+	}
+
+	if (sample.phis > baseline.phis)
+	{
+		LOGE("%s at scale %u: %u PHIs, baseline is %u.\n", shape, sample.scale, sample.phis, baseline.phis);
+		ret = false;
+	}
+
+	if (sample.growth > baseline.growth * tolerance)
+	{
+		LOGE("%s at scale %u: time per node grew %.2fx, baseline is %.2fx with tolerance %.2f.\n", shape,
+		     sample.scale, sample.growth, baseline.growth, tolerance);
+		ret = false;
+	}
+
+	return ret;
+}
+
+static double phase_ms(const Statistics &stats, StatisticsPhase phase)
+{
+	return double(stats.phase_time_ns[unsigned(phase)]) * 1e-6;
+}
+
+// If reference_us_per_node is 0, this sample becomes the reference for the following samples of the shape.
+static BaselineSample run_sample(CFGShape shape, unsigned scale, unsigned iterations, double &reference_us_per_node,
+                                 double &total_ms)
+{
+	if (reference_us_per_node == 0.0)
+		iterations = std::max(iterations, MinReferenceIterations);
+
+	// Report the fastest iteration to reduce noise.
+	Sample best;
+	for (unsigned i = 0; i < iterations; i++)
+	{
+		auto sample = run_structurizer(shape, scale);
+		if (i == 0 || sample.ms < best.ms)
+			best = sample;
+	}
+
+	double us_per_node = 1000.0 * best.ms / double(best.nodes);
+	if (reference_us_per_node == 0.0)
+		reference_us_per_node = us_per_node;
+	double growth = reference_us_per_node > 0.0 ? us_per_node / reference_us_per_node : 1.0;
+
+	printf("%s,%u,%u,%u,%u,%.3f,%.3f,%.2f,%.3f,%.3f,%.3f,%.3f\n", cfg_shape_to_string(shape), scale, best.nodes,
+	       best.stats.num_helper_blocks, best.stats.num_phis, best.ms, us_per_node, growth,
+	       phase_ms(best.stats, StatisticsPhase::CreateContinueBlockLadders),
+	       phase_ms(best.stats, StatisticsPhase::SplitMergeScopes),
+	       phase_ms(best.stats, StatisticsPhase::Structurize),
+	       phase_ms(best.stats, StatisticsPhase::InsertPhi));
+	fflush(stdout);
+
+	total_ms = best.ms;
+	return { shape, scale, best.nodes, best.stats.num_helper_blocks, best.stats.num_phis, growth };
+}
+
+int main(int argc, char **argv)
+{
+	unsigned max_scale = 256;
+	unsigned iterations = 3;
+	double max_ms = 1000.0;
+	double tolerance = 3.0;
+	std::string baseline_path;
+	std::string write_baseline_path;
+
+	CLICallbacks cbs;
+	cbs.add("--help", [](CLIParser &parser) {
+		print_help();
+		parser.end();
+	});
+	cbs.add("--max-scale", [&](CLIParser &parser) { max_scale = parser.next_uint(); });
+	cbs.add("--iterations", [&](CLIParser &parser) { iterations = std::max(1u, parser.next_uint()); });
+	cbs.add("--max-ms", [&](CLIParser &parser) { max_ms = parser.next_double(); });
+	cbs.add("--baseline", [&](CLIParser &parser) { baseline_path = parser.next_string(); });
+	cbs.add("--tolerance", [&](CLIParser &parser) { tolerance = parser.next_double(); });
+	cbs.add("--write-baseline", [&](CLIParser &parser) { write_baseline_path = parser.next_string(); });
+	cbs.error_handler = [] { print_help(); };
+	CLIParser parser(std::move(cbs), argc - 1, argv + 1);
+
+	if (!parser.parse())
+		return EXIT_FAILURE;
+	else if (parser.is_ended_state())
+		return EXIT_SUCCESS;
+
+	printf("shape,scale,nodes,helper_nodes,phis,total_ms,us_per_node,growth,continue_ladders_ms,split_merge_scopes_ms,"
+	       "structurize_ms,insert_phi_ms\n");
+
+	std::vector<BaselineSample> samples;
+	double reference_us_per_node = 0.0;
+	double total_ms;
+
+	if (!baseline_path.empty())
+	{
+		// Run exactly the baseline samples. Stopping early on --max-ms would hide slowdowns.
+		std::vector<BaselineSample> baseline;
+		if (!read_baseline(baseline_path.c_str(), baseline))
+			return EXIT_FAILURE;
+
+		unsigned failures = 0;
+		for (size_t i = 0; i < baseline.size(); i++)
+		{
+			// The baseline lists the scales of each shape in increasing order.
+			auto &expected = baseline[i];
+			if (i == 0 || baseline[i - 1].shape != expected.shape)
+				reference_us_per_node = 0.0;
+
+			auto sample = run_sample(expected.shape, expected.scale, iterations, reference_us_per_node, total_ms);
+			if (!check_baseline(expected, sample, tolerance))
+				failures++;
+			samples.push_back(sample);
+		}
+
+		if (failures)
+		{
+			LOGE("%u of %u samples regressed against %s.\n", failures, unsigned(baseline.size()),
+			     baseline_path.c_str());
+			return EXIT_FAILURE;
+		}
+
+		LOGI("All %u samples are within the baseline.\n", unsigned(baseline.size()));
+	}
+	else
+	{
+		for (unsigned shape = 0; shape < unsigned(CFGShape::Count); shape++)
+		{
+			reference_us_per_node = 0.0;
+			for (unsigned scale = 1; scale <= max_scale; scale *= 2)
+			{
+				auto sample = run_sample(CFGShape(shape), scale, iterations, reference_us_per_node, total_ms);
+
+				// Some shapes scale super-linearly, don't wait forever for the next size.
+				// The slow sample is left out of a written baseline, so checking it stays fast.
+				if (total_ms <= max_ms)
+					samples.push_back(sample);
+				else
+				{
+					LOGI("Stopping %s at scale %u, %.3f ms exceeds %.3f ms.\n", cfg_shape_to_string(CFGShape(shape)),
+					     scale, total_ms, max_ms);
+					break;
+				}
+			}
+		}
+	}
+
+	if (!write_baseline_path.empty() && !write_baseline(write_baseline_path.c_str(), samples))
+		return EXIT_FAILURE;
+
+	return EXIT_SUCCESS;
+}
@@ -38,6 +38,40 @@ void CFGNode::add_unique_header(CFGNode *node)
 		headers.push_back(node);
 }
 
+void CFGNode::reset()
+{
+	name.clear();
+	id = 0;
+	userdata = nullptr;
+	ir.phi.clear();
+	ir.operations.clear();
+	ir.merge_info = {};
+	ir.terminator.conditional_id = 0;
+	ir.terminator.type = Terminator::Type::Unreachable;
+	ir.terminator.direct_block = nullptr;
+	ir.terminator.true_block = nullptr;
+	ir.terminator.false_block = nullptr;
+	ir.terminator.cases.clear();
+	ir.terminator.default_node = nullptr;
+	ir.terminator.return_value = 0;
+
+	visit_order = 0;
+	visited = false;
+	traversing = false;
+	freeze_structured_analysis = false;
+	merge = MergeType::None;
+	loop_merge_block = nullptr;
+	loop_ladder_block = nullptr;
+	selection_merge_block = nullptr;
+	headers.clear();
+	immediate_dominator = nullptr;
+	succ.clear();
+	pred.clear();
+	pred_back_edge = nullptr;
+	succ_back_edge = nullptr;
+	dominance_frontier.clear();
+}
+
 void CFGNode::add_branch(CFGNode *to)
 {
 	add_unique_succ(to);
@@ -38,6 +38,8 @@ public:
 
 private:
 	CFGNode() = default;
+	// Restores the default state, but keeps vector capacity.
+	void reset();
 	friend class CFGNodePool;
 	friend class CFGStructurizer;
 	friend struct LoopBacktracer;
@@ -18,6 +18,8 @@
 
 #include "node_pool.hpp"
 #include "node.hpp"
+#include <exception>
+#include <new>
 #include <utility>
 
 namespace dxil_spv
@@ -32,10 +34,38 @@ CFGNodePool::~CFGNodePool()
 
 CFGNode *CFGNodePool::create_node()
 {
-	auto node = std::unique_ptr<CFGNode>(new CFGNode);
-	auto *ret = node.get();
-	nodes.push_back(std::move(node));
+	if (num_nodes < nodes.size())
+	{
+		auto *ret = nodes[num_nodes++].get();
+		ret->reset();
+		return ret;
+	}
+
+	auto callbacks = get_allocation_callbacks();
+	void *mem = allocate_memory(callbacks, sizeof(CFGNode), alignof(CFGNode));
+	if (!mem)
+		std::terminate();
+
+	auto *ret = new (mem) CFGNode;
+	nodes.emplace_back(ret, NodeDeleter{ callbacks });
+	num_nodes++;
 	return ret;
 }
 
+void CFGNodePool::NodeDeleter::operator()(CFGNode *node) noexcept
+{
+	node->~CFGNode();
+	free_memory(callbacks, node);
+}
+
+size_t CFGNodePool::get_node_count() const
+{
+	return num_nodes;
+}
+
+void CFGNodePool::reset()
+{
+	num_nodes = 0;
+}
+
 } // namespace dxil_spv
@@ -18,7 +18,9 @@
 
 #pragma once
 
+#include "memory_allocator.hpp"
 #include <memory>
+#include <stddef.h>
 #include <vector>
 
 namespace dxil_spv
@@ -32,15 +34,25 @@ public:
 	~CFGNodePool();
 
 	CFGNode *create_node();
+	size_t get_node_count() const;
+
+	// Invalidates all nodes. They are cleared and handed out again by create_node.
+	void reset();
 
 	template <typename Op>
 	void for_each_node(const Op &op)
 	{
-		for (auto &node : nodes)
-			op(*node);
+		for (size_t i = 0; i < num_nodes; i++)
+			op(*nodes[i]);
 	}
 
 private:
-	std::vector<std::unique_ptr<CFGNode>> nodes;
+	struct NodeDeleter
+	{
+		AllocationCallbacks callbacks;
+		void operator()(CFGNode *node) noexcept;
+	};
+	std::vector<std::unique_ptr<CFGNode, NodeDeleter>> nodes;
+	size_t num_nodes = 0;
 };
 } // namespace dxil_spv
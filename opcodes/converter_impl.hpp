@@ -19,9 +19,11 @@
 #pragma once
 
 #include "SpvBuilder.h"
+#include "budget.hpp"
 #include "cfg_structurizer.hpp"
 #include "dxil_converter.hpp"
 #include "scratch_pool.hpp"
+#include "statistics.hpp"
 
 #include "GLSL.std.450.h"
 
@@ -102,9 +104,18 @@ struct Converter::Impl
 	};
 	std::vector<std::unique_ptr<BlockMeta>> metas;
 	std::unordered_map<llvm::BasicBlock *, BlockMeta *> bb_map;
+	// Reachable blocks of each analyzed function in traversal order. Emission follows the same order.
+	std::unordered_map<const llvm::Function *, std::vector<llvm::BasicBlock *>> function_visit_order;
 	std::unordered_map<const llvm::Value *, spv::Id> value_map;
 
 	ConvertedFunction convert_entry_point();
+	std::unique_ptr<CFGNodePool> node_pool;
+	std::string entry_point_name;
+	llvm::MDNode *entry_point_meta = nullptr;
+	const LibraryAnalysis *library_analysis = nullptr;
+	const LibraryAnalysis::Export *library_export = nullptr;
+	bool export_references_global(const llvm::Value *value) const;
+	bool export_references_resource(const llvm::MDNode *resource) const;
 	CFGNode *convert_function(llvm::Function *func, CFGNodePool &pool);
 	CFGNode *build_hull_main(llvm::Function *func, CFGNodePool &pool,
 	                         std::vector<ConvertedFunction::LeafFunction> &leaves);
@@ -129,8 +140,13 @@ struct Converter::Impl
 	bool emit_execution_modes_pixel();
 	bool emit_execution_modes_ray_tracing(spv::ExecutionModel model);
 
-	bool analyze_instructions();
-	bool analyze_instructions(const llvm::Function *function);
+	// Builds the block graph of a function and analyzes its instructions in the same walk,
+	// so emission only needs one more pass over the IR.
+	bool analyze_instructions(CFGNodePool &pool);
+	bool analyze_function(llvm::Function *func, CFGNodePool &pool);
+	Statistics *statistics = nullptr;
+	BudgetTracker *budget = nullptr;
+	bool check_budget(const CFGNodePool &pool);
 	struct UAVAccessTracking
 	{
 		bool has_read = false;
@@ -144,6 +160,13 @@ struct Converter::Impl
 	std::unordered_set<const llvm::Value *> llvm_value_is_sparse_feedback;
 	uint32_t payload_location_counter = 0;
 
+	// Typed loads, their extracted components and typed stores which are kept in signed integer form.
+	bool analyze_integer_signedness(const llvm::Function *function);
+	bool get_typed_resource_component_type(const llvm::Value *handle, DXIL::ComponentType *component_type) const;
+	std::unordered_map<uint32_t, DXIL::ComponentType> srv_index_to_typed_component_type;
+	std::unordered_map<uint32_t, DXIL::ComponentType> uav_index_to_typed_component_type;
+	std::unordered_set<const llvm::Value *> llvm_values_signed_integer;
+
 	struct ResourceMetaReference
 	{
 		DXIL::ResourceType type;
@@ -201,6 +224,8 @@ struct Converter::Impl
 	std::unordered_map<const llvm::Value *, spv::Id> handle_to_ptr_id;
 	spv::Id root_constant_id = 0;
 	unsigned root_constant_num_words = 0;
+	bool root_constant_vectorized = false;
+	bool root_constant_array = false;
 	unsigned patch_location_offset = 0;
 
 	struct ResourceMeta
@@ -255,6 +280,8 @@ struct Converter::Impl
 	void fixup_load_sign(DXIL::ComponentType component_type, unsigned components, const llvm::Value *value);
 	void repack_sparse_feedback(DXIL::ComponentType component_type, unsigned components, const llvm::Value *value);
 	spv::Id fixup_store_sign(DXIL::ComponentType component_type, unsigned components, spv::Id value);
+	spv::Id build_typed_store_value(DXIL::ComponentType component_type, const llvm::CallInst *instruction,
+	                                unsigned first_value_operand, spv::Id *values);
 
 	std::vector<Operation *> *current_block = nullptr;
 	void add(Operation *op);
@@ -269,6 +296,7 @@ struct Converter::Impl
 	spv::Id cmpxchg_type = 0;
 	spv::Id texture_sample_pos_lut_id = 0;
 	spv::Id rasterizer_sample_count_id = 0;
+	std::unordered_map<uint32_t, spv::Id> output_swizzle_component_ids;
 	spv::Id physical_counter_type = 0;
 	spv::Id shader_record_buffer_id = 0;
 	std::vector<spv::Id> shader_record_buffer_types;
@@ -298,6 +326,14 @@ struct Converter::Impl
 		bool inline_ubo_enable = false;
 		bool bindless_cbv_ssbo_emulation = false;
 		bool physical_storage_buffer = false;
+		bool integer_signedness_inference = false;
+		bool physical_address_folding = false;
+		bool vectorized_root_constants = false;
+
+		bool output_swizzle_spec_constant = false;
+		unsigned output_swizzle_spec_id = 0;
+		bool root_constant_word_count_spec_constant = false;
+		unsigned root_constant_word_count_spec_id = 0;
 
 		unsigned sbt_descriptor_size_srv_uav_cbv_log2 = 0;
 		unsigned sbt_descriptor_size_sampler_log2 = 0;
@@ -333,5 +369,38 @@ struct Converter::Impl
 		bool non_uniform;
 	};
 	std::vector<CombinedImageSampler> combined_image_sampler_cache;
+
+	struct PhysicalAddress
+	{
+		spv::Id ptr_id;
+		spv::Id offset_id;
+		uint64_t constant_offset;
+		spv::Id type_id;
+
+		bool operator==(const PhysicalAddress &other) const
+		{
+			return ptr_id == other.ptr_id && offset_id == other.offset_id &&
+			       constant_offset == other.constant_offset && type_id == other.type_id;
+		}
+	};
+
+	struct PhysicalAddressHasher
+	{
+		size_t operator()(const PhysicalAddress &addr) const
+		{
+			// FNV-1a over the key words.
+			uint64_t h = 0xcbf29ce484222325ull;
+			h = (h ^ addr.ptr_id) * 0x100000001b3ull;
+			h = (h ^ addr.offset_id) * 0x100000001b3ull;
+			h = (h ^ uint32_t(addr.constant_offset)) * 0x100000001b3ull;
+			h = (h ^ uint32_t(addr.constant_offset >> 32)) * 0x100000001b3ull;
+			h = (h ^ addr.type_id) * 0x100000001b3ull;
+			return size_t(h ^ (h >> 32));
+		}
+	};
+
+	// Addresses computed in the current block, so repeated accesses reuse them.
+	std::unordered_map<PhysicalAddress, spv::Id, PhysicalAddressHasher> physical_address_cache;
+	spv::Id physical_address_block_type = 0;
 };
 } // namespace dxil_spv
@@ -22,6 +22,8 @@
 #include "logging.hpp"
 #include "opcodes/converter_impl.hpp"
 
+#include <algorithm>
+
 namespace dxil_spv
 {
 BufferAccessInfo build_buffer_access(Converter::Impl &impl, const llvm::CallInst *instruction, unsigned operand_offset)
@@ -296,6 +298,221 @@ static spv::Id build_physical_pointer_address_for_raw_load_store(Converter::Impl
 	return ptr_compute_op->id;
 }
 
+static uint64_t get_max_unsigned_value(const llvm::Value *value, unsigned depth)
+{
+	if (auto *constant = llvm::dyn_cast<llvm::ConstantInt>(value))
+		return uint32_t(constant->getUniqueInteger().getZExtValue());
+
+	// Only look through the simple index math which is used to compute offsets.
+	auto *binop = llvm::dyn_cast<llvm::BinaryOperator>(value);
+	if (!binop || depth == 0)
+		return UINT32_MAX;
+	auto *constant = llvm::dyn_cast<llvm::ConstantInt>(binop->getOperand(1));
+	if (!constant)
+		return UINT32_MAX;
+
+	uint64_t c = uint32_t(constant->getUniqueInteger().getZExtValue());
+	uint64_t x = get_max_unsigned_value(binop->getOperand(0), depth - 1);
+	uint64_t result;
+
+	switch (binop->getOpcode())
+	{
+	case llvm::BinaryOperator::BinaryOps::And:
+		return std::min(x, c);
+	case llvm::BinaryOperator::BinaryOps::LShr:
+		return c < 32 ? x >> c : UINT32_MAX;
+	case llvm::BinaryOperator::BinaryOps::UDiv:
+		return c != 0 ? x / c : UINT32_MAX;
+	case llvm::BinaryOperator::BinaryOps::URem:
+		return c != 0 ? std::min(x, c - 1) : UINT32_MAX;
+	case llvm::BinaryOperator::BinaryOps::Shl:
+		if (c >= 32)
+			return UINT32_MAX;
+		result = x << c;
+		break;
+	case llvm::BinaryOperator::BinaryOps::Mul:
+		result = x * c;
+		break;
+	case llvm::BinaryOperator::BinaryOps::Add:
+		result = x + c;
+		break;
+	default:
+		return UINT32_MAX;
+	}
+
+	// If the operation can wrap, we know nothing.
+	return result <= UINT32_MAX ? result : UINT32_MAX;
+}
+
+static void split_constant_offset(const llvm::Value *value, const llvm::Value **dynamic_value,
+                                  uint64_t *constant_offset)
+{
+	*constant_offset = 0;
+
+	// Peel off (add X, C) chains. The folded offset is applied after the 64-bit extension,
+	// so only adds which cannot wrap around in 32 bits can be folded, i.e. the add is nuw,
+	// or the range of X is known to be small enough.
+	for (;;)
+	{
+		if (auto *constant = llvm::dyn_cast<llvm::ConstantInt>(value))
+		{
+			*constant_offset += uint32_t(constant->getUniqueInteger().getZExtValue());
+			*dynamic_value = nullptr;
+			return;
+		}
+
+		auto *binop = llvm::dyn_cast<llvm::BinaryOperator>(value);
+		if (!binop || binop->getOpcode() != llvm::BinaryOperator::BinaryOps::Add)
+			break;
+
+		auto *constant = llvm::dyn_cast<llvm::ConstantInt>(binop->getOperand(1));
+		if (!constant)
+			break;
+
+		uint32_t c = uint32_t(constant->getUniqueInteger().getZExtValue());
+		if (!binop->hasNoUnsignedWrap() && get_max_unsigned_value(binop->getOperand(0), 4) + c > UINT32_MAX)
+			break;
+
+		*constant_offset += c;
+		value = binop->getOperand(0);
+	}
+
+	*dynamic_value = value;
+}
+
+static spv::Id find_physical_address(Converter::Impl &impl, spv::Id ptr_id, spv::Id offset_id,
+                                     uint64_t constant_offset, spv::Id type_id)
+{
+	auto itr = impl.physical_address_cache.find({ ptr_id, offset_id, constant_offset, type_id });
+	if (itr != impl.physical_address_cache.end())
+		return itr->second;
+	else
+		return 0;
+}
+
+static spv::Id get_physical_address_block_type(Converter::Impl &impl)
+{
+	auto &builder = impl.builder();
+	if (!impl.physical_address_block_type)
+	{
+		spv::Id runtime_array_type_id = builder.makeRuntimeArray(builder.makeUintType(32));
+		builder.addDecoration(runtime_array_type_id, spv::DecorationArrayStride, 4);
+
+		spv::Id type_id = impl.get_struct_type({ runtime_array_type_id }, "PhysicalAddressBlock");
+		builder.addDecoration(type_id, spv::DecorationBlock);
+		builder.addMemberName(type_id, 0, "words");
+		builder.addMemberDecoration(type_id, 0, spv::DecorationOffset, 0);
+		impl.physical_address_block_type = builder.makePointer(spv::StorageClassPhysicalStorageBuffer, type_id);
+	}
+
+	return impl.physical_address_block_type;
+}
+
+static spv::Id build_physical_pointer_for_raw_load_store(Converter::Impl &impl, const llvm::CallInst *instruction,
+                                                         spv::Id ptr_type_id)
+{
+	auto &builder = impl.builder();
+	spv::Id ptr_id = impl.get_id_for_value(instruction->getOperand(1));
+	const auto &meta = impl.handle_to_resource_meta[ptr_id];
+
+	const llvm::Value *dynamic_index = nullptr;
+	uint64_t constant_offset = 0;
+	bool can_fold = impl.options.physical_address_folding;
+
+	if (can_fold)
+	{
+		split_constant_offset(instruction->getOperand(2), &dynamic_index, &constant_offset);
+		if (meta.stride)
+		{
+			constant_offset *= meta.stride;
+
+			// Dynamic element offsets are rare, don't bother.
+			auto *element_offset = llvm::dyn_cast<llvm::ConstantInt>(instruction->getOperand(3));
+			if (element_offset)
+				constant_offset += uint32_t(element_offset->getUniqueInteger().getZExtValue());
+			else
+				can_fold = false;
+		}
+
+		// Constant offsets are expressed as word indices into the base pointer.
+		// The unfolded address is computed with a 32-bit offset, so larger constant offsets would not match it.
+		if ((constant_offset & 3) != 0 || constant_offset > UINT32_MAX)
+			can_fold = false;
+	}
+
+	if (!can_fold)
+	{
+		spv::Id u64_ptr_id = build_physical_pointer_address_for_raw_load_store(impl, instruction);
+		auto *ptr_bitcast_op = impl.allocate(spv::OpBitcast, ptr_type_id);
+		ptr_bitcast_op->add_id(u64_ptr_id);
+		impl.add(ptr_bitcast_op);
+		return ptr_bitcast_op->id;
+	}
+
+	// Accesses which share a base address and dynamic offset within a block
+	// share one converted base pointer. Constant offsets go into the access chain.
+	spv::Id offset_id = dynamic_index ? impl.get_id_for_value(dynamic_index) : 0;
+
+	spv::Id addr_id = find_physical_address(impl, ptr_id, offset_id, constant_offset, ptr_type_id);
+	if (addr_id)
+		return addr_id;
+
+	spv::Id block_ptr_type_id = get_physical_address_block_type(impl);
+	spv::Id base_ptr_id = find_physical_address(impl, ptr_id, offset_id, 0, block_ptr_type_id);
+
+	if (!base_ptr_id)
+	{
+		spv::Id u64_ptr_id = ptr_id;
+		if (offset_id)
+		{
+			spv::Id byte_offset_id = offset_id;
+			if (meta.stride)
+			{
+				auto *stride_op = impl.allocate(spv::OpIMul, builder.makeUintType(32));
+				stride_op->add_id(offset_id);
+				stride_op->add_id(builder.makeUintConstant(meta.stride));
+				impl.add(stride_op);
+				byte_offset_id = stride_op->id;
+			}
+
+			auto *u64_offset_op = impl.allocate(spv::OpUConvert, builder.makeUintType(64));
+			u64_offset_op->add_id(byte_offset_id);
+			impl.add(u64_offset_op);
+
+			auto *ptr_compute_op = impl.allocate(spv::OpIAdd, builder.makeUintType(64));
+			ptr_compute_op->add_id(ptr_id);
+			ptr_compute_op->add_id(u64_offset_op->id);
+			impl.add(ptr_compute_op);
+			u64_ptr_id = ptr_compute_op->id;
+		}
+
+		auto *ptr_bitcast_op = impl.allocate(spv::OpBitcast, block_ptr_type_id);
+		ptr_bitcast_op->add_id(u64_ptr_id);
+		impl.add(ptr_bitcast_op);
+		base_ptr_id = ptr_bitcast_op->id;
+		impl.physical_address_cache[{ ptr_id, offset_id, 0, block_ptr_type_id }] = base_ptr_id;
+	}
+
+	spv::Id uint_ptr_type_id = builder.makePointer(spv::StorageClassPhysicalStorageBuffer, builder.makeUintType(32));
+	auto *chain_op = impl.allocate(spv::OpAccessChain, uint_ptr_type_id);
+	chain_op->add_id(base_ptr_id);
+	chain_op->add_id(builder.makeUintConstant(0));
+	chain_op->add_id(builder.makeUintConstant(uint32_t(constant_offset >> 2)));
+	impl.add(chain_op);
+	addr_id = chain_op->id;
+
+	if (ptr_type_id != uint_ptr_type_id)
+	{
+		auto *ptr_bitcast_op = impl.allocate(spv::OpBitcast, ptr_type_id);
+		ptr_bitcast_op->add_id(chain_op->id);
+		impl.add(ptr_bitcast_op);
+		addr_id = ptr_bitcast_op->id;
+	}
+
+	impl.physical_address_cache[{ ptr_id, offset_id, constant_offset, ptr_type_id }] = addr_id;
+	return addr_id;
+}
+
 bool emit_raw_buffer_load_instruction(Converter::Impl &impl, const llvm::CallInst *instruction)
 {
 	auto &builder = impl.builder();
@@ -352,14 +569,10 @@ bool emit_raw_buffer_load_instruction(Converter::Impl &impl, const llvm::CallIns
 		type_id = builder.makeVectorType(type_id, vecsize);
 	spv::Id ptr_type_id = builder.makePointer(spv::StorageClassPhysicalStorageBuffer, type_id);
 
-	spv::Id u64_ptr_id = build_physical_pointer_address_for_raw_load_store(impl, instruction);
-
-	auto *ptr_bitcast_op = impl.allocate(spv::OpBitcast, ptr_type_id);
-	ptr_bitcast_op->add_id(u64_ptr_id);
-	impl.add(ptr_bitcast_op);
+	spv::Id physical_ptr_id = build_physical_pointer_for_raw_load_store(impl, instruction, ptr_type_id);
 
 	auto *load_op = impl.allocate(spv::OpLoad, instruction, type_id);
-	load_op->add_id(ptr_bitcast_op->id);
+	load_op->add_id(physical_ptr_id);
 	load_op->add_literal(spv::MemoryAccessAlignedMask);
 	load_op->add_literal(alignment);
 	impl.add(load_op);
@@ -406,13 +619,10 @@ bool emit_buffer_store_instruction(Converter::Impl &impl, const llvm::CallInst *
 
 	if (is_typed)
 	{
-		spv::Id element_type_id = impl.get_type_id(instruction->getOperand(4)->getType());
-
 		// Deal with signed resource store.
 		Operation *op = impl.allocate(spv::OpImageWrite);
-		op->add_ids(
-		    { image_id, access.index_id,
-		      impl.fixup_store_sign(meta.component_type, 4, impl.build_vector(element_type_id, store_values, 4)) });
+		op->add_ids({ image_id, access.index_id,
+		              impl.build_typed_store_value(meta.component_type, instruction, 4, store_values) });
 
 		impl.add(op);
 	}
@@ -500,18 +710,14 @@ bool emit_raw_buffer_store_instruction(Converter::Impl &impl, const llvm::CallIn
 		vec_type_id = builder.makeVectorType(type_id, vecsize);
 	spv::Id ptr_type_id = builder.makePointer(spv::StorageClassPhysicalStorageBuffer, vec_type_id);
 
-	spv::Id u64_ptr_id = build_physical_pointer_address_for_raw_load_store(impl, instruction);
-
-	auto *ptr_bitcast_op = impl.allocate(spv::OpBitcast, ptr_type_id);
-	ptr_bitcast_op->add_id(u64_ptr_id);
-	impl.add(ptr_bitcast_op);
+	spv::Id physical_ptr_id = build_physical_pointer_for_raw_load_store(impl, instruction, ptr_type_id);
 
 	spv::Id elems[4] = {};
 	for (unsigned i = 0; i < 4; i++)
 		elems[i] = impl.get_id_for_value(instruction->getOperand(4 + i));
 
 	auto *store_op = impl.allocate(spv::OpStore);
-	store_op->add_id(ptr_bitcast_op->id);
+	store_op->add_id(physical_ptr_id);
 	store_op->add_id(impl.build_vector(type_id, elems, vecsize));
 	store_op->add_literal(spv::MemoryAccessAlignedMask);
 	store_op->add_literal(alignment);
@@ -18,6 +18,7 @@
 
 #include "dxil_common.hpp"
 #include "logging.hpp"
+#include <string.h>
 
 namespace dxil_spv
 {
@@ -39,4 +40,23 @@ bool get_constant_operand(const llvm::CallInst *value, unsigned index, uint32_t
 	*operand = uint32_t(constant->getUniqueInteger().getZExtValue());
 	return true;
 }
+
+bool is_dxil_op_call(const llvm::CallInst *call_inst)
+{
+#ifdef HAVE_LLVMBC
+	return call_inst->getCalledFunction()->get_function_class() == LLVMBC::FunctionClass::DXILOp;
+#else
+	return strncmp(call_inst->getCalledFunction()->getName().data(), "dx.op", 5) == 0;
+#endif
+}
+
+bool get_dxil_opcode(const llvm::CallInst *call_inst, uint32_t *opcode)
+{
+#ifdef HAVE_LLVMBC
+	if (call_inst->get_dxil_opcode(opcode))
+		return true;
+#endif
+	// The opcode is encoded as a constant integer.
+	return get_constant_operand(call_inst, 0, opcode);
+}
 } // namespace dxil_spv
@@ -23,4 +23,8 @@
 namespace dxil_spv
 {
 bool get_constant_operand(const llvm::CallInst *value, unsigned index, uint32_t *operand);
+
+// With LLVMBC, both are resolved once while parsing, so no name lookups are needed per call.
+bool is_dxil_op_call(const llvm::CallInst *call_inst);
+bool get_dxil_opcode(const llvm::CallInst *call_inst, uint32_t *opcode);
 }
@@ -376,6 +376,43 @@ static spv::Id build_load_invocation_id(Converter::Impl &impl)
 	return op->id;
 }
 
+// Finds the output component which receives input component col, as a function of the swizzle spec constant.
+static spv::Id build_output_swizzle_component(Converter::Impl &impl, unsigned rt_index, unsigned col)
+{
+	auto &builder = impl.builder();
+	auto &component_id = impl.output_swizzle_component_ids[4 * rt_index + col];
+	if (component_id)
+		return component_id;
+
+	// Default to the static swizzle, or identity.
+	unsigned default_swizzle = 0 | (1 << 2) | (2 << 4) | (3 << 6);
+	if (rt_index < impl.options.output_swizzles.size())
+		default_swizzle = impl.options.output_swizzles[rt_index];
+
+	spv::Id uint_type = builder.makeUintType(32);
+	spv::Id swizzle_id = builder.makeUintConstant(default_swizzle, true);
+	builder.addDecoration(swizzle_id, spv::DecorationSpecId, impl.options.output_swizzle_spec_id + rt_index);
+
+	// The mapping is 1:1, so summing the matching output component is enough. Component 0 adds nothing.
+	spv::Id result_id = builder.makeUintConstant(0);
+	for (unsigned output_component = 1; output_component < 4; output_component++)
+	{
+		spv::Id shifted_id = builder.createSpecConstantOp(
+		    spv::OpShiftRightLogical, uint_type, { swizzle_id, builder.makeUintConstant(2 * output_component) }, {});
+		spv::Id masked_id =
+		    builder.createSpecConstantOp(spv::OpBitwiseAnd, uint_type, { shifted_id, builder.makeUintConstant(3) }, {});
+		spv::Id equal_id = builder.createSpecConstantOp(spv::OpIEqual, builder.makeBoolType(),
+		                                                { masked_id, builder.makeUintConstant(col) }, {});
+		spv::Id select_id = builder.createSpecConstantOp(
+		    spv::OpSelect, uint_type,
+		    { equal_id, builder.makeUintConstant(output_component), builder.makeUintConstant(0) }, {});
+		result_id = builder.createSpecConstantOp(spv::OpIAdd, uint_type, { result_id, select_id }, {});
+	}
+
+	component_id = result_id;
+	return component_id;
+}
+
 bool emit_store_output_instruction(Converter::Impl &impl, const llvm::CallInst *instruction)
 {
 	auto &builder = impl.builder();
@@ -429,22 +466,29 @@ bool emit_store_output_instruction(Converter::Impl &impl, const llvm::CallInst *
 			}
 
 			// If we need to swizzle fragment shader outputs, do it here.
-			if (impl.execution_model == spv::ExecutionModelFragment &&
-			    meta.rt_index < impl.options.output_swizzles.size())
+			if (impl.execution_model == spv::ExecutionModelFragment && impl.options.output_swizzle_spec_constant)
 			{
-				// Assume a 1:1 reversible mapping, so we don't need to splat the write or something like that.
-				unsigned swiz = impl.options.output_swizzles[meta.rt_index];
-				for (unsigned output_component = 0; output_component < 4; output_component++)
+				op->add_id(build_output_swizzle_component(impl, meta.rt_index, col));
+			}
+			else
+			{
+				if (impl.execution_model == spv::ExecutionModelFragment &&
+				    meta.rt_index < impl.options.output_swizzles.size())
 				{
-					if (((swiz >> (2u * output_component)) & 3u) == col)
+					// Assume a 1:1 reversible mapping, so we don't need to splat the write or something like that.
+					unsigned swiz = impl.options.output_swizzles[meta.rt_index];
+					for (unsigned output_component = 0; output_component < 4; output_component++)
 					{
-						col = output_component;
-						break;
+						if (((swiz >> (2u * output_component)) & 3u) == col)
+						{
+							col = output_component;
+							break;
+						}
 					}
 				}
-			}
 
-			op->add_id(builder.makeUintConstant(col));
+				op->add_id(builder.makeUintConstant(col));
+			}
 		}
 
 		impl.add(op);
@@ -508,6 +552,24 @@ static spv::Id build_bindless_heap_offset_shader_record(Converter::Impl &impl, c
 	return loaded_word->id;
 }
 
+static void add_root_constant_word_indices(Converter::Impl &impl, Operation *op, unsigned word)
+{
+	auto &builder = impl.builder();
+	if (impl.root_constant_array)
+	{
+		op->add_id(builder.makeUintConstant(0));
+		op->add_id(builder.makeUintConstant(word));
+	}
+	else if (impl.root_constant_vectorized)
+	{
+		op->add_id(builder.makeUintConstant(0));
+		op->add_id(builder.makeUintConstant(word / 4));
+		op->add_id(builder.makeUintConstant(word % 4));
+	}
+	else
+		op->add_id(builder.makeUintConstant(word));
+}
+
 static spv::Id build_bindless_heap_offset_push_constant(Converter::Impl &impl, const Converter::Impl::ResourceReference &reference,
                                                         llvm::Value *dynamic_offset)
 {
@@ -523,7 +585,7 @@ static spv::Id build_bindless_heap_offset_push_constant(Converter::Impl &impl, c
 		builder.makePointer(impl.options.inline_ubo_enable ? spv::StorageClassUniform : spv::StorageClassPushConstant,
 		                    builder.makeUintType(32)));
 	descriptor_table->add_id(impl.root_constant_id);
-	descriptor_table->add_id(builder.makeUintConstant(reference.push_constant_member));
+	add_root_constant_word_indices(impl, descriptor_table, reference.push_constant_member);
 	impl.add(descriptor_table);
 
 	auto *loaded_word = impl.allocate(spv::OpLoad, builder.makeUintType(32));
@@ -962,13 +1024,25 @@ static bool emit_create_handle(Converter::Impl &impl, const llvm::CallInst *inst
 	return true;
 }
 
+static void mark_hoistable_operations(Converter::Impl &impl, size_t first_op)
+{
+	auto &ops = *impl.current_block;
+	for (size_t i = first_op; i < ops.size(); i++)
+		ops[i]->hoistable = true;
+}
+
 bool emit_create_handle_for_lib_instruction(Converter::Impl &impl, const llvm::CallInst *instruction)
 {
 	auto itr = impl.llvm_global_variable_to_resource_mapping.find(instruction->getOperand(1));
 	if (itr == impl.llvm_global_variable_to_resource_mapping.end())
 		return false;
 
-	return emit_create_handle(impl, instruction, itr->second.type, itr->second.meta_index, itr->second.offset, true);
+	size_t first_op = impl.current_block->size();
+	if (!emit_create_handle(impl, instruction, itr->second.type, itr->second.meta_index, itr->second.offset, true))
+		return false;
+
+	mark_hoistable_operations(impl, first_op);
+	return true;
 }
 
 bool emit_create_handle_instruction(Converter::Impl &impl, const llvm::CallInst *instruction)
@@ -984,8 +1058,15 @@ bool emit_create_handle_instruction(Converter::Impl &impl, const llvm::CallInst
 	get_constant_operand(instruction, 4, &non_uniform);
 
 	auto resource_type = static_cast<DXIL::ResourceType>(resource_type_operand);
-	return emit_create_handle(impl, instruction, resource_type, resource_range,
-	                          instruction->getOperand(3), non_uniform != 0);
+	size_t first_op = impl.current_block->size();
+	if (!emit_create_handle(impl, instruction, resource_type, resource_range,
+	                        instruction->getOperand(3), non_uniform != 0))
+	{
+		return false;
+	}
+
+	mark_hoistable_operations(impl, first_op);
+	return true;
 }
 
 static bool emit_cbuffer_load_legacy_physical_pointer(Converter::Impl &impl, const llvm::CallInst *instruction)
@@ -1058,7 +1139,10 @@ static bool emit_cbuffer_load_legacy_from_uints(Converter::Impl &impl, const llv
 			                                             builder.makeUintType(32)));
 
 			op->add_id(base_ptr);
-			op->add_id(builder.makeUintConstant(member_index + i));
+			if (base_ptr == impl.root_constant_id)
+				add_root_constant_word_indices(impl, op, member_index + i);
+			else
+				op->add_id(builder.makeUintConstant(member_index + i));
 			impl.add(op);
 
 			auto *load_op = impl.allocate(spv::OpLoad, builder.makeUintType(32));
@@ -1086,6 +1170,45 @@ static bool emit_cbuffer_load_legacy_from_uints(Converter::Impl &impl, const llv
 	return true;
 }
 
+static bool emit_cbuffer_load_legacy_root_constant_row(Converter::Impl &impl, const llvm::CallInst *instruction,
+                                                       unsigned member_index)
+{
+	auto &builder = impl.builder();
+	spv::Id row_type_id = builder.makeVectorType(builder.makeUintType(32), 4);
+
+	auto *op = impl.allocate(spv::OpAccessChain,
+	                         builder.makePointer(impl.options.inline_ubo_enable ? spv::StorageClassUniform :
+	                                                                              spv::StorageClassPushConstant,
+	                                             row_type_id));
+	op->add_id(impl.root_constant_id);
+	op->add_id(builder.makeUintConstant(0));
+	op->add_id(builder.makeUintConstant(member_index / 4));
+	impl.add(op);
+
+	auto *result_type = instruction->getType();
+	bool need_bitcast = result_type->getStructElementType(0)->getTypeID() != llvm::Type::TypeID::IntegerTyID;
+
+	if (need_bitcast)
+	{
+		auto *load_op = impl.allocate(spv::OpLoad, row_type_id);
+		load_op->add_id(op->id);
+		impl.add(load_op);
+
+		spv::Id type_id = builder.makeVectorType(impl.get_type_id(result_type->getStructElementType(0)), 4);
+		auto *bitcast_op = impl.allocate(spv::OpBitcast, instruction, type_id);
+		bitcast_op->add_id(load_op->id);
+		impl.add(bitcast_op);
+	}
+	else
+	{
+		auto *load_op = impl.allocate(spv::OpLoad, instruction, row_type_id);
+		load_op->add_id(op->id);
+		impl.add(load_op);
+	}
+
+	return true;
+}
+
 static bool emit_cbuffer_load_legacy_shader_record(Converter::Impl &impl, const llvm::CallInst *instruction,
                                                    unsigned local_root_signature_entry)
 {
@@ -1098,10 +1221,25 @@ static bool emit_cbuffer_load_legacy_shader_record(Converter::Impl &impl, const
 
 static bool emit_cbuffer_load_legacy_root_constant(Converter::Impl &impl, const llvm::CallInst *instruction)
 {
+	unsigned member_offset = impl.handle_to_root_member_offset[instruction->getOperand(1)];
+
+	if (impl.root_constant_vectorized)
+	{
+		// If the CBV is placed on a row boundary, a full row can be loaded in one go.
+		// Otherwise, fall back to loading individual words.
+		auto *constant_int = llvm::dyn_cast<llvm::ConstantInt>(instruction->getOperand(2));
+		if (!constant_int)
+			return false;
+
+		unsigned member_index = 4 * unsigned(constant_int->getUniqueInteger().getZExtValue()) + member_offset;
+		if ((member_index & 3) == 0 && member_index + 4 <= impl.root_constant_num_words)
+			return emit_cbuffer_load_legacy_root_constant_row(impl, instruction, member_index);
+	}
+
 	return emit_cbuffer_load_legacy_from_uints(impl, instruction,
 	                                           impl.root_constant_id,
 	                                           spv::StorageClassPushConstant,
-	                                           impl.handle_to_root_member_offset[instruction->getOperand(1)],
+	                                           member_offset,
 	                                           impl.root_constant_num_words);
 }
 
@@ -547,9 +547,7 @@ bool emit_texture_store_instruction(Converter::Impl &impl, const llvm::CallInst
 	op->add_id(image_id);
 	op->add_id(impl.build_vector(builder.makeUintType(32), coord, num_coords_full));
 
-	spv::Id store_id = impl.build_vector(impl.get_type_id(instruction->getOperand(5)->getType()), write_values, 4);
-	store_id = impl.fixup_store_sign(meta.component_type, 4, store_id);
-	op->add_id(store_id);
+	op->add_id(impl.build_typed_store_value(meta.component_type, instruction, 5, write_values));
 	builder.addCapability(spv::CapabilityStorageImageWriteWithoutFormat);
 
 	impl.add(op);
@@ -23,9 +23,11 @@
 
 #ifdef HAVE_LLVMBC
 #include "cast.hpp"
+#include "function.hpp"
 #include "instruction.hpp"
 #include "module.hpp"
 #include "value.hpp"
+#include "visitor.hpp"
 #else
 #include <llvm/IR/Instructions.h>
 #endif
@@ -34,4 +36,25 @@
 
 namespace dxil_spv
 {
+// Calls visitor with the instruction as a reference to its concrete class, using one switch rather than
+// a chain of dyn_casts. Classes the visitor does not handle should fall through to an overload
+// for const llvm::Value &, since overloads for the closest base class are preferred.
+template <typename Visitor>
+bool dispatch_instruction(const llvm::Instruction &instruction, Visitor &visitor)
+{
+#ifdef HAVE_LLVMBC
+	return LLVMBC::visit_value(&instruction, [&](auto *value) -> bool { return visitor(*value); });
+#else
+	switch (instruction.getOpcode())
+	{
+#define HANDLE_INST(num, opcode, Class) \
+	case llvm::Instruction::opcode:     \
+		return visitor(llvm::cast<llvm::Class>(instruction));
+#include <llvm/IR/Instruction.def>
+
+	default:
+		return visitor(static_cast<const llvm::Value &>(instruction));
+	}
+#endif
+}
 }
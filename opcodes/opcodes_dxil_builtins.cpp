@@ -216,9 +216,8 @@ static DXILDispatcher global_dispatcher;
 
 bool emit_dxil_instruction(Converter::Impl &impl, const llvm::CallInst *instruction)
 {
-	// The opcode is encoded as a constant integer.
 	uint32_t opcode;
-	if (!get_constant_operand(instruction, 0, &opcode))
+	if (!get_dxil_opcode(instruction, &opcode))
 		return false;
 
 	if (opcode >= unsigned(DXIL::Op::Count))
@@ -238,9 +237,8 @@ bool emit_dxil_instruction(Converter::Impl &impl, const llvm::CallInst *instruct
 
 bool analyze_dxil_instruction(Converter::Impl &impl, const llvm::CallInst *instruction)
 {
-	// The opcode is encoded as a constant integer.
 	uint32_t opcode;
-	if (!get_constant_operand(instruction, 0, &opcode))
+	if (!get_dxil_opcode(instruction, &opcode))
 		return false;
 
 	switch (static_cast<DXIL::Op>(opcode))
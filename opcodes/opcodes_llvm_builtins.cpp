@@ -138,7 +138,12 @@ bool emit_binary_instruction(Converter::Impl &impl, const llvm::BinaryOperator *
 		return false;
 	}
 
-	Operation *op = impl.allocate(opcode, instruction);
+	// Arithmetic which only feeds signed typed stores is kept in signed form.
+	Operation *op;
+	if (impl.llvm_values_signed_integer.count(instruction))
+		op = impl.allocate(opcode, instruction, impl.get_type_id(DXIL::ComponentType::I32, 1, 1));
+	else
+		op = impl.allocate(opcode, instruction);
 
 	uint32_t id0 = impl.get_id_for_value(instruction->getOperand(0));
 	uint32_t id1 = impl.get_id_for_value(instruction->getOperand(1));
@@ -510,7 +515,11 @@ bool emit_compare_instruction(Converter::Impl &impl, const llvm::CmpInst *instru
 
 bool emit_extract_value_instruction(Converter::Impl &impl, const llvm::ExtractValueInst *instruction)
 {
-	Operation *op = impl.allocate(spv::OpCompositeExtract, instruction);
+	Operation *op;
+	if (impl.llvm_values_signed_integer.count(instruction))
+		op = impl.allocate(spv::OpCompositeExtract, instruction, impl.get_type_id(DXIL::ComponentType::I32, 1, 1));
+	else
+		op = impl.allocate(spv::OpCompositeExtract, instruction);
 
 	op->add_id(impl.get_id_for_value(instruction->getAggregateOperand()));
 	for (unsigned i = 0; i < instruction->getNumIndices(); i++)
@@ -16,6 +16,8 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
  */
 
+#include "memory_allocator.hpp"
+
 namespace dxil_spv
 {
 template <typename T>
@@ -41,30 +43,64 @@ public:
 
 		Block new_block = {};
 		new_block.size = next_allocate_size;
-		new_block.base = static_cast<T *>(malloc(sizeof(T) * next_allocate_size));
+		new_block.base = allocate_block(next_allocate_size);
 		if (!new_block.base)
 		{
 			// If we fail to allocate this little memory, we are hosed anyways.
 			std::terminate();
 		}
 
-		blocks.emplace_back(new_block.base);
+		total_size += next_allocate_size;
 		next_allocate_size *= 2;
 
+		retired_count += current.offset;
 		current = new_block;
 		current.offset = 1;
 		return current.base;
 	}
 
+	// Invalidates all allocations, but keeps the memory. If more than one block was needed,
+	// they are replaced by one block which fits everything, so a warmed up pool stops allocating.
+	// That block is only allocated on first use, with the allocation callbacks active at that point.
+	void reset()
+	{
+		if (blocks.size() > 1)
+		{
+			blocks.clear();
+			current = {};
+			next_allocate_size = total_size;
+			total_size = 0;
+		}
+		else
+			current.offset = 0;
+		retired_count = 0;
+	}
+
+	// Bytes handed out since the last reset, as opposed to the memory the pool holds on to.
+	size_t get_used_bytes() const
+	{
+		return (retired_count + current.offset) * sizeof(T);
+	}
+
 private:
-	struct MallocDeleter
+	struct BlockDeleter
 	{
+		AllocationCallbacks callbacks;
 		void operator()(void *ptr) noexcept
 		{
-			::free(ptr);
+			free_memory(callbacks, ptr);
 		}
 	};
 
+	T *allocate_block(size_t count)
+	{
+		auto callbacks = get_allocation_callbacks();
+		T *base = static_cast<T *>(allocate_memory(callbacks, sizeof(T) * count, alignof(T)));
+		if (base)
+			blocks.emplace_back(base, BlockDeleter{ callbacks });
+		return base;
+	}
+
 	struct Block
 	{
 		T *base;
@@ -73,6 +109,8 @@ private:
 	};
 	Block current = {};
 	size_t next_allocate_size = 64;
-	std::vector<std::unique_ptr<T, MallocDeleter>> blocks;
+	size_t total_size = 0;
+	size_t retired_count = 0;
+	std::vector<std::unique_ptr<T, BlockDeleter>> blocks;
 };
 } // namespace dxil_spv
@@ -0,0 +1,12 @@
+cbuffer A : register(b0, space0)
+{
+	float4 a;
+	uint4 b;
+	float c;
+	int d;
+};
+
+float4 main() : SV_Target
+{
+	return a + float4(b) + c + float(d);
+}
@@ -0,0 +1,22 @@
+cbuffer A : register(b0, space0)
+{
+	float4 a;
+	uint b;
+	int c;
+};
+
+struct Output
+{
+	float4 rt0 : SV_Target0;
+	float2 rt1 : SV_Target1;
+};
+
+Output main(float4 pos : SV_Position)
+{
+	// Both render targets are swizzled through spec constants,
+	// and the root constant block is sized by a spec constant.
+	Output o;
+	o.rt0 = a * pos;
+	o.rt1 = float2(b, c) + pos.xy;
+	return o;
+}
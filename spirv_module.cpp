@@ -20,7 +20,9 @@
 #include "SpvBuilder.h"
 #include "node.hpp"
 #include "scratch_pool.hpp"
+#include "ssa_cleanup.hpp"
 #include <unordered_map>
+#include <unordered_set>
 
 namespace dxil_spv
 {
@@ -58,6 +60,11 @@ struct SPIRVModule::Impl : BlockEmissionInterface
 		bool supports_demote = false;
 	} caps;
 
+	bool ssa_cleanup = false;
+	bool loop_invariant_hoisting = false;
+	void run_ssa_cleanup(CFGStructurizer &structurizer);
+	void optimize_function_body(CFGStructurizer &structurizer);
+
 	spv::Id get_builtin_shader_input(spv::BuiltIn builtin);
 	spv::Id get_builtin_shader_output(spv::BuiltIn builtin);
 	void register_builtin_shader_input(spv::Id id, spv::BuiltIn builtin);
@@ -263,6 +270,15 @@ SPIRVModule::SPIRVModule()
 	impl = std::make_unique<Impl>();
 }
 
+void SPIRVModule::reset()
+{
+	// spv::Builder cannot be cleared, so only the operation pool survives.
+	auto operation_pool = std::move(impl->operation_pool);
+	operation_pool.reset();
+	impl = std::make_unique<Impl>();
+	impl->operation_pool = std::move(operation_pool);
+}
+
 void SPIRVModule::emit_entry_point(spv::ExecutionModel model, const char *name, bool physical_storage)
 {
 	impl->emit_entry_point(model, name, physical_storage);
@@ -447,10 +463,31 @@ bool SPIRVModule::finalize_spirv(std::vector<uint32_t> &spirv)
 	return impl->finalize_spirv(spirv);
 }
 
+void SPIRVModule::Impl::run_ssa_cleanup(CFGStructurizer &structurizer)
+{
+	// Decorated IDs must survive as-is, or we would either drop the decoration's meaning or
+	// leave a dangling OpDecorate behind.
+	std::vector<spv::Id> decoration_targets;
+	builder.getDecorationTargets(decoration_targets);
+	std::unordered_set<spv::Id> pinned_ids(decoration_targets.begin(), decoration_targets.end());
+
+	SSACleanup cleanup(structurizer.get_visit_order(), pinned_ids);
+	cleanup.run();
+}
+
+void SPIRVModule::Impl::optimize_function_body(CFGStructurizer &structurizer)
+{
+	if (loop_invariant_hoisting)
+		structurizer.hoist_loop_invariant_operations();
+	if (ssa_cleanup)
+		run_ssa_cleanup(structurizer);
+}
+
 void SPIRVModule::Impl::emit_entry_point_function_body(CFGStructurizer &structurizer)
 {
 	active_function = entry_function;
 	{
+		optimize_function_body(structurizer);
 		structurizer.traverse(*this);
 		builder.setBuildPoint(active_function->getEntryBlock());
 		builder.createBranch(get_spv_block(structurizer.get_entry_block()));
@@ -463,6 +500,7 @@ void SPIRVModule::Impl::emit_leaf_function_body(spv::Function *func, CFGStructur
 {
 	active_function = func;
 	{
+		optimize_function_body(structurizer);
 		structurizer.traverse(*this);
 		builder.setBuildPoint(active_function->getEntryBlock());
 		builder.createBranch(get_spv_block(structurizer.get_entry_block()));
@@ -511,6 +549,16 @@ void SPIRVModule::enable_shader_discard(bool supports_demote)
 	impl->enable_shader_discard(supports_demote);
 }
 
+void SPIRVModule::enable_ssa_cleanup(bool enable)
+{
+	impl->ssa_cleanup = enable;
+}
+
+void SPIRVModule::enable_loop_invariant_hoisting(bool enable)
+{
+	impl->loop_invariant_hoisting = enable;
+}
+
 spv::Id SPIRVModule::get_builtin_shader_input(spv::BuiltIn builtin)
 {
 	return impl->get_builtin_shader_input(builtin);
@@ -541,6 +589,11 @@ bool SPIRVModule::query_builtin_shader_output(spv::Id id, spv::BuiltIn *builtin)
 	return impl->query_builtin_shader_output(id, builtin);
 }
 
+size_t SPIRVModule::get_operation_arena_bytes() const
+{
+	return impl->operation_pool.get_used_bytes();
+}
+
 Operation *SPIRVModule::allocate_op()
 {
 	return impl->operation_pool.allocate();
@@ -41,6 +41,8 @@ public:
 	SPIRVModule();
 	~SPIRVModule();
 	bool finalize_spirv(std::vector<uint32_t> &spirv);
+	// Starts a new module. Memory for operations is kept for the next conversion.
+	void reset();
 
 	uint32_t allocate_id();
 	uint32_t allocate_ids(uint32_t count);
@@ -54,6 +56,8 @@ public:
 	spv::Function *get_entry_function();
 
 	void enable_shader_discard(bool support_demote);
+	void enable_ssa_cleanup(bool enable);
+	void enable_loop_invariant_hoisting(bool enable);
 	spv::Id get_builtin_shader_input(spv::BuiltIn builtin);
 	spv::Id get_builtin_shader_output(spv::BuiltIn builtin);
 	void register_builtin_shader_input(spv::Id id, spv::BuiltIn builtin);
@@ -65,6 +69,7 @@ public:
 	Operation *allocate_op();
 	Operation *allocate_op(spv::Op op);
 	Operation *allocate_op(spv::Op op, spv::Id id, spv::Id type_id);
+	size_t get_operation_arena_bytes() const;
 
 private:
 	struct Impl;
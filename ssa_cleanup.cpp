@@ -0,0 +1,342 @@
+/*
+ * Copyright 2019-2020 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "ssa_cleanup.hpp"
+#include "node.hpp"
+#include <algorithm>
+
+namespace dxil_spv
+{
+SSACleanup::SSACleanup(const std::vector<CFGNode *> &blocks_, const std::unordered_set<spv::Id> &pinned_ids_)
+    : blocks(blocks_)
+    , pinned_ids(pinned_ids_)
+{
+}
+
+bool SSACleanup::opcode_is_pure(spv::Op op)
+{
+	switch (op)
+	{
+	case spv::OpCopyObject:
+	case spv::OpBitcast:
+	case spv::OpLoad:
+	case spv::OpAccessChain:
+	case spv::OpInBoundsAccessChain:
+	case spv::OpPtrAccessChain:
+	case spv::OpSampledImage:
+	case spv::OpImage:
+	case spv::OpCompositeConstruct:
+	case spv::OpCompositeExtract:
+	case spv::OpCompositeInsert:
+	case spv::OpVectorShuffle:
+	case spv::OpVectorExtractDynamic:
+	case spv::OpVectorInsertDynamic:
+	case spv::OpSelect:
+	case spv::OpIAdd:
+	case spv::OpISub:
+	case spv::OpIMul:
+	case spv::OpUDiv:
+	case spv::OpSDiv:
+	case spv::OpUMod:
+	case spv::OpSRem:
+	case spv::OpSMod:
+	case spv::OpSNegate:
+	case spv::OpFAdd:
+	case spv::OpFSub:
+	case spv::OpFMul:
+	case spv::OpFDiv:
+	case spv::OpFRem:
+	case spv::OpFMod:
+	case spv::OpFNegate:
+	case spv::OpDot:
+	case spv::OpVectorTimesScalar:
+	case spv::OpShiftLeftLogical:
+	case spv::OpShiftRightLogical:
+	case spv::OpShiftRightArithmetic:
+	case spv::OpBitwiseAnd:
+	case spv::OpBitwiseOr:
+	case spv::OpBitwiseXor:
+	case spv::OpNot:
+	case spv::OpBitFieldInsert:
+	case spv::OpBitFieldSExtract:
+	case spv::OpBitFieldUExtract:
+	case spv::OpBitReverse:
+	case spv::OpBitCount:
+	case spv::OpLogicalAnd:
+	case spv::OpLogicalOr:
+	case spv::OpLogicalNot:
+	case spv::OpLogicalEqual:
+	case spv::OpLogicalNotEqual:
+	case spv::OpIEqual:
+	case spv::OpINotEqual:
+	case spv::OpUGreaterThan:
+	case spv::OpUGreaterThanEqual:
+	case spv::OpULessThan:
+	case spv::OpULessThanEqual:
+	case spv::OpSGreaterThan:
+	case spv::OpSGreaterThanEqual:
+	case spv::OpSLessThan:
+	case spv::OpSLessThanEqual:
+	case spv::OpFOrdEqual:
+	case spv::OpFOrdNotEqual:
+	case spv::OpFOrdLessThan:
+	case spv::OpFOrdLessThanEqual:
+	case spv::OpFOrdGreaterThan:
+	case spv::OpFOrdGreaterThanEqual:
+	case spv::OpFUnordEqual:
+	case spv::OpFUnordNotEqual:
+	case spv::OpFUnordLessThan:
+	case spv::OpFUnordLessThanEqual:
+	case spv::OpFUnordGreaterThan:
+	case spv::OpFUnordGreaterThanEqual:
+	case spv::OpIsNan:
+	case spv::OpIsInf:
+	case spv::OpConvertFToU:
+	case spv::OpConvertFToS:
+	case spv::OpConvertSToF:
+	case spv::OpConvertUToF:
+	case spv::OpUConvert:
+	case spv::OpSConvert:
+	case spv::OpFConvert:
+	case spv::OpQuantizeToF16:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+void SSACleanup::collect_definitions()
+{
+	for (auto *block : blocks)
+	{
+		for (auto &phi : block->ir.phi)
+		{
+			if (!phi.id)
+				continue;
+			auto &def = definitions[phi.id];
+			def.phi = &phi;
+			def.type_id = phi.type_id;
+		}
+
+		for (auto *op : block->ir.operations)
+		{
+			if (!op->id)
+				continue;
+			auto &def = definitions[op->id];
+			def.op = op;
+			def.type_id = op->type_id;
+		}
+	}
+}
+
+spv::Id SSACleanup::resolve(spv::Id id)
+{
+	auto itr = forwarded_ids.find(id);
+	if (itr == forwarded_ids.end())
+		return id;
+
+	// Path compression, so chains of copies are only walked once.
+	spv::Id resolved = resolve(itr->second);
+	itr->second = resolved;
+	return resolved;
+}
+
+void SSACleanup::forward(spv::Id from, spv::Id to)
+{
+	to = resolve(to);
+	if (from != to)
+		forwarded_ids[from] = to;
+}
+
+void SSACleanup::forward_copies_and_bitcasts()
+{
+	// Visit in reverse post-order, so that definitions are seen before uses outside of loops.
+	for (auto itr = blocks.rbegin(); itr != blocks.rend(); ++itr)
+	{
+		for (auto *op : (*itr)->ir.operations)
+		{
+			if (!op->id || pinned_ids.count(op->id))
+				continue;
+
+			if (op->op == spv::OpCopyObject)
+			{
+				forward(op->id, op->arguments[0]);
+			}
+			else if (op->op == spv::OpBitcast)
+			{
+				auto def_itr = definitions.find(resolve(op->arguments[0]));
+				if (def_itr == definitions.end() || !def_itr->second.op || def_itr->second.op->op != spv::OpBitcast)
+					continue;
+
+				spv::Id source_id = resolve(def_itr->second.op->arguments[0]);
+				auto source_itr = definitions.find(source_id);
+				if (source_itr != definitions.end() && source_itr->second.type_id == op->type_id)
+					forward(op->id, source_id);
+			}
+		}
+	}
+}
+
+void SSACleanup::fold_trivial_phis()
+{
+	for (auto itr = blocks.rbegin(); itr != blocks.rend(); ++itr)
+	{
+		for (auto &phi : (*itr)->ir.phi)
+		{
+			if (!phi.id || pinned_ids.count(phi.id))
+				continue;
+
+			spv::Id unique_id = 0;
+			bool trivial = true;
+			for (auto &incoming : phi.incoming)
+			{
+				spv::Id id = resolve(incoming.id);
+				if (id == phi.id || id == unique_id)
+					continue;
+
+				if (unique_id)
+				{
+					trivial = false;
+					break;
+				}
+				unique_id = id;
+			}
+
+			if (trivial && unique_id)
+			{
+				forward(phi.id, unique_id);
+				definitions.erase(phi.id);
+				phi.id = 0;
+			}
+		}
+	}
+}
+
+void SSACleanup::rewrite_uses()
+{
+	const auto rewrite = [this](spv::Id &id) {
+		if (!id)
+			return;
+		if (!forwarded_ids.empty())
+			id = resolve(id);
+
+		auto itr = definitions.find(id);
+		if (itr != definitions.end())
+			itr->second.use_count++;
+	};
+
+	for (auto *block : blocks)
+	{
+		auto &ir = block->ir;
+		for (auto &phi : ir.phi)
+		{
+			if (!phi.id)
+				continue;
+			for (auto &incoming : phi.incoming)
+				rewrite(incoming.id);
+		}
+
+		for (auto *op : ir.operations)
+		{
+			unsigned literal_mask = op->get_literal_mask();
+			for (unsigned i = 0; i < op->num_arguments; i++, literal_mask >>= 1u)
+				if ((literal_mask & 1u) == 0)
+					rewrite(op->arguments[i]);
+		}
+
+		rewrite(ir.terminator.conditional_id);
+		rewrite(ir.terminator.return_value);
+	}
+}
+
+bool SSACleanup::is_removable(spv::Id id, const ValueDefinition &def) const
+{
+	if (def.use_count != 0 || pinned_ids.count(id))
+		return false;
+	if (def.phi)
+		return true;
+	return def.op && opcode_is_pure(def.op->op);
+}
+
+void SSACleanup::remove_use(spv::Id id, std::vector<spv::Id> &worklist)
+{
+	auto itr = definitions.find(id);
+	if (itr == definitions.end())
+		return;
+
+	assert(itr->second.use_count);
+	if (--itr->second.use_count == 0 && is_removable(id, itr->second))
+		worklist.push_back(id);
+}
+
+void SSACleanup::eliminate_dead_values()
+{
+	std::vector<spv::Id> worklist;
+	for (auto &def : definitions)
+		if (is_removable(def.first, def.second))
+			worklist.push_back(def.first);
+
+	// Each value is removed at most once, and each removal releases every argument at most once.
+	while (!worklist.empty())
+	{
+		spv::Id id = worklist.back();
+		worklist.pop_back();
+
+		auto &def = definitions[id];
+		if (def.phi)
+		{
+			def.phi->id = 0;
+			for (auto &incoming : def.phi->incoming)
+				remove_use(incoming.id, worklist);
+		}
+		else
+		{
+			auto *op = def.op;
+			op->op = spv::OpNop;
+			unsigned literal_mask = op->get_literal_mask();
+			for (unsigned i = 0; i < op->num_arguments; i++, literal_mask >>= 1u)
+				if ((literal_mask & 1u) == 0)
+					remove_use(op->arguments[i], worklist);
+		}
+
+		def.phi = nullptr;
+		def.op = nullptr;
+	}
+}
+
+void SSACleanup::compact_operations()
+{
+	for (auto *block : blocks)
+	{
+		auto &ops = block->ir.operations;
+		ops.erase(std::remove_if(ops.begin(), ops.end(), [](const Operation *op) { return op->op == spv::OpNop; }),
+		          ops.end());
+	}
+}
+
+void SSACleanup::run()
+{
+	collect_definitions();
+	forward_copies_and_bitcasts();
+	fold_trivial_phis();
+	rewrite_uses();
+	eliminate_dead_values();
+	compact_operations();
+}
+} // namespace dxil_spv
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2019-2020 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#pragma once
+
+#include "ir.hpp"
+#include <stdint.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace dxil_spv
+{
+struct CFGNode;
+
+// Runs after the CFG has been structurized and all PHI nodes are final.
+// Cleans up redundant SSA values which are trivially produced by the converter and structurizer:
+// - OpCopyObject is forwarded to its source.
+// - OpBitcast(OpBitcast(x)) is forwarded to x if the types round-trip.
+// - PHI nodes whose incoming values are all the same (ignoring self-references) are folded.
+// - Side-effect free operations which end up unused are removed.
+// All steps are linear in the number of operations and PHI incoming values.
+class SSACleanup
+{
+public:
+	// IDs in pinned_ids are never rewritten or removed, e.g. IDs which carry decorations.
+	SSACleanup(const std::vector<CFGNode *> &blocks, const std::unordered_set<spv::Id> &pinned_ids);
+	void run();
+
+private:
+	const std::vector<CFGNode *> &blocks;
+	const std::unordered_set<spv::Id> &pinned_ids;
+
+	struct ValueDefinition
+	{
+		Operation *op = nullptr;
+		PHI *phi = nullptr;
+		uint32_t type_id = 0;
+		uint32_t use_count = 0;
+	};
+	std::unordered_map<spv::Id, ValueDefinition> definitions;
+	std::unordered_map<spv::Id, spv::Id> forwarded_ids;
+
+	void collect_definitions();
+	void forward_copies_and_bitcasts();
+	void fold_trivial_phis();
+	void rewrite_uses();
+	void eliminate_dead_values();
+	void compact_operations();
+
+	spv::Id resolve(spv::Id id);
+	void forward(spv::Id from, spv::Id to);
+	void remove_use(spv::Id id, std::vector<spv::Id> &worklist);
+	bool is_removable(spv::Id id, const ValueDefinition &def) const;
+	static bool opcode_is_pure(spv::Op op);
+};
+} // namespace dxil_spv
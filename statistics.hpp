@@ -0,0 +1,87 @@
+/*
+ * Copyright 2019-2020 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#pragma once
+
+#include <chrono>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace dxil_spv
+{
+enum class StatisticsPhase : unsigned
+{
+	Parse,
+	ConvertEntryPoint,
+	CreateContinueBlockLadders,
+	SplitMergeScopes,
+	Structurize,
+	InsertPhi,
+	EmitFunctionBody,
+	FinalizeSPIRV,
+	Count
+};
+
+struct Statistics
+{
+	uint64_t phase_time_ns[unsigned(StatisticsPhase::Count)] = {};
+	uint32_t num_blocks = 0;
+	uint32_t num_helper_blocks = 0;
+	uint32_t num_phis = 0;
+	uint32_t num_operations = 0;
+	uint32_t num_constants = 0;
+	size_t arena_bytes = 0;
+	// Arena blocks and CFG nodes allocated by the conversion. A warmed up converter context brings this down.
+	uint32_t num_arena_allocations = 0;
+
+	// Reachable LLVM IR blocks in converted functions, and how many times the converter walked over them.
+	uint32_t num_ir_blocks = 0;
+	uint32_t num_ir_block_visits = 0;
+};
+
+// Accumulates wall time of a scope into a phase. Does nothing if stats is nullptr.
+class ScopedPhaseTimer
+{
+public:
+	ScopedPhaseTimer(Statistics *stats_, StatisticsPhase phase_)
+	    : stats(stats_)
+	    , phase(phase_)
+	{
+		if (stats)
+			start = std::chrono::steady_clock::now();
+	}
+
+	~ScopedPhaseTimer()
+	{
+		if (stats)
+		{
+			auto end = std::chrono::steady_clock::now();
+			stats->phase_time_ns[unsigned(phase)] +=
+			    std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+		}
+	}
+
+	ScopedPhaseTimer(const ScopedPhaseTimer &) = delete;
+	void operator=(const ScopedPhaseTimer &) = delete;
+
+private:
+	Statistics *stats;
+	StatisticsPhase phase;
+	std::chrono::steady_clock::time_point start;
+};
+} // namespace dxil_spv
@@ -0,0 +1,222 @@
+#!/usr/bin/env python3
+
+#
+# Copyright 2019 Hans-Kristian Arntzen for Valve Corporation
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+#
+
+# Client test for dxil-spirv --serve and --serve-socket.
+# Shaders given on the command line are compiled with DXC and converted both through the server
+# and through a regular dxil-spirv invocation, which must produce identical SPIR-V.
+# Malformed requests and shutdown are tested without any shaders.
+
+import sys
+import os
+import subprocess
+import tempfile
+import argparse
+import socket
+import struct
+import threading
+import time
+
+from test_shaders import get_sm, create_temporary, remove_file
+
+# Must match ServeMagic and ServeShutdownMagic in dxil_spirv.cpp.
+SERVE_MAGIC = 0x56535844
+SERVE_SHUTDOWN_MAGIC = 0x51535844
+
+class PipeConnection():
+    def __init__(self, process):
+        self.process = process
+
+    def send(self, data):
+        self.process.stdin.write(data)
+        self.process.stdin.flush()
+
+    def recv(self, size):
+        return self.process.stdout.read(size)
+
+class SocketConnection():
+    def __init__(self, path):
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.connect(path)
+
+    def send(self, data):
+        self.sock.sendall(data)
+
+    def recv(self, size):
+        data = b''
+        while len(data) < size:
+            chunk = self.sock.recv(size - len(data))
+            if not chunk:
+                break
+            data += chunk
+        return data
+
+    def close(self):
+        self.sock.close()
+
+def encode_request(arguments, blob):
+    request = struct.pack('<II', SERVE_MAGIC, len(arguments))
+    for arg in arguments:
+        encoded = arg.encode('utf-8')
+        request += struct.pack('<I', len(encoded)) + encoded
+    request += struct.pack('<I', len(blob)) + blob
+    return request
+
+def read_reply(conn):
+    header = conn.recv(12)
+    if len(header) != 12:
+        raise RuntimeError('Server closed the connection.')
+    magic, status, size = struct.unpack('<III', header)
+    if magic != SERVE_MAGIC:
+        raise RuntimeError('Unexpected reply magic 0x{:x}.'.format(magic))
+    payload = conn.recv(size)
+    if len(payload) != size:
+        raise RuntimeError('Truncated reply.')
+    return status, payload
+
+def convert(conn, arguments, blob):
+    conn.send(encode_request(arguments, blob))
+    return read_reply(conn)
+
+def shutdown(conn):
+    conn.send(struct.pack('<I', SERVE_SHUTDOWN_MAGIC))
+    status, payload = read_reply(conn)
+    if status != 0 or payload:
+        raise RuntimeError('Shutdown was not acknowledged.')
+
+def compile_dxil(shader, paths):
+    dxil_path = create_temporary()
+    subprocess.check_call([paths.dxc, '-Qstrip_reflect', '-Qstrip_debug', '-Vd', '-T' + get_sm(shader),
+        '-Fo', dxil_path, shader, '-enable-16bit-types'])
+    with open(dxil_path, 'rb') as f:
+        blob = f.read()
+
+    spirv_path = create_temporary('.spv')
+    subprocess.check_call([paths.dxil_spirv, '--output', spirv_path, dxil_path])
+    with open(spirv_path, 'rb') as f:
+        spirv = f.read()
+
+    remove_file(dxil_path)
+    remove_file(spirv_path)
+    return blob, spirv
+
+def check_requests(conn, shaders):
+    # Every connection must survive requests which fail.
+    status, payload = convert(conn, ['--not-an-option'], b'')
+    if status == 0 or payload:
+        raise RuntimeError('Unknown option was accepted.')
+
+    status, payload = convert(conn, [], b'not dxil')
+    if status == 0 or payload:
+        raise RuntimeError('Invalid DXIL was accepted.')
+
+    # Run every shader twice, so the second conversion goes through a reused converter context.
+    for _ in range(2):
+        for name, (blob, spirv) in shaders.items():
+            status, payload = convert(conn, [], blob)
+            if status != 0:
+                raise RuntimeError('Failed to convert {}.'.format(name))
+            if payload != spirv:
+                raise RuntimeError('Served SPIR-V for {} does not match dxil-spirv --output.'.format(name))
+
+def wait_for_exit(process):
+    try:
+        ret = process.wait(timeout = 10)
+    except subprocess.TimeoutExpired:
+        process.kill()
+        raise RuntimeError('Server did not exit.')
+    if ret != 0:
+        raise RuntimeError('Server exited with {}.'.format(ret))
+
+def test_stdio(paths, shaders):
+    process = subprocess.Popen([paths.dxil_spirv, '--serve'], stdin = subprocess.PIPE, stdout = subprocess.PIPE)
+    conn = PipeConnection(process)
+    check_requests(conn, shaders)
+    shutdown(conn)
+    wait_for_exit(process)
+
+def start_socket_server(paths, path):
+    process = subprocess.Popen([paths.dxil_spirv, '--serve-socket', path])
+    for _ in range(100):
+        if os.path.exists(path):
+            return process
+        time.sleep(0.05)
+    process.kill()
+    raise RuntimeError('Server did not create {}.'.format(path))
+
+def test_socket(paths, shaders):
+    path = os.path.join(tempfile.mkdtemp(), 'dxil-spirv.sock')
+    process = start_socket_server(paths, path)
+
+    errors = []
+    def client():
+        try:
+            conn = SocketConnection(path)
+            check_requests(conn, shaders)
+            conn.close()
+        except Exception as e:
+            errors.append(e)
+
+    threads = [threading.Thread(target = client) for _ in range(4)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    if errors:
+        process.kill()
+        raise errors[0]
+
+    # An idle connection must not keep the server alive after a shutdown request from another one.
+    idle = SocketConnection(path)
+    conn = SocketConnection(path)
+    shutdown(conn)
+    wait_for_exit(process)
+    idle.close()
+    conn.close()
+    if os.path.exists(path):
+        raise RuntimeError('Server did not remove {}.'.format(path))
+
+    # SIGTERM stops the server as well.
+    process = start_socket_server(paths, path)
+    process.terminate()
+    wait_for_exit(process)
+
+def main():
+    parser = argparse.ArgumentParser(description = 'Client test for dxil-spirv --serve.')
+    parser.add_argument('shaders', nargs = '*',
+            help = 'Shaders to convert through the server.')
+    parser.add_argument('--dxc',
+            default = './external/dxc-build/output/bin/dxc',
+            help = 'Explicit path to DXC')
+    parser.add_argument('--dxil-spirv',
+            default = './dxil-spirv',
+            help = 'Explicit path to dxil-spirv')
+    args = parser.parse_args()
+
+    shaders = {}
+    for shader in args.shaders:
+        shaders[shader] = compile_dxil(shader, args)
+
+    test_stdio(args, shaders)
+    if os.name != 'nt':
+        test_socket(args, shaders)
+    print('Tests completed!')
+
+if __name__ == '__main__':
+    main()
@@ -132,6 +132,26 @@ def cross_compile_dxil(shader, args, paths):
     if '.cbv-as-ssbo.' in shader:
         hlsl_cmd.append('--bindless-cbv-as-ssbo')
 
+    if '.ssa-cleanup.' in shader:
+        hlsl_cmd.append('--ssa-cleanup')
+    if '.sign-inference.' in shader:
+        hlsl_cmd.append('--integer-signedness-inference')
+    if '.hoist.' in shader:
+        hlsl_cmd.append('--loop-invariant-hoisting')
+    if '.address-folding.' in shader:
+        hlsl_cmd.append('--physical-address-folding')
+    if '.root-constant-rows.' in shader:
+        hlsl_cmd.append('--vectorized-root-constants')
+    entry = re.search(r'\.entry-(\w+)\.', shader)
+    if entry:
+        hlsl_cmd.append('--entry')
+        hlsl_cmd.append(entry.group(1))
+    if '.spec-constant-state.' in shader:
+        hlsl_cmd.append('--spec-constant-output-swizzle')
+        hlsl_cmd.append('100')
+        hlsl_cmd.append('--spec-constant-root-constant-word-count')
+        hlsl_cmd.append('200')
+
     if '.invalid.' not in shader:
         hlsl_cmd.append('--validate')
 
@@ -196,10 +216,16 @@ def regression_check(shader, glsl, args):
                 raise RuntimeError('Does not match reference')
         else:
             remove_file(glsl)
-    else:
+    elif args.update:
         print('Found new shader {}. Placing generated source code in {}'.format(joined_path, reference))
         make_reference_dir(reference)
         shutil.move(glsl, reference)
+    else:
+        # A missing reference is a failure, otherwise new tests would never be checked against anything.
+        print('Found new shader {} without reference {}. Run with --update to create it.'.format(joined_path, reference))
+        if not args.keep:
+            remove_file(glsl)
+        raise RuntimeError('Missing reference')
 
 def test_shader(shader, args, paths):
     joined_path = os.path.join(shader[0], shader[1])
@@ -998,6 +998,14 @@ void Builder::addMemberDecoration(Id id, unsigned int member, Decoration decorat
     decorations.push_back(std::unique_ptr<Instruction>(dec));
 }
 
+// Comments in header
+void Builder::getDecorationTargets(std::vector<Id>& targets) const
+{
+    for (auto& dec : decorations)
+        if (dec->getOpCode() == OpDecorate)
+            targets.push_back(dec->getIdOperand(0));
+}
+
 // Comments in header
 Function* Builder::makeEntryPoint(const char* entryPoint)
 {
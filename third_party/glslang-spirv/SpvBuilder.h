@@ -255,6 +255,8 @@ public:
     void addMemberName(Id, int member, const char* name);
     void addDecoration(Id, Decoration, int num = -1);
     void addMemberDecoration(Id, unsigned int member, Decoration, int num = -1);
+    // Gathers every ID which is the target of an OpDecorate.
+    void getDecorationTargets(std::vector<Id>& targets) const;
 
     // At the end of what block do the next create*() instructions go?
     void setBuildPoint(Block* bp) { buildPoint = bp; }